@@ -1,5 +1,6 @@
 #pragma once
 
+#include "HardwareProfile.hpp"
 #include "OperatorInfo.hpp"
 #include <fstream>
 #include <iostream>
@@ -10,6 +11,9 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+
+class StrategyCostModel;
 
 enum AccessStrategy
 {
@@ -19,6 +23,13 @@ enum AccessStrategy
     UNSUITABLE
 };
 
+// 变量所在的片上存储：SM供标量单元访问，AM供向量单元访问
+enum TargetMemory
+{
+    MEMORY_SM,
+    MEMORY_AM
+};
+
 class AccessStrategyConfig
 {
 public:
@@ -32,6 +43,7 @@ public:
         : accessStrategy(accessStrategy), set(set), line(line) {};
     AccessStrategyConfig(const AccessStrategyConfig &other)
         : accessStrategy(other.accessStrategy), set(other.set), line(other.line), spaceUsage(other.spaceUsage) {};
+    AccessStrategyConfig &operator=(const AccessStrategyConfig &) = default;
     void setStrategy(AccessStrategy accessStrategy) { this->accessStrategy = accessStrategy; }
     void setParm(int set, int line)
     {
@@ -55,39 +67,143 @@ public:
         }
     }
     int getSpaceUsage() const { return ((set == 0) ? 0 : 1 << set) + ((line == 0) ? 0 : 1 << line); }
+    // 策略实际占用的SM空间（字节），BULK策略的line字段存放的是数据块大小
+    int getSMFootprint() const
+    {
+        switch (accessStrategy) {
+        case BULK:
+            return line;
+        case SINGLE:
+            return calculateLineSpace(line);
+        case DIRECT:
+            return (1 << set) * calculateLineSpace(line);
+        default:
+            return 0;
+        }
+    }
     void printInfo() const
     {
         std::cout << "访问模式: " << getStrategyName() << ", set: " << set << ", line: " << line
                   << ", 空间占用: " << getSpaceUsage() << "字节" << std::endl;
     }
     static int getLineBasedOnSize(const int &S) { return static_cast<int>(std::ceil(std::log2(S))); }
-    static int calculateLineSpace(const int &line) { return (line == 0) ? 0 : 1 << line; }
+    static int calculateLineSpace(const int &line) { return (line <= 0) ? 0 : 1 << line; }
+    // 将大小向上取整到alignment（2的幂）的整数倍
+    static unsigned long long alignSize(unsigned long long size, int alignment)
+    {
+        return (size + alignment - 1) & ~static_cast<unsigned long long>(alignment - 1);
+    }
+};
+
+// DMA多缓冲流水建议
+class BufferingPlan
+{
+public:
+    // 缓冲区个数：1表示不做流水，2为双缓冲，3为三缓冲
+    int bufferCount = 1;
+    // 单个缓冲区大小（字节）
+    int bufferSize = 0;
+    // 传输与计算不重叠时的DMA停顿周期
+    double stallCycles = 0.0;
+    // 多缓冲流水后的DMA停顿周期
+    double pipelinedStallCycles = 0.0;
+    // 停顿降低比例
+    double getStallReduction() const
+    {
+        return (stallCycles <= 0.0) ? 0.0 : (stallCycles - pipelinedStallCycles) / stallCycles;
+    }
+    std::string getBufferingName() const
+    {
+        switch (bufferCount) {
+        case 2:
+            return "DOUBLE";
+        case 3:
+            return "TRIPLE";
+        default:
+            return "NONE";
+        }
+    }
+};
+
+// SINGLE变量的DMA预取建议：以chunkSize为单位的环形区域，消费当前块时提前distance块发起预取
+class PrefetchPlan
+{
+public:
+    // 预取距离（块数），0表示不建议预取
+    int distance = 0;
+    // 单次预取的块大小（字节）
+    int chunkSize = 0;
+    // 不预取（逐块按需载入）与预取后的DMA停顿周期
+    double stallCycles = 0.0;
+    double prefetchStallCycles = 0.0;
+    bool isEnabled() const { return distance > 0; }
+    // 环形区域大小：distance个在途块加正在消费的块
+    int getRingSize() const { return (distance + 1) * chunkSize; }
+    double getStallReduction() const
+    {
+        return (stallCycles <= 0.0) ? 0.0 : (stallCycles - prefetchStallCycles) / stallCycles;
+    }
+};
+
+// 各候选策略的估算执行周期，按AccessStrategy索引，不可行的策略为无穷大
+class StrategyCosts
+{
+public:
+    double cycles[UNSUITABLE] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                                 std::numeric_limits<double>::infinity()};
+    double get(AccessStrategy accessStrategy) const
+    {
+        return (accessStrategy < UNSUITABLE) ? cycles[accessStrategy] : std::numeric_limits<double>::infinity();
+    }
+    // 格式化周期数，不可行的策略输出为"-"
+    static std::string formatCycles(double value)
+    {
+        if (std::isinf(value)) {
+            return "-";
+        }
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(0) << value;
+        return oss.str();
+    }
 };
 
 class AccessFeatureVector
 {
 public:
-    std::string varName;
+    InternedName varName;
     // 访存空间大小
     unsigned long long S;
     // 访存次数
     unsigned long long N;
     // 访存模式 <步长d_i, 占比p_i>
-    std::vector<std::pair<int, double>> patterns;
+    AccessPatterns patterns;
     // 空间局部性
     double L;
+    // 时间局部性，由重用距离直方图计算，没有直方图时为0
+    double T = 0.0;
+    std::shared_ptr<const ReuseHistogram> reuse;
     // 访存密度
     double D;
-    // 空间划分因子
+    // 空间划分因子 F = (L + T)·D
     double F;
     // 划分后的SM空间大小（字节）
     int C;
     // 缓存策略配置
     AccessStrategyConfig accessStrategyConfig;
+    // DMA多缓冲流水建议
+    BufferingPlan bufferingPlan;
+    // SINGLE变量的DMA预取建议
+    PrefetchPlan prefetchPlan;
+    // 各候选策略的估算周期
+    StrategyCosts strategyCosts;
+    // 缓存所在的存储，C、策略参数均针对该存储
+    TargetMemory memory = MEMORY_SM;
     AccessFeatureVector() {};
     AccessFeatureVector(const VariableInfo &var);
     AccessFeatureVector(const AccessFeatureVector &other)
-        : varName(other.varName), S(other.S), N(other.N), patterns(other.patterns), L(other.L), D(other.D), F(other.F), C(other.C), accessStrategyConfig(other.accessStrategyConfig) {};
+        : varName(other.varName), S(other.S), N(other.N), patterns(other.patterns), L(other.L), T(other.T), reuse(other.reuse), D(other.D), F(other.F), C(other.C), accessStrategyConfig(other.accessStrategyConfig),
+          bufferingPlan(other.bufferingPlan), prefetchPlan(other.prefetchPlan), strategyCosts(other.strategyCosts), memory(other.memory) {};
+    AccessFeatureVector &operator=(const AccessFeatureVector &) = default;
     ~AccessFeatureVector() {};
     bool operator==(const AccessFeatureVector &other) const
     {
@@ -99,32 +215,56 @@ public:
 
 private:
     void calculateL();
+    void calculateT();
     void calculateD();
     void calculateF();
 };
 
+// 在当前线程的内存池（若有）中分配的特征向量列表
+typedef ArenaVector<AccessFeatureVector> FeatureVectorList;
+
 // 根据函数信息，提取访存特征，并推断缓存策略
 class AccessStrategyDeducter
 {
 public:
-    int C_total = 60 * 1024;
-    std::string funcName;
-    std::vector<AccessFeatureVector> accessFeatureVectors;
+    int C_total = HardwareProfile::getInstance().smSize;
+    // AM总空间，AM模式下向量访问的变量在其中划分
+    int amTotal = HardwareProfile::getInstance().amSize;
+    // 硬件参数，用于DMA流水分析
+    HardwareProfile profile = HardwareProfile::getInstance();
+    // 策略选择模型，为空时使用全局默认模型
+    const StrategyCostModel *costModel = nullptr;
+    InternedName funcName;
+    FeatureVectorList accessFeatureVectors;
     int spaceUsage = 0;
     constexpr const static double strategy_determine_factor = 0.14;
+    // 单位步长访问占比不低于该值的变量视为向量访问
+    constexpr const static double vector_stride_share = 0.9;
 
     AccessStrategyDeducter() {};
     ~AccessStrategyDeducter() {};
     // 按照空间划分因子计算各个变量的SM空间大小
     void calculateC();
     // 按照空间划分因子计算各个变量的SM空间大小
-    static void calculateC(std::vector<AccessFeatureVector> &accessFeatureVectors, int C_total);
-    // 推断缓存策略
-    static void determineStrategy(std::vector<AccessFeatureVector> &accessFeatureVectors);
-    // 确定参数
-    static void determineParameters(std::vector<AccessFeatureVector> &accessFeatureVectors);
+    static void calculateC(FeatureVectorList &accessFeatureVectors, int C_total);
+    // 推断缓存策略（使用全局默认模型和硬件参数）
+    static void determineStrategy(FeatureVectorList &accessFeatureVectors);
+    // 估算各候选策略的代价，并按指定模型推断缓存策略
+    static void determineStrategy(FeatureVectorList &accessFeatureVectors,
+                                  const StrategyCostModel &model, const HardwareProfile &profile);
+    // 计算DIRECT策略的set和line参数
+    static void calculateDirectParameters(const AccessFeatureVector &featureVector, int &set, int &line);
+    // 确定参数；alignment为区域对齐字节数（2的幂），AM中取向量宽度：BULK区域向上取整，SINGLE的行不小于对齐
+    static void determineParameters(FeatureVectorList &accessFeatureVectors, int alignment = 1);
     // 决策模型，推断函数中各个变量的缓存策略和缓存策略参数
     void deductAccessStrategy(const FunctionInfo &func);
+    // 是否启用AM模式：向量访问的变量放入AM，与SM各自划分空间（--am）
+    static bool isAmEnabled();
+    static void setAmEnabled(bool enabled);
+    // 是否为单位步长的向量访问
+    static bool isVectorAccess(const AccessFeatureVector &featureVector);
+    // 推断结果在指定存储中占用的空间（字节）
+    static int getSpaceUsage(const FeatureVectorList &accessFeatureVectors, TargetMemory memory);
     // 打印缓存策略
     void printAccessStrategy() const;
     // 打印单行策略
@@ -135,4 +275,9 @@ public:
     void removeSpaceUsage(const int &spaceUsage) { this->spaceUsage -= spaceUsage; }
     // 检查空间占用是否超过SM空间大小
     bool checkSpaceUsage() const { return this->spaceUsage > SM_SPACE_SIZE; }
+
+private:
+    // 在一个存储中循环决策：BULK变量按alignment对齐后占用的空间扣除后重新划分其余变量，结果追加到results
+    void deductMemory(FeatureVectorList &candidates, int C_total, const StrategyCostModel &model, int alignment,
+                      FeatureVectorList &results) const;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "BoundedQueue.hpp"
+#include "DirectPlacement.hpp"
+#include "HierarchyPlanner.hpp"
+#include "MonotonicArena.hpp"
+#include "OperatorInfo.hpp"
+#include "PhaseDetector.hpp"
+#include "SamplingUncertainty.hpp"
+#include "TilingAdvisor.hpp"
+#include "VariableGrouping.hpp"
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 流水线的一个输入文件
+class AnalysisInput
+{
+public:
+    std::string path;
+    std::string opName;
+    // 传统格式的数据集名，通用格式为"UNKNOWN"
+    std::string dataset;
+    bool isLegacy = false;
+};
+
+/**
+ * @brief 在流水线中流转的单个文件的分析任务
+ *
+ * 文件的OperatorInfo与推断结果都分配在任务自己的内存池上，任务写出后整体释放。
+ * 同一时刻只有一个阶段持有任务，内存池不会被并发访问。
+ */
+class AnalysisJob
+{
+public:
+    // 输入序号，写出阶段按序号恢复输入顺序
+    size_t sequence = 0;
+    AnalysisInput input;
+    bool exists = false;
+    // 文件内容，解析后释放
+    std::string content;
+    // 内存池须先于使用它的成员构造、后于它们析构
+    MonotonicArena arena;
+    OperatorInfo op;
+    // 每个函数的推断结果，与op.functions一一对应
+    std::vector<FeatureVectorList> results;
+    // 抽样跟踪的估计值及抽样误差可能改变策略的变量
+    TraceSampling sampling;
+    std::vector<SamplingRisk> samplingRisks;
+    // 启用阶段检测时原始跟踪各内核的阶段及重配置收益
+    std::vector<KernelPhases> phases;
+    // 启用分块建议时每个函数的分块方案，与op.functions一一对应
+    std::vector<TilingPlan> tilingPlans;
+    // 启用放置方案时每个函数的SM排布及DIRECT变量的地址偏移，与op.functions一一对应
+    std::vector<PlacementMap> placements;
+    // 启用两级规划时每个函数的DDR/GSM/SM放置方案，与op.functions一一对应
+    std::vector<HierarchyPlan> hierarchyPlans;
+    // 启用分组分析时原始跟踪各内核的窗口访问统计，及每个函数的变量分组，后者与op.functions一一对应
+    std::vector<CoAccessProfile> coAccess;
+    std::vector<GroupingPlan> groupingPlans;
+};
+
+/**
+ * @brief 读取 → 解析 → 推断 → 写出 四级流水线
+ *
+ * 一个预读线程按输入顺序读入文件内容，若干解析线程与推断线程并行处理，
+ * 调用线程作为唯一的写出者按输入顺序交给writer回调。各级之间用有界无锁队列连接，
+ * 在途任务数（含等待重排序的任务）不超过 2×队列深度+工作线程数，内存占用随之有界。
+ */
+class AnalysisPipeline
+{
+public:
+    // 工作线程数（解析与推断合计），0表示使用硬件并发数
+    unsigned int jobs = 0;
+    // 每个队列的深度
+    size_t queueDepth = 4;
+
+    typedef std::function<void(const AnalysisJob &)> Writer;
+    void run(const std::vector<AnalysisInput> &inputs, const Writer &writer);
+
+    // 输出各级队列的占用统计
+    void printStats(std::ostream &os) const;
+
+private:
+    class StageStats
+    {
+    public:
+        std::string name;
+        unsigned int workers = 0;
+        BoundedQueue<AnalysisJob *>::Stats queue;
+    };
+
+    std::vector<StageStats> stats;
+    size_t maxReorderBacklog = 0;
+    double elapsedSeconds = 0;
+
+    static void parse(AnalysisJob &job);
+    static void deduce(AnalysisJob &job);
+};
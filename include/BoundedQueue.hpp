@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief 有界无锁多生产者多消费者队列
+ *
+ * 环形缓冲区的每个槽位带序号，生产者与消费者各自通过CAS推进位置（Vyukov算法），
+ * 不使用互斥锁。容量向上取整为2的幂。push/pop在队列满/空时先自旋让出CPU，
+ * 再短暂休眠；所有生产者结束后调用close()，消费者取空后pop返回false。
+ * 同时统计入队次数、入队时的占用量以及生产者/消费者的等待次数。
+ */
+template <typename T> class BoundedQueue
+{
+public:
+    // 队列占用统计
+    class Stats
+    {
+    public:
+        size_t capacity = 0;
+        size_t pushes = 0;
+        // 入队时队列占用量之和，除以入队次数为平均占用量
+        size_t occupancySum = 0;
+        size_t maxOccupancy = 0;
+        // 因队列满而等待的入队次数
+        size_t fullWaits = 0;
+        // 因队列空而等待的出队次数
+        size_t emptyWaits = 0;
+
+        double getAverageOccupancy() const { return pushes > 0 ? static_cast<double>(occupancySum) / pushes : 0.0; }
+    };
+
+    explicit BoundedQueue(size_t minCapacity)
+    {
+        capacity = 2;
+        while (capacity < minCapacity) {
+            capacity *= 2;
+        }
+        mask = capacity - 1;
+        cells.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    bool tryPush(const T &value)
+    {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < position) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T &value)
+    {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position + 1) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < position + 1) {
+                return false;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 阻塞入队
+    void push(const T &value)
+    {
+        size_t occupancy = size();
+        if (!tryPush(value)) {
+            fullWaits.fetch_add(1, std::memory_order_relaxed);
+            for (unsigned int spins = 0; !tryPush(value); spins++) {
+                backoff(spins);
+            }
+            occupancy = capacity;
+        }
+        pushes.fetch_add(1, std::memory_order_relaxed);
+        occupancySum.fetch_add(occupancy, std::memory_order_relaxed);
+        size_t previousMax = maxOccupancy.load(std::memory_order_relaxed);
+        while (occupancy > previousMax &&
+               !maxOccupancy.compare_exchange_weak(previousMax, occupancy, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 阻塞出队，队列已关闭且为空时返回false
+    bool pop(T &value)
+    {
+        if (tryPop(value)) {
+            return true;
+        }
+        emptyWaits.fetch_add(1, std::memory_order_relaxed);
+        for (unsigned int spins = 0;; spins++) {
+            if (closed.load(std::memory_order_acquire)) {
+                // 关闭前入队的元素仍需取出
+                return tryPop(value);
+            }
+            backoff(spins);
+            if (tryPop(value)) {
+                return true;
+            }
+        }
+    }
+
+    // 所有生产者结束后调用
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // 近似占用量
+    size_t size() const
+    {
+        size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+        return (enqueued > dequeued) ? std::min(enqueued - dequeued, capacity) : 0;
+    }
+    size_t getCapacity() const { return capacity; }
+
+    Stats getStats() const
+    {
+        Stats stats;
+        stats.capacity = capacity;
+        stats.pushes = pushes.load(std::memory_order_relaxed);
+        stats.occupancySum = occupancySum.load(std::memory_order_relaxed);
+        stats.maxOccupancy = maxOccupancy.load(std::memory_order_relaxed);
+        stats.fullWaits = fullWaits.load(std::memory_order_relaxed);
+        stats.emptyWaits = emptyWaits.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    class Cell
+    {
+    public:
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t capacity;
+    size_t mask;
+    // 入队与出队位置分处不同缓存行，避免生产者与消费者互相干扰
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) std::atomic<size_t> dequeuePosition{0};
+    alignas(64) std::atomic<bool> closed{false};
+    std::atomic<size_t> pushes{0};
+    std::atomic<size_t> occupancySum{0};
+    std::atomic<size_t> maxOccupancy{0};
+    std::atomic<size_t> fullWaits{0};
+    std::atomic<size_t> emptyWaits{0};
+
+    static void backoff(unsigned int spins)
+    {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+};
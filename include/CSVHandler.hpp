@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <set>
 #include <sstream>
 
 // CSV处理工具类
@@ -45,12 +46,15 @@ private:
     // 创建目录
     void createDirectory(const std::string& path);
 
-    // CSV列名（传统格式）
+    // CSV列名（传统格式），新增列只追加在末尾
     const std::vector<std::string> legacyColumns = {
         "计算负载", "核函数名", "变量名", 
         "预分配空间大小", "数据块大小", "访存次数", 
         "访存步长和占比", "访存密度", "访存空间局部性", 
-        "访存策略名", "line", "set"
+        "访存策略名", "line", "set",
+        "缓冲级数", "缓冲区大小", "停顿降低比例",
+        "BULK代价", "SINGLE代价", "DIRECT代价",
+        "预取距离", "预取块大小"
     };
     
     // CSV列名（通用格式，去掉计算负载列）
@@ -58,7 +62,10 @@ private:
         "核函数名", "变量名", 
         "预分配空间大小", "数据块大小", "访存次数", 
         "访存步长和占比", "访存密度", "访存空间局部性", 
-        "访存策略名", "line", "set"
+        "访存策略名", "line", "set",
+        "缓冲级数", "缓冲区大小", "停顿降低比例",
+        "BULK代价", "SINGLE代价", "DIRECT代价",
+        "预取距离", "预取块大小"
     };
 
     // 通用写入函数
@@ -66,14 +73,22 @@ private:
                                    const std::string& funcName, const AccessFeatureVector& featureVector,
                                    bool useLegacyFormat);
 
+    // 写出两种格式共有的追加列（缓冲、各策略代价、预取），接在set列之后
+    void writeAppendedColumns(std::wostream& csvFile, const AccessFeatureVector& featureVector);
+
+    // 已有结果文件的标题行是否与当前列定义一致
+    bool headerMatches(const std::string& path, const std::vector<std::string>& columns);
+
     // 构建模式字符串
-    std::string buildPatternsString(const std::vector<std::pair<int, double>>& patterns);
+    std::string buildPatternsString(const AccessPatterns& patterns);
 
     // 验证并修复访存密度和空间局部性的值
     void validateAndFixMetrics(double& density, double& locality);
     
     // 控制输出UTF-8 BOM的标志
     bool outputUTF8BOM = true;
+    // 本次运行中已检查过标题行的结果文件
+    std::set<std::string> checkedFiles;
     
     // 字符串编码转换函数
     std::wstring utf8ToWide(const std::string& str);
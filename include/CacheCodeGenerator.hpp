@@ -0,0 +1,107 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include <map>
+#include <string>
+#include <vector>
+
+// 生成缓存配置代码所需的单个变量信息
+class CacheVariable
+{
+public:
+    std::string name;
+    AccessStrategy strategy = UNSUITABLE;
+    int set = 0;
+    int line = 0;
+    // 划分给该变量的SM空间C（字节）
+    int budget = 0;
+    // 需要占用的SM空间（字节），含SINGLE策略多缓冲、预取额外申请的空间
+    int footprint = 0;
+    int bufferCount = 1;
+    int bufferSize = 0;
+    // 预取距离（块数）与块大小（字节），不预取时为0
+    int prefetchDistance = 0;
+    int prefetchChunk = 0;
+    // 分配的SM区域（AM变量为AM中的区域），由packOffsets填写
+    int smOffset = 0;
+    TargetMemory memory = MEMORY_SM;
+
+    CacheVariable() {};
+    explicit CacheVariable(const AccessFeatureVector &featureVector);
+    // 是否需要SM区域（UNSUITABLE变量直接访问DDR）
+    bool usesSM() const { return strategy != UNSUITABLE && memory == MEMORY_SM; }
+    // 是否需要AM区域（AM模式下的向量访问变量）
+    bool usesAM() const { return strategy != UNSUITABLE && memory == MEMORY_AM; }
+};
+
+/**
+ * @brief 由推断结果生成按函数的缓存配置头文件
+ *
+ * 代码由模板驱动：{{name}}替换为字段值，{{#variables}}...{{/variables}}对每个占用SM的变量重复，
+ * {{#vectors}}...{{/vectors}}对每个占用AM的变量重复，{{#unsuitable}}...{{/unsuitable}}对每个直接访问DDR的变量重复；
+ * 节标记后紧跟的换行被吞掉。
+ * 文件字段：op、dataset、function、prefix、guard、alignment、sm_size、sm_total、am_size、am_total、variable_count；
+ * 变量字段：var、VAR、strategy、set、line、offset、size、budget、buffer_count、buffer_size、prefetch_distance、prefetch_chunk。
+ * SM区域按变量顺序依次排布，起始地址按硬件配置的sm_alignment对齐，互不重叠；AM区域在AM中同样排布，按向量宽度对齐。
+ */
+class CacheCodeGenerator
+{
+public:
+    CacheCodeGenerator();
+
+    /**
+     * @brief 为一个函数生成头文件内容
+     *
+     * @param output 生成的代码（输出参数）
+     * @param error 失败原因（输出参数）
+     * @return false SM或AM区域总量超出其容量
+     */
+    bool generate(const std::string &opName, const std::string &dataset, const std::string &funcName,
+                  std::vector<CacheVariable> &variables, std::string &output, std::string &error) const;
+
+    /**
+     * @brief 按顺序为占用指定存储的变量分配对齐且互不重叠的区域
+     *
+     * @return 已用空间（字节，含对齐填充）
+     */
+    static int packOffsets(std::vector<CacheVariable> &variables, int alignment, TargetMemory memory = MEMORY_SM);
+    // 转换为大写C标识符，非字母数字字符替换为'_'
+    static std::string toIdentifier(const std::string &name);
+    // 头文件名（不含目录）：<op>[_<dataset>]_<function>.h
+    static std::string getFileName(const std::string &opName, const std::string &dataset, const std::string &funcName);
+
+    // 内置模板
+    static const std::string &getBuiltinTemplate();
+    // 默认模板，--codegen-template加载后替换内置模板
+    static const std::string &getDefaultTemplate();
+    static bool loadDefaultTemplate(const std::string &path);
+
+private:
+    class Token
+    {
+    public:
+        enum Kind
+        {
+            TEXT,
+            FIELD,
+            SECTION
+        };
+        Kind kind;
+        std::string text;
+        // SECTION：节结束后的下一个记号
+        size_t end = 0;
+    };
+    typedef std::map<std::string, std::string> FieldMap;
+    // 节名 → 该节逐个变量的字段
+    typedef std::map<std::string, std::vector<FieldMap>> SectionMap;
+
+    std::vector<Token> tokens;
+    int alignment;
+    int smSize;
+    int amSize;
+    int vectorWidth;
+
+    static bool parse(const std::string &text, std::vector<Token> &tokens, std::string &error);
+    void render(size_t begin, size_t end, const FieldMap &fileFields, const FieldMap *variableFields,
+                const SectionMap &sections, std::string &output) const;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "TraceReader.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 分块压缩跟踪文件头；其后依次为各数据块、变量表（TraceVariableRecord加名称）与块索引
+struct ChunkedTraceHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t variableCount;
+    uint64_t chunkCount;
+    uint64_t addressCount;
+    uint64_t variablesOffset;
+    uint64_t indexOffset;
+};
+
+/**
+ * @brief 块索引项
+ *
+ * 每个块是某线程对某变量的一段连续访问，地址以相对前一地址的zigzag varint差值存放；
+ * previousAddress为该段之前的最后一个地址（0表示序列开始），使每个块都能独立解码。
+ */
+struct ChunkIndexEntry
+{
+    uint64_t offset;
+    uint64_t previousAddress;
+    uint32_t length;
+    uint32_t count;
+    uint32_t variable;
+    uint32_t thread;
+};
+
+/**
+ * @brief 差值varint压缩的分块跟踪（.mtc）
+ *
+ * 由原始跟踪（.mtrace）转换得到。解码时按块并行，直接累计到构建VariableInfo.patterns的步长直方图。
+ */
+class ChunkedTrace
+{
+public:
+    static const uint32_t VERSION = 1;
+    // 每块最多的地址个数
+    static const uint32_t CHUNK_ADDRESSES = 65536;
+
+    class ConvertStats
+    {
+    public:
+        uint64_t addresses = 0;
+        uint64_t chunks = 0;
+        uint64_t rawBytes = 0;
+        uint64_t compressedBytes = 0;
+    };
+
+    static bool isChunkedTrace(const std::string &content);
+    static bool isChunkedTracePath(const std::string &path);
+    // 文件头中的地址总数
+    static uint64_t getAddressCount(const std::string &content);
+
+    /**
+     * @brief 将原始跟踪流式转换为分块压缩格式
+     *
+     * @return false 输入无法读取、格式错误或输出无法写入
+     */
+    static bool convert(const std::string &rawPath, const std::string &outPath, ConvertStats &stats);
+
+    /**
+     * @brief 并行解码全部块并统计各变量的访问次数与步长直方图
+     *
+     * @param jobs 线程数，0表示使用硬件并发数
+     * @param reuseSampleRate 重用距离的地址抽样模数，0表示不计算（见TraceReader::getReuseSampleRate）
+     * @return false 文件格式错误
+     */
+    static bool decode(const std::string &content, unsigned int jobs, std::vector<TraceVariable> &variables,
+                       uint64_t reuseSampleRate = 0);
+
+    // 解码吞吐基准：按1、2、4……直至jobs个线程重复解码，输出每秒解码的字节数与地址数
+    static int runBenchmark(const std::string &path, unsigned int jobs, std::ostream &os);
+
+private:
+    static bool decodeReuse(const unsigned char *data, const std::vector<ChunkIndexEntry> &index, unsigned int jobs,
+                            uint64_t reuseSampleRate, std::vector<TraceVariable> &variables);
+};
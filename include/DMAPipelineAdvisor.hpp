@@ -0,0 +1,59 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include <vector>
+
+// DMA流水分析：根据访存特征和分配的SM空间，为BULK/SINGLE变量推荐多缓冲方案
+class DMAPipelineAdvisor
+{
+public:
+    // 最小的缓冲区大小（字节），更小的传输块会被DMA启动延迟主导
+    static const int MIN_BUFFER_LINE = 6;
+    // 主导步长不超过该元素数、且占比不低于MIN_STREAM_SHARE的SINGLE变量才做预取建议
+    static const int MAX_PREFETCH_STRIDE = 4;
+    constexpr static double MIN_STREAM_SHARE = 0.5;
+
+    /**
+     * @brief 为函数中所有变量生成多缓冲建议
+     *
+     * 先统计各变量策略的实际SM占用，剩余的SM空间按停顿收益从高到低分配给SINGLE变量的额外缓冲区；
+     * BULK变量在自身已占用的区域内分块传输，不需要额外空间。
+     *
+     * @param accessFeatureVectors 已确定策略和参数的访存特征向量
+     * @param C_total SM总空间（字节）
+     * @param profile 硬件参数
+     */
+    static void adviseBuffering(FeatureVectorList &accessFeatureVectors, int C_total,
+                                const HardwareProfile &profile);
+
+    /**
+     * @brief 为主导步长较小的SINGLE变量生成预取距离与块大小建议
+     *
+     * 每块数据上的计算周期由主导步长及其占比给出（每块访问chunk/(步长字节×占比)次），并以访存密度D×chunk为上限，
+     * 预取距离取能掩盖一次DMA传输的块数；环形区域(距离+1)×块大小在变量已占用区域（含多缓冲）
+     * 与多缓冲分配后剩余的SM空间内选取，剩余空间按停顿收益从高到低分配。须在adviseBuffering之后调用。
+     * 预取与多缓冲只取其一：预取的停顿降低比例更高时取消该变量的多缓冲，环形区域复用其空间，否则不预取。
+     *
+     * @param accessFeatureVectors 已确定策略、参数和多缓冲方案的访存特征向量
+     * @param C_total SM总空间（字节）
+     * @param profile 硬件参数
+     */
+    static void advisePrefetch(FeatureVectorList &accessFeatureVectors, int C_total, const HardwareProfile &profile);
+
+    // 变量实际占用的区域大小（字节），SINGLE变量含多缓冲或预取环形区域申请的额外空间
+    static int getRegionSize(const AccessFeatureVector &featureVector);
+
+private:
+    // 在spareSpace额外空间内为SINGLE变量寻找停顿最小的缓冲方案
+    static BufferingPlan planSingle(const AccessFeatureVector &featureVector, int spareSpace,
+                                    const HardwareProfile &profile);
+    // 在BULK变量自身区域内寻找最优的分块传输方案
+    static BufferingPlan planBulk(const AccessFeatureVector &featureVector, const HardwareProfile &profile);
+    // k个缓冲区流水时的总停顿周期
+    static double pipelinedStall(const AccessFeatureVector &featureVector, int chunk, int bufferCount,
+                                 const HardwareProfile &profile);
+    // 在spareSpace额外空间内为SINGLE变量寻找停顿最小的预取方案，不满足流式访问条件时返回空方案
+    static PrefetchPlan planPrefetch(const AccessFeatureVector &featureVector, int spareSpace,
+                                     const HardwareProfile &profile);
+};
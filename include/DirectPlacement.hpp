@@ -0,0 +1,81 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include "TilingAdvisor.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 单个变量在SM中的位置，DIRECT变量另有地址哈希偏移及模拟的缺失率
+class VariablePlacement
+{
+public:
+    std::string name;
+    AccessStrategy strategy = UNSUITABLE;
+    int set = 0;
+    int line = 0;
+    // SM区域（字节），与--format=header的排布一致；AM模式下的向量变量为AM中的区域
+    TargetMemory memory = MEMORY_SM;
+    int smOffset = 0;
+    int footprint = 0;
+
+    // 以下只对DIRECT变量有意义：推断的数组形状、每行的填充元素数（组索引计算时地址加上 行号×skewBytes）
+    ArrayShape shape;
+    uint64_t padElements = 0;
+    uint64_t skewBytes = 0;
+    // 模拟的缺失率：不加偏移与选定偏移
+    double baseMissRate = 0.0;
+    double missRate = 0.0;
+    // 按访问次数N换算的缺失减少次数及节省的周期
+    double missReduction = 0.0;
+    double cyclesSaved = 0.0;
+};
+
+// 单个函数的放置方案
+class PlacementMap
+{
+public:
+    std::string funcName;
+    int smUsed = 0;
+    std::vector<VariablePlacement> variables;
+    double missReduction = 0.0;
+    double cyclesSaved = 0.0;
+
+    bool hasDirect() const;
+};
+
+/**
+ * @brief 考虑冲突的DIRECT变量放置
+ *
+ * 各变量的软件缓存区域在SM中按变量顺序对齐排布、互不重叠（与CacheCodeGenerator::packOffsets一致），
+ * 因此变量之间不会相互冲突，冲突缺失来自同一变量内的地址混叠：例如行长为2的幂的数组按列访问时，
+ * 各行的同一列映射到同一组。对每个DIRECT变量，按其步长直方图合成访问序列（主要步长连续前进，
+ * 回绕步长在已前进的距离内时向后跳转，未覆盖的部分为伪随机访问），在其set/line的直接映射缓存上模拟
+ * 不同的行填充（地址哈希偏移），选取缺失最少的偏移；同样少时取较小的偏移。一维数组没有行、只有一组的缓存没有组索引，均不加偏移。
+ */
+class DirectPlacement
+{
+public:
+    // 每次模拟的访问次数上限
+    static const uint64_t SIMULATION_ACCESSES = 1 << 16;
+    // 候选填充：0..MAX_LINEAR_PAD个元素，以及不超过一行缓存的2的幂
+    static const uint64_t MAX_LINEAR_PAD = 16;
+
+    // 推断后是否给出DIRECT变量的放置方案（--placement）
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief 在set/line的直接映射缓存上模拟变量的访问
+     *
+     * @param padElements 每行的填充元素数，一维数组忽略
+     * @return 缺失率
+     */
+    static double simulate(const AccessFeatureVector &featureVector, const ArrayShape &shape, int set, int line,
+                           uint64_t padElements, int elementSize);
+
+    static PlacementMap place(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                              const HardwareProfile &profile);
+    static void printReport(const std::vector<PlacementMap> &maps, std::ostream &os);
+};
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <istream>
 
 namespace FileUtils {
     // 默认的排除文件列表
@@ -17,6 +19,54 @@ namespace FileUtils {
      */
     bool fileExists(const std::string& path);
     
+    /**
+     * @brief 检查路径是否为目录
+     * 
+     * @param path 路径
+     * @return true 是已存在的目录
+     */
+    bool isDirectory(const std::string& path);
+    
+    /**
+     * @brief 获取文件或目录的修改时间
+     * 
+     * @param path 路径
+     * @param seconds 秒（输出参数）
+     * @param nanoseconds 纳秒部分，平台不支持时为0（输出参数）
+     * @return false 路径不存在
+     */
+    bool getModificationTime(const std::string& path, long long& seconds, long long& nanoseconds);
+    
+    /**
+     * @brief 将整个文件读入内存
+     * 
+     * @param path 文件路径
+     * @param content 文件内容（输出参数）
+     * @return false 文件无法打开
+     */
+    bool readFile(const std::string& path, std::string& content);
+    
+    /**
+     * @brief 去掉字符串首尾的空白字符
+     * 
+     * @param str 字符串
+     * @return std::string 去掉首尾空白后的字符串
+     */
+    std::string trim(const std::string& str);
+    
+    /**
+     * @brief 逐行解析"键 = 值"格式的配置，'#'之后为注释，空行跳过
+     * 
+     * 缺少'='的行、handler抛出异常的行给出警告并跳过；handler返回false时警告未知参数。
+     * 
+     * @param in 输入流
+     * @param path 文件路径，仅用于警告信息
+     * @param handler 处理一个键值对，返回false表示未知参数，值无法解析时抛出异常
+     * @return false 存在缺少'='或值解析失败的行
+     */
+    bool parseKeyValueLines(std::istream& in, const std::string& path,
+                            const std::function<bool(const std::string&, const std::string&)>& handler);
+    
     /**
      * @brief 创建目录
      * 
@@ -34,6 +84,18 @@ namespace FileUtils {
     std::vector<std::string> getSubdirectories(const std::string& path, 
                                             const std::vector<std::string>& excludeList = DEFAULT_EXCLUDE_FILES);
     
+    /**
+     * @brief 单次遍历列出目录下的普通文件与子目录
+     * 
+     * @param path 目录路径
+     * @param files 文件名列表（输出参数，追加）
+     * @param dirs 子目录名列表（输出参数，追加）
+     * @param excludeList 要排除的文件或目录列表
+     * @return false 目录无法打开
+     */
+    bool listDirectory(const std::string& path, std::vector<std::string>& files, std::vector<std::string>& dirs,
+                       const std::vector<std::string>& excludeList = DEFAULT_EXCLUDE_FILES);
+    
     /**
      * @brief 检查CSV文件名是否为传统格式并提取信息
      * 
@@ -53,6 +115,15 @@ namespace FileUtils {
      */
     std::vector<std::string> getCSVFiles(const std::string& path);
     
+    /**
+     * @brief 获取指定目录下指定扩展名的所有文件
+     * 
+     * @param path 目录路径
+     * @param extension 扩展名（含"."，如".bin"）
+     * @return std::vector<std::string> 文件名列表
+     */
+    std::vector<std::string> getFilesWithExtension(const std::string& path, const std::string& extension);
+    
     /**
      * @brief 从文件路径中提取文件名（不包含路径和扩展名）
      * 
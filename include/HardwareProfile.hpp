@@ -0,0 +1,64 @@
+#pragma once
+
+#include "OperatorInfo.hpp"
+#include <string>
+
+// MT-3000 硬件参数配置（延迟单位为时钟周期，带宽单位为字节/周期）
+class HardwareProfile
+{
+public:
+    // SM空间大小（字节）
+    int smSize = SM_SPACE_SIZE;
+    // SM区域起始地址的对齐字节数（2的幂）
+    int smAlignment = 64;
+    // SM访问延迟
+    double smLatency = 1.0;
+    // 不经缓存直接访问DDR的延迟
+    double ddrLatency = 120.0;
+    // DMA单次传输的启动延迟
+    double dmaLatency = 400.0;
+    // DMA带宽
+    double dmaBandwidth = 16.0;
+    // 每次访存对应的平均计算周期（含SM访问）
+    double computeCyclesPerAccess = 2.0;
+    // 数据元素长度（字节），步长以元素为单位
+    int elementSize = 4;
+    // AM（向量单元访问的阵列存储）空间大小（字节），AM模式下使用
+    int amSize = 768 * 1024;
+    // 向量单元一次访问的字节数（2的幂），AM中的行按其对齐
+    int vectorWidth = 128;
+    // GSM（簇内共享的全局存储）空间大小（字节），为0时不使用该层
+    int gsmSize = 6 * 1024 * 1024;
+    // 核直接访问GSM的延迟
+    double gsmLatency = 30.0;
+    // GSM与SM之间DMA传输的启动延迟与带宽
+    double gsmDmaLatency = 100.0;
+    double gsmDmaBandwidth = 64.0;
+
+    HardwareProfile() {};
+    ~HardwareProfile() {};
+
+    // 全局默认配置，启动时可从文件加载
+    static HardwareProfile &getInstance()
+    {
+        static HardwareProfile instance;
+        return instance;
+    }
+
+    /**
+     * @brief 从配置文件加载硬件参数
+     *
+     * 文件格式为每行一个 key = value，# 开头为注释，未出现的键保持默认值
+     *
+     * @param path 配置文件路径
+     * @return true 加载成功
+     * @return false 文件无法打开或存在无法解析的行
+     */
+    bool loadFromFile(const std::string &path);
+
+    // 单次DMA传输指定字节数所需的周期
+    double dmaCycles(double bytes) const { return dmaLatency + bytes / dmaBandwidth; }
+    // 数据暂存在GSM时的参数：DMA来源与直接访问均改为GSM
+    HardwareProfile getGsmSourced() const;
+    void printInfo() const;
+};
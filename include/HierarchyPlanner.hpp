@@ -0,0 +1,78 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 变量数据所在的存储层：留在DDR，或整体暂存到GSM
+enum MemoryTier
+{
+    TIER_DDR,
+    TIER_GSM
+};
+
+// 单个变量的两级放置
+class TierPlacement
+{
+public:
+    std::string name;
+    // 推断器的单层结果（数据在DDR）及其估算周期
+    AccessStrategyConfig original = AccessStrategyConfig(UNSUITABLE);
+    double originalCycles = 0.0;
+
+    // 规划结果：数据来源层及SM策略，UNSUITABLE表示核直接访问来源层
+    MemoryTier home = TIER_DDR;
+    AccessStrategyConfig config = AccessStrategyConfig(UNSUITABLE);
+    // 暂存到GSM时占用的GSM空间及DDR→GSM的载入周期（已计入cycles）
+    unsigned long long gsmBytes = 0;
+    double stagingCycles = 0.0;
+    double cycles = 0.0;
+};
+
+// 单个函数的两级放置方案
+class HierarchyPlan
+{
+public:
+    std::string funcName;
+    int gsmCapacity = 0;
+    unsigned long long gsmUsed = 0;
+    std::vector<TierPlacement> variables;
+    double originalCycles = 0.0;
+    double plannedCycles = 0.0;
+
+    bool hasStaging() const;
+};
+
+/**
+ * @brief DDR / GSM / SM 两级放置规划
+ *
+ * 推断器只在SM一层中划分空间。规划器在其结果之上再决定每个变量的数据是留在DDR，还是先一次DMA整体暂存到GSM：
+ * 暂存后SM的缺失改由GSM供给（HardwareProfile::getGsmSourced的延迟与带宽），SM一侧沿用推断器划分的C，
+ * 由当前策略模型按GSM来源的代价重新选择策略，所选策略不可行时核直接访问GSM。超过GSM容量的变量只能留在DDR（不模拟GSM一级的缓存）。
+ * 同一函数的变量按估算周期之和最小联合选择暂存集合（GSM容量内的0/1背包，最多GSM_UNITS个单位），
+ * 暂存不能降低周期的变量保持推断器的结果。不计写回GSM/DDR的开销。
+ */
+class HierarchyPlanner
+{
+public:
+    // 背包的最大单位数，单位取GSM容量/GSM_UNITS与smAlignment中的较大者
+    static const int GSM_UNITS = 4096;
+
+    // 推断后是否给出两级放置方案（--hierarchy）
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // 变量暂存到GSM时的放置及估算周期，gsmBytes为0表示无法暂存
+    static TierPlacement evaluateStaging(const AccessFeatureVector &featureVector, const HardwareProfile &profile);
+
+    /**
+     * @brief 为函数生成两级放置方案
+     *
+     * @param accessFeatureVectors 推断器给出的结果
+     */
+    static HierarchyPlan plan(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                              const HardwareProfile &profile);
+    static void printReport(const std::vector<HierarchyPlan> &plans, std::ostream &os);
+};
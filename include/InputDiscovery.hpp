@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// 一次发现得到的输入文件清单，只包含实际存在的文件
+class InputManifest
+{
+public:
+    class Entry
+    {
+    public:
+        std::string path;
+        std::string opName;
+        // 传统格式的数据集名，通用格式为空
+        std::string dataset;
+        bool isLegacy = false;
+    };
+
+    // data/下的传统格式文件，按算子名、数据集规模排序
+    std::vector<Entry> legacyFiles;
+    // 工作目录下的通用格式CSV文件，按文件名排序
+    std::vector<Entry> genericFiles;
+    // 清单是否来自缓存
+    bool fromCache = false;
+
+    // 传统格式文件涉及的算子，按名称排序
+    std::vector<std::string> getOperators() const;
+};
+
+/**
+ * @brief 输入文件发现
+ *
+ * 并行遍历数据目录的各算子子目录（每个子目录一个任务，只收集data/<op>/下算子名与目录名一致的传统格式文件，
+ * 不进入更深的子目录），并扫描工作目录顶层的通用格式CSV，文件名用手写匹配器分类。清单连同所有遍历过的目录的修改时间缓存到cachePath，
+ * 下次发现时若这些目录的修改时间均未变化则直接使用缓存。
+ */
+class InputDiscovery
+{
+public:
+    std::string dataDir = "data";
+    std::string workDir = ".";
+    // 缓存文件路径，为空时不使用缓存
+    std::string cachePath = ".masamt/manifest";
+    // 并行线程数，0表示使用硬件并发数
+    unsigned int jobs = 0;
+
+    InputManifest discover() const;
+
+    // 标准数据集名称，按规模升序
+    static const std::vector<std::string> &getStandardDatasets();
+    // 数据集排序序号，标准数据集按规模，其它数据集排在其后
+    static size_t getDatasetRank(const std::string &dataset);
+
+private:
+    // 目录及其修改时间
+    class DirectoryStamp
+    {
+    public:
+        std::string path;
+        long long seconds = 0;
+        long long nanoseconds = 0;
+    };
+
+    InputManifest scan(std::vector<DirectoryStamp> &stamps) const;
+    bool loadCache(InputManifest &manifest) const;
+    void saveCache(const InputManifest &manifest, const std::vector<DirectoryStamp> &stamps) const;
+    static bool stampDirectory(const std::string &path, DirectoryStamp &stamp);
+    bool classify(const std::string &directory, const std::string &filename, bool underDataDir,
+                  InputManifest::Entry &entry) const;
+};
@@ -0,0 +1,757 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief masamt-trace：直接生成masamt输入的访存跟踪运行时（仅头文件）
+ *
+ * 在主机上编译待分析的内核时包含本头文件：
+ *
+ *     void kernel_gemm(int ni, int nj, double *C) {
+ *         MASAMT_TRACE_KERNEL("kernel_gemm");
+ *         MASAMT_TRACE_ARRAY(C, C, ni * nj * sizeof(double));
+ *         for (...) { MASAMT_TRACE_ACCESS(C, &C[i * nj + j]); C[i * nj + j] *= beta; }
+ *     }
+ *
+ * 每个线程把访问写入自己的无锁环形缓冲区（单生产者单消费者），后台线程异步取出：
+ * 按线程、变量计算相邻访问的地址差并累计步长直方图，或分块写入原始二进制跟踪。
+ * 进程退出或调用MASAMT_TRACE_FLUSH()时写出结果，此后的访问不再记录（进程退出时在stderr报告丢弃的次数）。
+ * 输出路径由环境变量MASAMT_TRACE_OUTPUT指定
+ * （默认masamt_trace.csv）：.csv为masamt的通用CSV格式（文件名即算子名），
+ * 其它扩展名为原始二进制跟踪，可用masamt -f直接分析（建议使用.mtrace扩展名）。
+ * 步长以元素为单位，元素长度取自MASAMT_TRACE_ARRAY的基址类型。
+ * 环境变量MASAMT_TRACE_SAMPLE开启抽样，只记录部分访问：burst:B/P表示各线程对各变量每P次访问记录前B次
+ * （步长只在突发内计算）；hash:R表示记录地址哈希值模R为0的访问及同一序列中它的前一个地址。
+ * 抽样时CSV输出按抽样比例放大访问次数；原始跟踪记录抽样方式，由masamt给出估计值的置信区间。
+ * 定义MASAMT_TRACE_DISABLE时所有宏展开为空，不产生任何开销。
+ */
+namespace MasamtTrace
+{
+
+// 原始二进制跟踪文件头，其后为一系列以tag开头的记录
+struct TraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+enum TraceRecordTag : uint32_t
+{
+    TRACE_VARIABLE = 1,
+    TRACE_BLOCK = 2,
+    TRACE_SAMPLING = 3
+};
+
+// 变量定义，其后紧跟内核名与变量名（均不含'\0'）；同一编号出现多次时以最后一条为准
+struct TraceVariableRecord
+{
+    uint32_t tag;
+    uint32_t id;
+    uint64_t size;
+    uint32_t elementSize;
+    uint16_t kernelLength;
+    uint16_t nameLength;
+};
+
+// 地址块，其后紧跟count个64位地址：同一线程对同一变量的连续访问，按发生顺序排列
+struct TraceBlockRecord
+{
+    uint32_t tag;
+    uint32_t variable;
+    uint32_t thread;
+    uint32_t count;
+};
+
+enum SamplingMode : uint32_t
+{
+    SAMPLE_ALL = 0,
+    SAMPLE_BURST = 1,
+    SAMPLE_HASH = 2
+};
+
+// 抽样方式，抽样跟踪中紧跟文件头；burstLength仅用于突发抽样，period为突发周期或哈希抽样的模数
+struct TraceSamplingRecord
+{
+    uint32_t tag;
+    uint32_t mode;
+    uint64_t burstLength;
+    uint64_t period;
+};
+
+const char TRACE_MAGIC[8] = {'M', 'A', 'S', 'A', 'M', 'T', 'T', '\0'};
+const uint32_t TRACE_VERSION = 1;
+const uint32_t TRACE_BLOCK_ADDRESSES = 4096;
+
+/**
+ * @brief 步长直方图
+ *
+ * 步长为相邻两次访问的距离（元素数，取绝对值，与masamt输入中的Stride一致）。
+ * 不超过NEAR_RANGE的步长直接计数，其余步长放入哈希表；
+ * 连续出现的同一远步长（如按列遍历的行跨度）先在本地累计，变化时才写入哈希表。
+ */
+class StrideHistogram
+{
+public:
+    static const int64_t NEAR_RANGE = 64;
+
+    void add(int64_t stride, uint64_t count = 1)
+    {
+        if (stride <= NEAR_RANGE) {
+            nearCounts[stride] += count;
+        } else if (stride == runStride) {
+            runCount += count;
+        } else {
+            if (runCount > 0) {
+                farCounts[runStride] += runCount;
+            }
+            runStride = stride;
+            runCount = count;
+        }
+        total += count;
+    }
+    void merge(const StrideHistogram &other)
+    {
+        for (int64_t i = 0; i <= NEAR_RANGE; i++) {
+            nearCounts[i] += other.nearCounts[i];
+        }
+        for (const auto &entry : other.farCounts) {
+            farCounts[entry.first] += entry.second;
+        }
+        if (other.runCount > 0) {
+            farCounts[other.runStride] += other.runCount;
+        }
+        total += other.total;
+    }
+    uint64_t getTotal() const { return total; }
+    uint64_t getCount(int64_t stride) const
+    {
+        if (stride >= 0 && stride <= NEAR_RANGE) {
+            return nearCounts[stride];
+        }
+        auto it = farCounts.find(stride);
+        return ((it != farCounts.end()) ? it->second : 0) + ((stride == runStride) ? runCount : 0);
+    }
+
+    // 次数最多的maxStrides个步长及其占比（百分数），次数相同时步长小的在前
+    std::vector<std::pair<int64_t, double>> top(size_t maxStrides) const
+    {
+        std::vector<std::pair<int64_t, uint64_t>> counts;
+        for (int64_t i = 0; i <= NEAR_RANGE; i++) {
+            if (nearCounts[i] > 0) {
+                counts.push_back(std::make_pair(i, nearCounts[i]));
+            }
+        }
+        std::unordered_map<int64_t, uint64_t> far = farCounts;
+        if (runCount > 0) {
+            far[runStride] += runCount;
+        }
+        counts.insert(counts.end(), far.begin(), far.end());
+        size_t count = std::min(maxStrides, counts.size());
+        std::partial_sort(counts.begin(), counts.begin() + count, counts.end(),
+                          [](const std::pair<int64_t, uint64_t> &a, const std::pair<int64_t, uint64_t> &b) {
+                              return (a.second != b.second) ? a.second > b.second : a.first < b.first;
+                          });
+        std::vector<std::pair<int64_t, double>> strides;
+        for (size_t i = 0; i < count; i++) {
+            strides.push_back(std::make_pair(counts[i].first, 100.0 * counts[i].second / total));
+        }
+        return strides;
+    }
+
+private:
+    uint64_t nearCounts[NEAR_RANGE + 1] = {};
+    std::unordered_map<int64_t, uint64_t> farCounts;
+    int64_t runStride = 0;
+    uint64_t runCount = 0;
+    uint64_t total = 0;
+};
+
+// 抽样配置
+class SamplingConfig
+{
+public:
+    SamplingMode mode = SAMPLE_ALL;
+    uint64_t burstLength = 0;
+    uint64_t period = 1;
+
+    bool isSampled() const { return mode != SAMPLE_ALL; }
+    // 每个样本代表的访问次数
+    double getScale() const
+    {
+        if (mode == SAMPLE_BURST) {
+            return static_cast<double>(period) / burstLength;
+        }
+        return (mode == SAMPLE_HASH) ? static_cast<double>(period) : 1.0;
+    }
+    // 哈希抽样是否选中该地址：同一地址总是同时被选中或不被选中
+    static bool hashSelected(uint64_t address, uint64_t rate)
+    {
+        return ((address * 0x9E3779B97F4A7C15ull) >> 32) % rate == 0;
+    }
+
+    // 解析"burst:B/P"或"hash:R"，空串表示不抽样
+    static bool parse(const std::string &spec, SamplingConfig &config)
+    {
+        config = SamplingConfig();
+        if (spec.empty()) {
+            return true;
+        }
+        unsigned long long first = 0, second = 0;
+        char extra;
+        if (std::sscanf(spec.c_str(), "burst:%llu/%llu%c", &first, &second, &extra) == 2 && first > 0 &&
+            second >= first) {
+            config.mode = SAMPLE_BURST;
+            config.burstLength = first;
+            config.period = second;
+            return true;
+        }
+        if (std::sscanf(spec.c_str(), "hash:%llu%c", &first, &extra) == 1 && first > 0) {
+            config.mode = SAMPLE_HASH;
+            config.period = first;
+            return true;
+        }
+        return false;
+    }
+
+    TraceSamplingRecord toRecord() const
+    {
+        TraceSamplingRecord record;
+        record.tag = TRACE_SAMPLING;
+        record.mode = mode;
+        record.burstLength = burstLength;
+        record.period = period;
+        return record;
+    }
+    static bool fromRecord(const TraceSamplingRecord &record, SamplingConfig &config)
+    {
+        config = SamplingConfig();
+        if ((record.mode == SAMPLE_BURST && record.burstLength > 0 && record.period >= record.burstLength) ||
+            (record.mode == SAMPLE_HASH && record.period > 0)) {
+            config.mode = static_cast<SamplingMode>(record.mode);
+            config.burstLength = record.burstLength;
+            config.period = record.period;
+            return true;
+        }
+        return record.mode == SAMPLE_ALL;
+    }
+};
+
+/**
+ * @brief 把一个线程对一个变量的样本序列还原为访问与步长（运行时与masamt共用）
+ *
+ * 不抽样时相邻样本即相邻访问；突发抽样每burstLength个样本为一个突发，步长不跨突发；
+ * 哈希抽样的样本成对出现：被选中访问的前一个地址（0表示没有）与被选中的地址。
+ */
+class SampledSequence
+{
+public:
+    // 哈希抽样中统计置信区间时每批的样本对数
+    static const uint64_t HASH_BATCH = 256;
+
+    /**
+     * @brief 处理下一个样本
+     *
+     * @param hasStride 是否得到一个步长（输出参数）
+     * @param stride 步长，以元素为单位（输出参数）
+     * @param newBatch 该访问是否开始新的批次，突发抽样中一个突发为一批（输出参数）
+     * @return false 样本只是哈希抽样中的前一个地址，不计为访问
+     */
+    bool next(const SamplingConfig &config, uint64_t address, uint64_t elementSize, bool &hasStride,
+              int64_t &stride, bool &newBatch)
+    {
+        newBatch = false;
+        if (config.mode == SAMPLE_HASH && (position++ & 1) == 0) {
+            last = address;
+            return false;
+        }
+        if (config.mode == SAMPLE_BURST) {
+            if (position % config.burstLength == 0) {
+                last = 0;
+                newBatch = position > 0;
+            }
+            position++;
+        } else if (config.mode == SAMPLE_HASH) {
+            newBatch = position > 2 && (position / 2 - 1) % HASH_BATCH == 0;
+        }
+        hasStride = last != 0;
+        if (hasStride) {
+            uint64_t distance = (address > last) ? address - last : last - address;
+            stride = static_cast<int64_t>(distance / elementSize);
+        }
+        last = address;
+        return true;
+    }
+
+private:
+    uint64_t last = 0;
+    uint64_t position = 0;
+};
+
+inline bool isTracePath(const std::string &path)
+{
+    const std::string extension = ".mtrace";
+    return path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+/**
+ * @brief 跟踪运行时
+ *
+ * 数组注册加锁；记录访问只写当前线程的环形缓冲区。缓冲区满时生产者让出CPU等待后台线程取走数据。
+ * 抽样在生产者一侧完成，未选中的访问不进入环形缓冲区。
+ */
+class Tracer
+{
+public:
+    // CSV输出中每个变量保留的步长个数
+    static const size_t MAX_STRIDES = 4;
+
+    static Tracer &instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+    ~Tracer()
+    {
+        stop();
+        uint64_t count = dropped.load(std::memory_order_relaxed);
+        if (count > 0) {
+            std::fprintf(stderr, "masamt-trace: %llu accesses after MASAMT_TRACE_FLUSH() were not traced\n",
+                         static_cast<unsigned long long>(count));
+        }
+    }
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    // 当前线程正在执行的内核名，由KernelScope设置
+    static std::string &currentKernel()
+    {
+        static thread_local std::string kernel = "main";
+        return kernel;
+    }
+
+    // 在当前内核下注册数组，同一内核的同名数组共用编号
+    uint32_t registerArray(const std::string &name, uint64_t size, uint32_t elementSize)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::string key = currentKernel() + '\0' + name;
+        auto it = variableIds.find(key);
+        if (it != variableIds.end()) {
+            Variable &variable = variables[it->second];
+            variable.size = std::max(variable.size, size);
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(variables.size());
+        Variable variable;
+        variable.kernel = currentKernel();
+        variable.name = name;
+        variable.size = size;
+        variable.elementSize = std::max(1u, elementSize);
+        variables.push_back(variable);
+        variableIds[key] = id;
+        if (!flusher.joinable() && !stopped) {
+            start();
+        }
+        return id;
+    }
+
+    void record(uint32_t variable, const void *address)
+    {
+        // 停止后没有消费者，继续写入会在缓冲区满时永远等待
+        if (stopping.load(std::memory_order_relaxed)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        static thread_local ThreadRing *ring = nullptr;
+        if (ring == nullptr) {
+            ring = createRing();
+        }
+        if (!sampling.isSampled()) {
+            ring->push(variable, reinterpret_cast<uintptr_t>(address));
+        } else {
+            ring->sample(sampling, variable, reinterpret_cast<uintptr_t>(address));
+        }
+    }
+
+    // 取出所有缓冲数据并写出结果；调用前应结束所有被跟踪的线程
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) {
+                return;
+            }
+            stopped = true;
+        }
+        stopping.store(true, std::memory_order_release);
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+        drainAll();
+        writeOutput();
+    }
+
+private:
+    class Entry
+    {
+    public:
+        uint64_t address;
+        uint64_t variable;
+    };
+
+    class Variable
+    {
+    public:
+        std::string kernel;
+        std::string name;
+        uint64_t size = 0;
+        uint32_t elementSize = 1;
+    };
+
+    // 消费者一侧的变量副本与统计，只由后台线程（停止后由stop）访问
+    class VariableStats
+    {
+    public:
+        Variable info;
+        uint64_t accesses = 0;
+        StrideHistogram strides;
+        bool written = false;
+    };
+
+    // 单生产者单消费者环形缓冲区，头尾位置分处不同缓存行
+    class ThreadRing
+    {
+    public:
+        static const uint64_t CAPACITY = 1 << 16;
+
+        explicit ThreadRing(uint32_t thread) : entries(new Entry[CAPACITY]), thread(thread) {}
+
+        void push(uint32_t variable, uint64_t address)
+        {
+            uint64_t position = head.load(std::memory_order_relaxed);
+            if (position - cachedTail >= CAPACITY) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                while (position - cachedTail >= CAPACITY) {
+                    std::this_thread::yield();
+                    cachedTail = tail.load(std::memory_order_acquire);
+                }
+            }
+            Entry &entry = entries[position & (CAPACITY - 1)];
+            entry.address = address;
+            entry.variable = variable;
+            head.store(position + 1, std::memory_order_release);
+        }
+
+        void sample(const SamplingConfig &config, uint32_t variable, uint64_t address)
+        {
+            if (variable >= sampleState.size()) {
+                sampleState.resize(variable + 1, 0);
+            }
+            // 突发抽样：周期内的位置；哈希抽样：上一次访问的地址
+            uint64_t &state = sampleState[variable];
+            if (config.mode == SAMPLE_BURST) {
+                if (state < config.burstLength) {
+                    push(variable, address);
+                }
+                state = (state + 1 == config.period) ? 0 : state + 1;
+            } else {
+                if (SamplingConfig::hashSelected(address, config.period)) {
+                    push(variable, state);
+                    push(variable, address);
+                }
+                state = address;
+            }
+        }
+
+        std::unique_ptr<Entry[]> entries;
+        uint32_t thread;
+        char producerPadding[64];
+        std::atomic<uint64_t> head{0};
+        uint64_t cachedTail = 0;
+        std::vector<uint64_t> sampleState;
+        char consumerPadding[64];
+        std::atomic<uint64_t> tail{0};
+        // 以下只由消费者访问：各变量的样本序列与待写出的地址块
+        std::vector<SampledSequence> sequences;
+        std::vector<std::vector<uint64_t>> pending;
+    };
+
+    std::mutex mutex;
+    std::vector<Variable> variables;
+    std::vector<VariableStats> stats;
+    std::map<std::string, uint32_t> variableIds;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::thread flusher;
+    std::atomic<bool> stopping{false};
+    // 停止后丢弃的访问次数
+    std::atomic<uint64_t> dropped{0};
+    bool stopped = false;
+    std::string outputPath;
+    bool binary = false;
+    FILE *traceFile = nullptr;
+    SamplingConfig sampling;
+
+    Tracer()
+    {
+        const char *path = std::getenv("MASAMT_TRACE_OUTPUT");
+        outputPath = (path != nullptr && *path != '\0') ? path : "masamt_trace.csv";
+        binary = outputPath.size() < 4 || outputPath.compare(outputPath.size() - 4, 4, ".csv") != 0;
+        const char *sample = std::getenv("MASAMT_TRACE_SAMPLE");
+        if (sample != nullptr && !SamplingConfig::parse(sample, sampling)) {
+            std::fprintf(stderr, "masamt-trace: invalid MASAMT_TRACE_SAMPLE '%s', tracing every access\n", sample);
+        }
+    }
+
+    void start()
+    {
+        if (binary) {
+            traceFile = std::fopen(outputPath.c_str(), "wb");
+            if (traceFile == nullptr) {
+                std::fprintf(stderr, "masamt-trace: cannot open %s\n", outputPath.c_str());
+            } else {
+                std::setvbuf(traceFile, nullptr, _IOFBF, 1 << 20);
+                TraceFileHeader header;
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+                header.version = TRACE_VERSION;
+                std::fwrite(&header, sizeof(header), 1, traceFile);
+                if (sampling.isSampled()) {
+                    TraceSamplingRecord record = sampling.toRecord();
+                    std::fwrite(&record, sizeof(record), 1, traceFile);
+                }
+            }
+        }
+        flusher = std::thread([this]() {
+            while (!stopping.load(std::memory_order_acquire)) {
+                if (drainAll() == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            }
+        });
+    }
+
+    ThreadRing *createRing()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        rings.push_back(std::unique_ptr<ThreadRing>(new ThreadRing(static_cast<uint32_t>(rings.size()))));
+        return rings.back().get();
+    }
+
+    // 取出所有环形缓冲区中的数据，返回处理的访问次数
+    size_t drainAll()
+    {
+        std::vector<ThreadRing *> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &ring : rings) {
+                snapshot.push_back(ring.get());
+            }
+        }
+        // 先读各缓冲区的写入位置再读变量表：其中每个访问的数组都在该访问写入前注册，
+        // 注册时的解锁先于此处的加锁，因此variableCount覆盖本批次的所有编号
+        std::vector<uint64_t> ends;
+        for (ThreadRing *ring : snapshot) {
+            ends.push_back(ring->head.load(std::memory_order_acquire));
+        }
+        size_t variableCount;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            variableCount = variables.size();
+            for (size_t id = stats.size(); id < variableCount; id++) {
+                stats.push_back(VariableStats());
+                stats[id].info = variables[id];
+            }
+        }
+        size_t drained = 0;
+        for (size_t r = 0; r < snapshot.size(); r++) {
+            ThreadRing *ring = snapshot[r];
+            uint64_t begin = ring->tail.load(std::memory_order_relaxed);
+            uint64_t end = ends[r];
+            if (begin == end) {
+                continue;
+            }
+            if (ring->sequences.size() < variableCount) {
+                ring->sequences.resize(variableCount);
+                ring->pending.resize(variableCount);
+            }
+            for (uint64_t position = begin; position < end; position++) {
+                const Entry &entry = ring->entries[position & (ThreadRing::CAPACITY - 1)];
+                consume(*ring, static_cast<uint32_t>(entry.variable), entry.address);
+            }
+            ring->tail.store(end, std::memory_order_release);
+            drained += end - begin;
+        }
+        return drained;
+    }
+
+    void consume(ThreadRing &ring, uint32_t id, uint64_t address)
+    {
+        if (binary) {
+            std::vector<uint64_t> &block = ring.pending[id];
+            block.push_back(address);
+            if (block.size() >= TRACE_BLOCK_ADDRESSES) {
+                writeBlock(ring, id);
+            }
+            return;
+        }
+        VariableStats &variable = stats[id];
+        bool hasStride, newBatch;
+        int64_t stride;
+        if (ring.sequences[id].next(sampling, address, variable.info.elementSize, hasStride, stride, newBatch)) {
+            if (hasStride) {
+                variable.strides.add(stride);
+            }
+            variable.accesses++;
+        }
+    }
+
+    void writeVariable(uint32_t id)
+    {
+        VariableStats &variable = stats[id];
+        TraceVariableRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.tag = TRACE_VARIABLE;
+        record.id = id;
+        record.size = variable.info.size;
+        record.elementSize = variable.info.elementSize;
+        record.kernelLength = static_cast<uint16_t>(std::min<size_t>(variable.info.kernel.size(), 0xFFFF));
+        record.nameLength = static_cast<uint16_t>(std::min<size_t>(variable.info.name.size(), 0xFFFF));
+        std::fwrite(&record, sizeof(record), 1, traceFile);
+        std::fwrite(variable.info.kernel.data(), 1, record.kernelLength, traceFile);
+        std::fwrite(variable.info.name.data(), 1, record.nameLength, traceFile);
+        variable.written = true;
+    }
+
+    void writeBlock(ThreadRing &ring, uint32_t id)
+    {
+        std::vector<uint64_t> &block = ring.pending[id];
+        if (traceFile != nullptr && !block.empty()) {
+            if (!stats[id].written) {
+                writeVariable(id);
+            }
+            TraceBlockRecord record;
+            record.tag = TRACE_BLOCK;
+            record.variable = id;
+            record.thread = ring.thread;
+            record.count = static_cast<uint32_t>(block.size());
+            std::fwrite(&record, sizeof(record), 1, traceFile);
+            std::fwrite(block.data(), sizeof(uint64_t), block.size(), traceFile);
+        }
+        block.clear();
+    }
+
+    void writeOutput()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t id = 0; id < variables.size(); id++) {
+            stats[id].info = variables[id];
+        }
+        if (binary) {
+            if (traceFile == nullptr) {
+                return;
+            }
+            for (auto &ring : rings) {
+                for (uint32_t id = 0; id < ring->pending.size(); id++) {
+                    writeBlock(*ring, id);
+                }
+            }
+            // 重新写出全部变量定义，记录最终的数组大小
+            for (uint32_t id = 0; id < stats.size(); id++) {
+                writeVariable(id);
+            }
+            std::fclose(traceFile);
+            traceFile = nullptr;
+            return;
+        }
+        if (stats.empty()) {
+            return;
+        }
+
+        FILE *file = std::fopen(outputPath.c_str(), "w");
+        if (file == nullptr) {
+            std::fprintf(stderr, "masamt-trace: cannot open %s\n", outputPath.c_str());
+            return;
+        }
+        std::fprintf(file, "Variable,Function,Size,Access");
+        for (size_t i = 1; i <= MAX_STRIDES; i++) {
+            std::fprintf(file, ",Stride%zu,Pct%zu", i, i);
+        }
+        std::fprintf(file, "\n");
+        for (const auto &variable : stats) {
+            std::fprintf(file, "%s,%s,%llu,%llu", variable.info.name.c_str(), variable.info.kernel.c_str(),
+                         static_cast<unsigned long long>(variable.info.size),
+                         static_cast<unsigned long long>(variable.accesses * sampling.getScale() + 0.5));
+            for (const auto &stride : variable.strides.top(MAX_STRIDES)) {
+                std::fprintf(file, ",%lld,%.2f", static_cast<long long>(stride.first), stride.second);
+            }
+            std::fprintf(file, "\n");
+        }
+        std::fclose(file);
+    }
+};
+
+// 在作用域内设置当前线程的内核名，之后注册的数组归属该内核
+class KernelScope
+{
+public:
+    explicit KernelScope(const std::string &kernel) : previous(Tracer::currentKernel())
+    {
+        Tracer::currentKernel() = kernel;
+    }
+    ~KernelScope() { Tracer::currentKernel() = previous; }
+    KernelScope(const KernelScope &) = delete;
+    KernelScope &operator=(const KernelScope &) = delete;
+
+private:
+    std::string previous;
+};
+
+// 已注册数组的句柄
+class TracedArray
+{
+public:
+    TracedArray(const char *name, uint64_t size, uint32_t elementSize)
+        : tracer(Tracer::instance()), id(tracer.registerArray(name, size, elementSize))
+    {
+    }
+    void access(const void *address) const { tracer.record(id, address); }
+
+private:
+    Tracer &tracer;
+    uint32_t id;
+};
+
+} // namespace MasamtTrace
+
+#ifdef MASAMT_TRACE_DISABLE
+#define MASAMT_TRACE_KERNEL(name) ((void)0)
+#define MASAMT_TRACE_ARRAY(var, base, bytes) ((void)0)
+#define MASAMT_TRACE_ACCESS(var, address) ((void)0)
+#define MASAMT_TRACE_FLUSH() ((void)0)
+#else
+#define MASAMT_TRACE_CONCAT_(a, b) a##b
+#define MASAMT_TRACE_CONCAT(a, b) MASAMT_TRACE_CONCAT_(a, b)
+// 标记内核（RAII，作用域结束时恢复）
+#define MASAMT_TRACE_KERNEL(name) MasamtTrace::KernelScope MASAMT_TRACE_CONCAT(masamtTraceKernel, __LINE__)(name)
+// 注册数组：var为句柄名（也是输出中的变量名），base为首元素指针，bytes为数组字节数
+#define MASAMT_TRACE_ARRAY(var, base, bytes)                                                                    \
+    MasamtTrace::TracedArray MASAMT_TRACE_CONCAT(masamtTraceArray_, var)(#var, (bytes), sizeof(*(base)))
+// 记录一次访问
+#define MASAMT_TRACE_ACCESS(var, address) MASAMT_TRACE_CONCAT(masamtTraceArray_, var).access(address)
+// 立即写出结果（否则在进程退出时写出）
+#define MASAMT_TRACE_FLUSH() MasamtTrace::Tracer::instance().stop()
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// 分配统计的阶段，按线程记录当前所处的阶段
+enum MemoryPhase
+{
+    PHASE_OTHER,
+    PHASE_PARSE,
+    PHASE_GROUP,
+    PHASE_DEDUCE,
+    PHASE_WRITE,
+    PHASE_COUNT
+};
+
+/**
+ * @brief 内存与分配统计（make instrument构建，定义MASAMT_INSTRUMENT时启用）
+ *
+ * 替换全局operator new/delete，按当前线程所处阶段累计分配次数与字节数，并记录堆上存活字节的峰值。
+ * 内存池内的分配不经过operator new，由MonotonicArena::allocate另行按阶段计数。
+ * 进程退出时按输入行数（解析出的变量数）归一化，文本报告写到stderr，
+ * JSON写到环境变量MASAMT_INSTRUMENT_OUTPUT指定的文件（默认masamt_instrument.json），同时给出峰值RSS。
+ * 普通构建中所有接口均为空操作，不替换operator new/delete。
+ */
+class MemoryInstrument
+{
+public:
+    class PhaseStats
+    {
+    public:
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        // 内存池内的分配次数与字节数，内存池的块本身计入allocations/bytes
+        uint64_t arenaAllocations = 0;
+        uint64_t arenaBytes = 0;
+    };
+
+    // 作用域内把当前线程的阶段设为指定阶段，退出时恢复，可嵌套
+    class PhaseScope
+    {
+    public:
+#ifdef MASAMT_INSTRUMENT
+        explicit PhaseScope(MemoryPhase phase);
+        ~PhaseScope();
+
+    private:
+        MemoryPhase previous;
+#else
+        explicit PhaseScope(MemoryPhase) {}
+#endif
+    };
+
+#ifdef MASAMT_INSTRUMENT
+    static bool isEnabled() { return true; }
+    // 累计解析出的输入行数
+    static void addRows(uint64_t rows);
+    // 累计当前阶段的一次内存池分配
+    static void addArenaAllocation(uint64_t bytes);
+#else
+    static bool isEnabled() { return false; }
+    static void addRows(uint64_t) {}
+    static void addArenaAllocation(uint64_t) {}
+#endif
+
+    static const char *getPhaseName(MemoryPhase phase);
+    static PhaseStats getPhaseStats(MemoryPhase phase);
+    static uint64_t getRows();
+    static uint64_t getPeakHeapBytes();
+    // 进程的峰值常驻内存（字节），无法获取时为0
+    static uint64_t getPeakRSS();
+
+    static void printReport(std::ostream &os);
+    static void writeJSON(std::ostream &os);
+};
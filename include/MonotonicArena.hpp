@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+/**
+ * @brief 单调递增的内存池
+ *
+ * 分配只移动块内偏移，单个释放为空操作，reset()一次性回收全部内存。
+ * 用于单个输入文件的分析过程：文件的OperatorInfo、FunctionInfo、推断过程中的临时向量
+ * 等随文件一起创建和销毁，处理完文件后整体回收。非线程安全，每个线程或每个文件使用独立的实例。
+ */
+class MonotonicArena
+{
+public:
+    explicit MonotonicArena(size_t blockSize = 64 * 1024);
+    ~MonotonicArena();
+    MonotonicArena(const MonotonicArena &) = delete;
+    MonotonicArena &operator=(const MonotonicArena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment);
+    /**
+     * @brief 回收全部分配
+     *
+     * 只保留一个内存块供下次复用；若本轮使用了多个块，则保留的块扩大为本轮用量，
+     * 使规模相近的下一个文件只需一个块
+     */
+    void reset();
+
+    // 分配位置标记，用于回退到此前的状态
+    class Marker
+    {
+    public:
+        size_t blockIndex = 0;
+        size_t offset = 0;
+        size_t bytesUsed = 0;
+    };
+    Marker mark() const;
+    // 回退到标记位置，标记之后的分配全部失效；标记之后新增的内存块被释放
+    void rewind(const Marker &marker);
+
+    // 当前已分配的字节数
+    size_t getBytesUsed() const { return bytesUsed; }
+    // 自创建以来单轮的最大分配字节数
+    size_t getPeakBytesUsed() const { return peakBytesUsed; }
+    size_t getBlockCount() const { return blocks.size(); }
+
+    // 当前线程正在使用的内存池，为空表示使用普通堆
+    static MonotonicArena *current();
+    // 当前线程专属的内存池
+    static MonotonicArena &threadArena();
+
+private:
+    friend class ArenaScope;
+
+    class Block
+    {
+    public:
+        char *data;
+        size_t size;
+    };
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t offset = 0;
+    size_t bytesUsed = 0;
+    size_t peakBytesUsed = 0;
+
+    void addBlock(size_t minSize);
+    static MonotonicArena *&currentSlot();
+};
+
+// 在作用域内把指定内存池设为当前线程的内存池，退出时恢复之前的设置，并可选择回收内存池
+class ArenaScope
+{
+public:
+    explicit ArenaScope(MonotonicArena &arena, bool resetOnExit = false);
+    ~ArenaScope();
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    MonotonicArena &arena;
+    MonotonicArena *previous;
+    bool resetOnExit;
+};
+
+// 在作用域内记录当前线程内存池的位置，退出时回退，用于回收文件内逐个函数的临时分配
+class ArenaCheckpoint
+{
+public:
+    ArenaCheckpoint();
+    ~ArenaCheckpoint();
+    ArenaCheckpoint(const ArenaCheckpoint &) = delete;
+    ArenaCheckpoint &operator=(const ArenaCheckpoint &) = delete;
+
+private:
+    MonotonicArena *arena;
+    MonotonicArena::Marker marker;
+};
+
+/**
+ * @brief 内存池分配器
+ *
+ * 构造时绑定当前线程的内存池，没有内存池时退化为普通堆分配。
+ * 容器复制时绑定复制发生时的内存池，移动和交换时分配器随数据一起转移。
+ */
+template <typename T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() : arena(MonotonicArena::current()) {}
+    explicit ArenaAllocator(MonotonicArena *arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.getArena())
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        if (arena == nullptr) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *p, size_t)
+    {
+        if (arena == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+    MonotonicArena *getArena() const { return arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return arena == other.getArena();
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return arena != other.getArena();
+    }
+
+private:
+    MonotonicArena *arena;
+};
+
+// 使用内存池分配器的向量
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -1,39 +1,59 @@
 #pragma once
 
+#include "MonotonicArena.hpp"
+#include "ReuseDistance.hpp"
+#include "SmallVector.hpp"
+#include "StringTable.hpp"
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #define SM_SPACE_SIZE 60 * 1024
 
+// 访存模式 <步长, 占比>，通常只有1~4个步长，不超过4个时不单独分配内存
+typedef SmallVector<std::pair<int, double>, 4, ArenaAllocator<std::pair<int, double>>> AccessPatterns;
+
 class VariableInfo
 {
 public:
     VariableInfo() {};
-    VariableInfo(const std::string &name, const unsigned long long size, const unsigned long long access,
-                 const std::vector<std::pair<int, double>> &patterns);
-    std::string name;
+    VariableInfo(const InternedName &name, const unsigned long long size, const unsigned long long access,
+                 const AccessPatterns &patterns);
+    InternedName name;
     unsigned long long size;
     unsigned long long access;
-    std::vector<std::pair<int, double>> patterns;
+    AccessPatterns patterns;
+    // 重用距离直方图，只有从跟踪中读取的变量才有
+    std::shared_ptr<const ReuseHistogram> reuse;
 };
 
+// 在当前线程的内存池（若有）中分配的变量列表
+typedef ArenaVector<VariableInfo> VariableList;
+
 class FunctionInfo
 {
 public:
     FunctionInfo() {};
-    FunctionInfo(const std::string &name, const std::vector<VariableInfo> &variables);
-    std::string name;
-    std::vector<VariableInfo> variables;
+    FunctionInfo(const InternedName &name, const std::vector<VariableInfo> &variables);
+    FunctionInfo(const InternedName &name, VariableList &&variables);
+    InternedName name;
+    VariableList variables;
 };
 
+typedef ArenaVector<FunctionInfo> FunctionList;
+
 class OperatorInfo
 {
 public:
     OperatorInfo() {};
     OperatorInfo(const std::string &name, const std::vector<FunctionInfo> &functions);
     std::string name;
-    std::vector<FunctionInfo> functions;
+    FunctionList functions;
+    // 函数名和变量名的驻留表，算子的所有副本共享同一张表，名称引用在表销毁前有效
+    std::shared_ptr<StringTable> names;
 
     void getOperatorInfoFromCSV(const std::string &opName, const std::string &csvPath);
+    // 从已读入内存的CSV内容解析算子信息
+    void getOperatorInfoFromBuffer(const std::string &opName, const std::string &content);
     void printInfo() const;
 };
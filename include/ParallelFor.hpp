@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 在线程池上执行count个独立任务
+ *
+ * 线程通过原子计数领取任务编号，调用线程也参与执行。
+ *
+ * @param count 任务个数
+ * @param threadCount 线程数上限，0表示使用硬件并发数
+ * @param function 以任务编号为参数的任务函数
+ */
+template <typename Function> void parallelFor(size_t count, unsigned int threadCount, Function function)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t task = next++; task < count; task = next++) {
+            function(task);
+        }
+    };
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, std::max<size_t>(1, count)));
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < threadCount; t++) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "OperatorInfo.hpp"
+#include <string>
+#include <vector>
+
+// 参数扫描：在C_total与策略决断常量的网格上并行评估所有函数，并输出帕累托前沿
+class ParameterSweep
+{
+public:
+    // 参与扫描的已解析算子
+    class SweepInput
+    {
+    public:
+        // 输出标签，如 STANDARD/adi
+        std::string label;
+        OperatorInfo op;
+    };
+
+    // 网格点上单个函数的评估结果
+    class SweepResult
+    {
+    public:
+        size_t inputIndex = 0;
+        size_t functionIndex = 0;
+        int C_total = 0;
+        double factor = 0.0;
+        // 各策略实际占用的SM空间之和（字节）
+        long long smUsage = 0;
+        // 所选策略的估算周期之和
+        double transferCost = 0.0;
+        // 各策略的变量个数，按AccessStrategy索引
+        int strategyCount[UNSUITABLE + 1] = {0, 0, 0, 0};
+        bool paretoOptimal = false;
+    };
+
+    std::vector<int> cTotals;
+    std::vector<double> factors;
+    // 并行线程数，0表示使用硬件并发数
+    unsigned int jobs = 0;
+
+    /**
+     * @brief 解析C_total扫描范围
+     *
+     * 格式为 MIN:MAX，可带K后缀（1K=1024字节），从MIN开始按2的幂递增，最后补上MAX
+     *
+     * @return false 格式错误
+     */
+    bool parseCTotalRange(const std::string &spec);
+    /**
+     * @brief 解析策略决断常量扫描范围
+     *
+     * 格式为 MIN:MAX:STEP，单个数值表示只取该值
+     *
+     * @return false 格式错误
+     */
+    bool parseFactorRange(const std::string &spec);
+
+    // 在全部网格点上评估所有函数，结果按输入、函数、C_total、常量排序
+    std::vector<SweepResult> run(const std::vector<SweepInput> &inputs) const;
+    // 打印结果表和每个函数的帕累托前沿（SM占用 vs 估算传输代价）
+    static void printReport(const std::vector<SweepInput> &inputs, const std::vector<SweepResult> &results);
+
+private:
+    static SweepResult evaluate(const FunctionInfo &func, int C_total, double factor);
+    static void markParetoFront(std::vector<SweepResult> &results);
+};
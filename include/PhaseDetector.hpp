@@ -0,0 +1,99 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "TraceReader.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 一个阶段（或整个内核）中单个变量的推断结果
+class PhaseAssignment
+{
+public:
+    std::string name;
+    AccessStrategyConfig config = AccessStrategyConfig(UNSUITABLE);
+    // 所选策略的估算周期
+    double cycles = 0.0;
+};
+
+// 内核访问序列中的一个阶段
+class TracePhase
+{
+public:
+    // 阶段在内核访问序列中的位置（访问序号，左闭右开）及所含窗口数
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    size_t windows = 0;
+    // 阶段内被访问的变量及其访问次数与步长直方图
+    std::vector<TraceVariable> variables;
+
+    // 以下由evaluate填写：阶段单独推断的结果及其估算周期之和
+    std::vector<PhaseAssignment> assignments;
+    double cycles = 0.0;
+    // 进入下一阶段时写回配置改变的变量所需的周期
+    double reconfigureCycles = 0.0;
+};
+
+// 单个内核的阶段划分及重配置收益
+class KernelPhases
+{
+public:
+    std::string kernel;
+    uint64_t windowAccesses = 0;
+    size_t windows = 0;
+    std::vector<TracePhase> phases;
+
+    // 以下由evaluate填写：整个内核使用单一配置的推断结果与估算周期，分阶段配置的估算周期（含重配置）
+    std::vector<PhaseAssignment> single;
+    double singleCycles = 0.0;
+    double phasedCycles = 0.0;
+
+    // 分阶段配置相对单一配置节省的周期比例
+    double getSaving() const;
+    // 节省比例是否达到PhaseDetector::RECONFIGURE_MARGIN
+    bool isReconfigurationWorthwhile() const;
+};
+
+/**
+ * @brief 跟踪驱动的阶段检测
+ *
+ * 按文件中地址块的顺序把每个内核的访问序列切成等长窗口，窗口签名为各变量每个主要步长（及其余步长）的访问次数
+ * 与访问到的不同缓存行数，均除以窗口访问次数。在签名序列上做二分分段：每次选取使段内平方误差下降最多的切点，
+ * 两侧签名均值的L1距离不小于PHASE_DISTANCE且两侧都不少于MIN_PHASE_WINDOWS个窗口时接受，直到MAX_PHASES个阶段。
+ *
+ * 每个阶段单独推断（不访问或极少访问的变量不占用SM），推断结果相同的相邻阶段合并，再与整个内核的单一配置比较估算周期。
+ * 相邻阶段间配置改变的变量按写回其SM占用计入重配置开销；新配置的载入已包含在下一阶段的强制缺失中，
+ * 配置不变的变量同样计入了强制缺失，因此分阶段的估算偏保守。两边都不含时间局部性，以便直接比较。
+ * 只支持未抽样的原始跟踪（.mtrace）：分块压缩跟踪按块重排，抽样跟踪不是完整的访问序列。
+ */
+class PhaseDetector
+{
+public:
+    // 每个内核最多的窗口数
+    static const size_t MAX_WINDOWS = 512;
+    static const size_t MIN_PHASE_WINDOWS = 4;
+    static const size_t MAX_PHASES = 8;
+    // 统计不同缓存行数的粒度（字节）
+    static const uint64_t FOOTPRINT_LINE_BYTES = 64;
+    // 接受切点所需的签名均值L1距离
+    constexpr static double PHASE_DISTANCE = 0.2;
+    // 访问次数占阶段访问不足该比例的变量（多为边界窗口中的残留访问）在该阶段留在DDR中
+    constexpr static double MIN_PHASE_SHARE = 0.05;
+    // 建议重配置所需的最低节省比例
+    constexpr static double RECONFIGURE_MARGIN = 0.05;
+
+    // 解析跟踪时是否检测阶段（--phases）
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief 检测原始跟踪中各内核的阶段
+     *
+     * @param kernels 按内核名排序的检测结果（输出参数）
+     * @return false 不是未抽样的原始跟踪或格式错误
+     */
+    static bool detect(const std::string &content, std::vector<KernelPhases> &kernels);
+    // 对每个阶段及整个内核推断策略并估算周期
+    static void evaluate(std::vector<KernelPhases> &kernels);
+    static void printReport(const std::vector<KernelPhases> &kernels, std::ostream &os);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 比较两次分析的结果文件：按(算子, 数据集, 函数, 变量)做哈希连接，输出策略变化、参数变化与SM占用变化
+class ResultDiff
+{
+public:
+    // 一条结果记录，key由各名称以'\x1f'连接而成
+    class ResultRow
+    {
+    public:
+        std::string key;
+        uint64_t hash = 0;
+        AccessStrategy accessStrategy = UNSUITABLE;
+        int set = 0;
+        int line = 0;
+        long long smUsage = 0;
+        AccessStrategyConfig getConfig() const { return AccessStrategyConfig(accessStrategy, set, line); }
+    };
+
+    // 一侧的全部结果，按文件顺序排列
+    class ResultSet
+    {
+    public:
+        std::string path;
+        std::vector<ResultRow> rows;
+        size_t fileCount = 0;
+        // 格式错误而跳过的行
+        size_t skippedRows = 0;
+        // 二进制记录中名称被截断而跳过的行
+        size_t truncatedRows = 0;
+    };
+
+    // 单个变量的变化，before为空表示新增，after为空表示删除
+    class RowChange
+    {
+    public:
+        const ResultRow *before = nullptr;
+        const ResultRow *after = nullptr;
+        long long getSMDelta() const
+        {
+            return (after ? after->smUsage : 0) - (before ? before->smUsage : 0);
+        }
+    };
+
+    class DiffSummary
+    {
+    public:
+        size_t rowsA = 0;
+        size_t rowsB = 0;
+        // 同一侧重复出现的变量，以最后一条为准
+        size_t duplicatesA = 0;
+        size_t duplicatesB = 0;
+        size_t matched = 0;
+        size_t unchanged = 0;
+        size_t strategyChanged = 0;
+        size_t parameterChanged = 0;
+        size_t added = 0;
+        size_t removed = 0;
+        long long smUsageA = 0;
+        long long smUsageB = 0;
+        // 匹配变量的策略转移计数，[A策略][B策略]
+        size_t transitions[UNSUITABLE + 1][UNSUITABLE + 1] = {};
+        void merge(const DiffSummary &other);
+    };
+
+    // 并行线程数，0表示使用硬件并发数
+    unsigned int jobs = 0;
+    // 终端输出的变化明细条数上限
+    size_t detailLimit = 100;
+
+    /**
+     * @brief 加载结果文件或结果目录
+     *
+     * 支持CSV（传统或通用列格式）与二进制结果文件（.bin）。目录下同名的.bin优先于.csv；
+     * 加载目录时文件名（算子名）作为连接键的一部分，加载单个文件时不使用文件名。
+     * 大文件按行（记录）边界切块并行解析。
+     *
+     * @return false 路径不存在或没有可识别的结果文件
+     */
+    bool load(const std::string &path, ResultSet &resultSet) const;
+
+    /**
+     * @brief 连接两侧结果并统计变化
+     *
+     * @param changes 策略或参数变化、新增、删除的变量（输出参数），指针指向a、b中的行
+     */
+    DiffSummary compare(const ResultSet &a, const ResultSet &b, std::vector<RowChange> &changes) const;
+
+    void printReport(const ResultSet &a, const ResultSet &b, const DiffSummary &summary,
+                     std::vector<RowChange> &changes) const;
+
+    // 按策略名（如CACHE_DIRECT）解析策略，无法识别时返回false
+    static bool parseStrategyName(const char *begin, const char *end, AccessStrategy &accessStrategy);
+    // 将连接键格式化为 op/dataset/function/variable，省略空的部分
+    static std::string formatKey(const std::string &key);
+
+private:
+    unsigned int getThreadCount() const;
+};
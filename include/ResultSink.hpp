@@ -0,0 +1,210 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "CacheCodeGenerator.hpp"
+#include "ResultStore.hpp"
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 单条推断结果所属的算子、数据集与函数，dataset为空表示通用格式输入
+class ResultContext
+{
+public:
+    std::string opName;
+    std::string dataset;
+    std::string funcName;
+    ResultContext() {};
+    ResultContext(const std::string &opName, const std::string &dataset, const std::string &funcName)
+        : opName(opName), dataset(dataset), funcName(funcName) {};
+};
+
+class ResultSink;
+typedef std::vector<std::unique_ptr<ResultSink>> ResultSinkList;
+
+// 推断结果输出目标，每个变量的特征向量写入一条记录
+class ResultSink
+{
+public:
+    virtual ~ResultSink() {};
+    virtual std::string getName() const = 0;
+    virtual void write(const ResultContext &context, const AccessFeatureVector &featureVector) = 0;
+    // 将缓冲数据写入文件
+    virtual void flush() {};
+
+    /**
+     * @brief 按逗号分隔的格式列表创建输出目标
+     *
+     * @param formats 格式列表，如"csv,jsonl,bin"
+     * @param sinks 创建的输出目标（输出参数）
+     * @return false 存在无效格式名
+     */
+    static bool createSinks(const std::string &formats, ResultSinkList &sinks);
+    // 按名称创建输出目标，名称无效时返回空指针
+    static std::unique_ptr<ResultSink> create(const std::string &name);
+    // 可用格式名称
+    static std::vector<std::string> getFormatNames();
+};
+
+// 原有的UTF-8 CSV输出：results/<op>.csv
+class CSVResultSink : public ResultSink
+{
+public:
+    std::string getName() const override { return "csv"; }
+    void write(const ResultContext &context, const AccessFeatureVector &featureVector) override;
+};
+
+// 按算子保持打开的结果文件，追加写入results/<op>.<ext>
+class ResultFileSet
+{
+public:
+    explicit ResultFileSet(const std::string &extension) : extension(extension) {};
+    std::string getPath(const std::string &opName) const { return "results/" + opName + "." + extension; }
+    // 获取算子对应的文件，首次访问时由open打开
+    std::ofstream *find(const std::string &opName);
+    std::ofstream &open(const std::string &opName, std::ios::openmode mode);
+    void flush();
+
+private:
+    std::string extension;
+    std::map<std::string, std::unique_ptr<std::ofstream>> files;
+};
+
+// 换行分隔的JSON输出：results/<op>.jsonl，每行一个变量
+class JSONLResultSink : public ResultSink
+{
+public:
+    JSONLResultSink() : files("jsonl") {};
+    std::string getName() const override { return "jsonl"; }
+    void write(const ResultContext &context, const AccessFeatureVector &featureVector) override;
+    void flush() override { files.flush(); }
+
+private:
+    ResultFileSet files;
+    std::string line;
+};
+
+// 二进制结果文件的字段类型
+enum BinaryFieldType : uint32_t
+{
+    FIELD_CHAR = 1,
+    FIELD_INT32 = 2,
+    FIELD_UINT32 = 3,
+    FIELD_UINT64 = 4,
+    FIELD_DOUBLE = 5
+};
+
+// 二进制结果文件头，其后紧跟fieldCount个字段描述，记录从headerSize处开始
+struct BinaryResultHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    uint32_t fieldCount;
+};
+
+// 字段描述：字段名、类型、记录内偏移与元素个数
+struct BinaryFieldDescriptor
+{
+    char name[24];
+    uint32_t type;
+    uint32_t offset;
+    uint32_t count;
+};
+
+/**
+ * @brief 定长二进制结果记录
+ *
+ * 所有字段自然对齐，文件可直接mmap后按记录数组访问，记录数为(文件大小 - headerSize) / recordSize。
+ * 名称字段以'\0'填充，超长时截断并在flags中置FLAG_NAME_TRUNCATED；不可行策略的代价为+inf；
+ * patternCount为原始访存模式个数，仅前MAX_PATTERNS个写入patternStrides/patternRatios。
+ */
+struct BinaryResultRecord
+{
+    static const int NAME_LENGTH = 48;
+    static const int DATASET_LENGTH = 16;
+    static const int MAX_PATTERNS = 4;
+    static const uint32_t FLAG_NAME_TRUNCATED = 1;
+
+    char dataset[DATASET_LENGTH];
+    char function[NAME_LENGTH];
+    char variable[NAME_LENGTH];
+    uint64_t size;
+    uint64_t accessCount;
+    double density;
+    double locality;
+    int32_t reservedSpace;
+    int32_t strategy;
+    int32_t line;
+    int32_t set;
+    int32_t bufferCount;
+    int32_t bufferSize;
+    double stallReduction;
+    int32_t prefetchDistance;
+    int32_t prefetchChunk;
+    double costs[UNSUITABLE];
+    uint32_t patternCount;
+    int32_t patternStrides[MAX_PATTERNS];
+    uint32_t flags;
+    // 变量所在的片上存储，取值为TargetMemory
+    int32_t memory;
+    uint32_t reserved;
+    double patternRatios[MAX_PATTERNS];
+};
+static_assert(sizeof(BinaryResultRecord) == 272, "BinaryResultRecord layout changed, bump BinaryResultSink::VERSION");
+
+// 定长二进制输出：results/<op>.bin，带字段描述的文件头
+class BinaryResultSink : public ResultSink
+{
+public:
+    static const uint32_t VERSION = 4;
+
+    BinaryResultSink() : files("bin") {};
+    std::string getName() const override { return "bin"; }
+    void write(const ResultContext &context, const AccessFeatureVector &featureVector) override;
+    void flush() override { files.flush(); }
+
+    // 本版本的字段描述
+    static std::vector<BinaryFieldDescriptor> getSchema();
+    // 文件头长度（含字段描述），按8字节对齐
+    static uint32_t getHeaderSize();
+
+private:
+    ResultFileSet files;
+
+    // 打开算子的结果文件，已有文件的头部与当前版本不一致时重写
+    std::ofstream &openFile(const std::string &opName);
+    static void fillRecord(const ResultContext &context, const AccessFeatureVector &featureVector,
+                           BinaryResultRecord &record);
+};
+
+// 带索引的结果库：按(算子, 数据集, 函数, 变量)更新，flush时合并写入
+class StoreResultSink : public ResultSink
+{
+public:
+    std::string getName() const override { return "store"; }
+    void write(const ResultContext &context, const AccessFeatureVector &featureVector) override;
+    void flush() override;
+
+private:
+    ResultStore::EntryList pending;
+};
+
+// 缓存配置代码：每个函数一个头文件 results/codegen/<op>[_<dataset>]_<function>.h
+class HeaderResultSink : public ResultSink
+{
+public:
+    std::string getName() const override { return "header"; }
+    void write(const ResultContext &context, const AccessFeatureVector &featureVector) override;
+    void flush() override;
+
+private:
+    CacheCodeGenerator generator;
+    // 当前函数已收到的变量，函数切换或flush时生成头文件
+    ResultContext current;
+    std::vector<CacheVariable> variables;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 索引结果库文件头，记录区、哈希槽区、字符串区依次存放，偏移均相对文件起始
+struct StoreHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordCount;
+    uint64_t slotCount;
+    uint64_t recordsOffset;
+    uint64_t slotsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+// 结果库中的一条记录，按键升序存放；键为 算子\x1f数据集\x1f函数\x1f变量，保存在字符串区
+struct StoreRecord
+{
+    uint64_t hash;
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    int32_t strategy;
+    int32_t set;
+    int32_t line;
+    int32_t reservedSpace;
+    uint64_t size;
+    uint64_t accessCount;
+    double density;
+    double locality;
+    int32_t bufferCount;
+    int32_t bufferSize;
+    double stallReduction;
+    int32_t prefetchDistance;
+    int32_t prefetchChunk;
+    // 变量所在的片上存储，取值为TargetMemory
+    int32_t memory;
+    int32_t reserved;
+    double costs[UNSUITABLE];
+};
+static_assert(sizeof(StoreRecord) == 120, "StoreRecord layout changed, bump ResultStore::VERSION");
+
+/**
+ * @brief 带索引的推断结果库
+ *
+ * 单个文件内保存按键排序的定长记录表与开放寻址哈希索引，只读打开时直接mmap。
+ * 精确查询走哈希索引，前缀与通配查询在排序表上二分定位后顺序扫描。
+ * 更新时与已有记录按键合并（同键覆盖），整体写入临时文件后替换原文件。
+ */
+class ResultStore
+{
+public:
+    static const uint32_t VERSION = 3;
+    static const char KEY_SEPARATOR = '\x1f';
+
+    ResultStore() {};
+    ~ResultStore() { close(); }
+    ResultStore(const ResultStore &) = delete;
+    ResultStore &operator=(const ResultStore &) = delete;
+
+    // 只读打开结果库，文件不存在或格式不符时返回false
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+    size_t size() const { return isOpen() ? static_cast<size_t>(header().recordCount) : 0; }
+
+    const StoreRecord &getRecord(size_t index) const { return records()[index]; }
+    std::string getKey(const StoreRecord &record) const { return std::string(strings() + record.keyOffset, record.keyLength); }
+    // 精确查找，不存在时返回空指针
+    const StoreRecord *find(const std::string &key) const;
+
+    /**
+     * @brief 按模式查询
+     *
+     * 模式为 op/dataset/function/variable，"*"匹配任意值，缺省的尾部部分视为"*"；
+     * 通用格式输入的数据集为空，如 bench//f/x。四部分均给出时走哈希索引。
+     *
+     * @param visitor 每条匹配记录的回调
+     * @return 匹配条数
+     */
+    size_t query(const std::string &pattern, const std::function<void(const StoreRecord &)> &visitor) const;
+
+    typedef std::vector<std::pair<std::string, StoreRecord>> EntryList;
+    // 将已有记录与新记录合并后写入path（新记录覆盖同键的已有记录，entries内同键以最后一条为准）
+    static bool upsert(const std::string &path, EntryList &entries);
+    static std::string makeKey(const std::string &opName, const std::string &dataset, const std::string &funcName,
+                               const std::string &varName);
+    static StoreRecord makeRecord(const AccessFeatureVector &featureVector);
+    // 默认结果库路径，--format=store写出与--query查询共用
+    static const std::string &getDefaultPath();
+    static void setDefaultPath(const std::string &path);
+    // 输出一条记录：op/dataset/function/variable: 策略与参数
+    void printRecord(const StoreRecord &record) const;
+
+private:
+    const char *data = nullptr;
+    size_t length = 0;
+    // 不支持mmap的平台读入内存
+    std::string buffer;
+
+    const StoreHeader &header() const { return *reinterpret_cast<const StoreHeader *>(data); }
+    const StoreRecord *records() const { return reinterpret_cast<const StoreRecord *>(data + header().recordsOffset); }
+    const uint32_t *slots() const { return reinterpret_cast<const uint32_t *>(data + header().slotsOffset); }
+    const char *strings() const { return data + header().stringsOffset; }
+    bool validate() const;
+};
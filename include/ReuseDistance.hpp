@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 重用距离直方图
+ *
+ * 重用距离为同一地址两次访问之间访问过的不同地址数（栈距离），按log2分桶：
+ * 第0桶为距离0，第b桶为距离在[2^(b-1), 2^b)之间；首次访问单独计为冷访问。
+ */
+class ReuseHistogram
+{
+public:
+    static const int BUCKETS = 48;
+
+    uint64_t counts[BUCKETS] = {};
+    uint64_t coldAccesses = 0;
+    // 元素长度（字节），用于把距离换算为数据量
+    uint32_t elementSize = 1;
+
+    void add(uint64_t distance, uint64_t count = 1) { counts[getBucket(distance)] += count; }
+    void merge(const ReuseHistogram &other);
+    uint64_t getTotal() const;
+
+    // 容量为bytes的全相联LRU缓存的命中率，跨越容量的桶按距离线性插值
+    double getHitRatio(double bytes) const;
+    /**
+     * @brief 时间局部性 T = Σ q_b·e^(−d_b·elementSize / referenceBytes)
+     *
+     * q_b为第b桶占全部访问的比例，d_b为桶内距离的代表值；冷访问不计入。
+     * 与空间局部性L的形式一致：重用距离远小于参考容量的访问贡献接近1，超出参考容量的贡献迅速衰减。
+     */
+    double getTemporalLocality(double referenceBytes) const;
+    // 输出非空的桶：距离上界（换算为字节）与占比
+    void print(std::ostream &os) const;
+
+    static int getBucket(uint64_t distance);
+    // 桶内距离的代表值
+    static double getBucketDistance(int bucket);
+};
+
+/**
+ * @brief 基于树状数组的栈距离计算，O(n log n)
+ *
+ * 每个地址在其最近一次访问的时间戳上记1，两次访问间的不同地址数即区间和。
+ * 时间戳用尽时按最近访问顺序重新编号，树的大小只与不同地址数成正比。
+ * sampleRate大于1时为近似模式：只统计地址哈希值模sampleRate为0的地址，距离按比例放大（空间哈希抽样）。
+ */
+class ReuseDistanceAnalyzer
+{
+public:
+    explicit ReuseDistanceAnalyzer(uint64_t sampleRate = 1) : sampleRate(sampleRate) {}
+
+    void access(uint64_t address);
+    const ReuseHistogram &getHistogram() const { return histogram; }
+
+private:
+    uint64_t sampleRate;
+    ReuseHistogram histogram;
+    std::unordered_map<uint64_t, uint64_t> lastAccess;
+    std::vector<uint32_t> tree;
+    uint64_t now = 0;
+    uint64_t previousAddress = 0;
+    bool hasPrevious = false;
+
+    void update(uint64_t position, int delta);
+    // 时间戳小于position的记号个数
+    uint64_t prefix(uint64_t position) const;
+    void compact();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "OperatorInfo.hpp"
+#include "TraceReader.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 抽样估计的变量及其策略在置信区间内的稳定性
+class SamplingRisk
+{
+public:
+    std::string funcName;
+    std::string varName;
+    // 按估计值推断的策略
+    AccessStrategy strategy = UNSUITABLE;
+    // 按估计值及步长占比取置信区间下、上端点时的空间局部性
+    double locality = 0.0;
+    double lowLocality = 0.0;
+    double highLocality = 0.0;
+    // 在置信区间端点上推断出的其它策略
+    std::vector<AccessStrategy> alternatives;
+
+    bool mayFlip() const { return !alternatives.empty(); }
+    // 空间局部性的置信区间是否跨过策略决断常量
+    bool straddlesFactor() const;
+};
+
+/**
+ * @brief 抽样误差对推断策略的影响
+ *
+ * 对每个有估计值的变量，把访问次数N与全部步长占比分别取置信区间的下、上端点（共四种组合），
+ * 其余变量保持估计值，对所在函数重新推断；任一组合下该变量的策略与估计值下不同，即报告策略可能改变。
+ * 空间局部性随各步长占比单调增加，因此步长占比同取下、上端点即得到L的区间。
+ */
+class SamplingUncertainty
+{
+public:
+    /**
+     * @brief 分析抽样跟踪中各变量的策略稳定性
+     *
+     * @param results 按估计值推断的结果，与op.functions一一对应
+     */
+    static std::vector<SamplingRisk> analyse(const OperatorInfo &op, const std::vector<FeatureVectorList> &results,
+                                             const TraceSampling &sampling);
+    // 打印抽样方式、各变量的估计值与置信区间及策略可能改变的变量
+    static void printReport(const TraceSampling &sampling, const std::vector<SamplingRisk> &risks, std::ostream &os);
+};
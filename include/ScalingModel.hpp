@@ -0,0 +1,114 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "InputDiscovery.hpp"
+#include "OperatorInfo.hpp"
+#include <string>
+#include <vector>
+
+// 数据集规模缩放模型：基于 data/<op>/ 下已有的各规模数据集拟合变量特征随问题规模的变化，
+// 外推任意规模下的访存特征和缓存策略。问题规模以算子所有变量的数据块大小之和（字节）度量。
+class ScalingModel
+{
+public:
+    // 幂律 y = coefficient * x^exponent，在对数坐标下最小二乘拟合
+    class PowerLaw
+    {
+    public:
+        double coefficient = 0.0;
+        double exponent = 1.0;
+        // 对数坐标下的决定系数
+        double r2 = 1.0;
+        // 参与拟合的点数
+        int points = 0;
+        double predict(double x) const;
+        static PowerLaw fit(const std::vector<std::pair<double, double>> &samples);
+    };
+
+    // 最大数据集中一个步长的缩放规律，其它数据集中与之对应的步长见matchPatterns
+    class PatternScaling
+    {
+    public:
+        // 各数据集中步长相同时为常量步长，否则按幂律随规模变化（如行长度步长）
+        bool constantStride = true;
+        int stride = 0;
+        PowerLaw strideLaw;
+        // 取最大已采集数据集中的占比
+        double percentage = 0.0;
+    };
+
+    class VariableScaling
+    {
+    public:
+        std::string funcName;
+        std::string varName;
+        PowerLaw sizeLaw;
+        PowerLaw accessLaw;
+        std::vector<PatternScaling> patterns;
+        // 步长组成稳定性：1减去相邻数据集间占比分布的最大总变差距离
+        double strideMixStability = 1.0;
+    };
+
+    class ProfiledDataset
+    {
+    public:
+        std::string dataset;
+        double footprint = 0.0;
+        OperatorInfo op;
+    };
+
+    // 变量推荐策略发生变化的规模
+    class StrategyFlip
+    {
+    public:
+        std::string funcName;
+        std::string varName;
+        AccessStrategyConfig from;
+        AccessStrategyConfig to;
+        double footprint = 0.0;
+    };
+
+    // 步长组成稳定性低于该值时给出警告
+    constexpr const static double STABILITY_WARNING = 0.9;
+
+    std::string opName;
+    // 按规模升序排列的已采集数据集
+    std::vector<ProfiledDataset> datasets;
+    std::vector<VariableScaling> variables;
+
+    /**
+     * @brief 加载输入清单中该算子的所有传统格式数据集并拟合缩放规律
+     *
+     * @return false 没有找到任何数据集
+     */
+    bool load(const std::string &opName, const InputManifest &manifest);
+    // 预测指定规模下的算子信息，名称驻留在返回算子自己的表中
+    OperatorInfo predict(double footprint) const;
+    // 在[minFootprint, maxFootprint]上按几何步长扫描，找出每个变量推荐策略变化的规模
+    std::vector<StrategyFlip> findFlips(double minFootprint, double maxFootprint, int stepsPerDoubling = 4) const;
+    // 打印拟合结果、指定规模的预测策略及策略变化点
+    void printReport(const std::vector<double> &targets) const;
+
+    // 算子所有变量的数据块大小之和
+    static double footprintOf(const OperatorInfo &op);
+    /**
+     * @brief 解析目标规模
+     *
+     * 支持字节数（可带K/M/G后缀）或相对最大已采集规模的倍数（如 4x）
+     */
+    static bool parseSize(const std::string &spec, double largestFootprint, double &footprint);
+    /**
+     * @brief 将一个数据集中变量的步长对应到参考数据集中同一变量的步长
+     *
+     * 先对应步长值相同的访存模式；其余的按符号分组、按步长绝对值升序依次对应，
+     * 使随规模变化的步长（如行长度）在各数据集间保持对应。
+     *
+     * @return 每个访存模式对应的参考模式序号，没有对应时为-1
+     */
+    static std::vector<int> matchPatterns(const AccessPatterns &patterns, const AccessPatterns &reference);
+
+private:
+    void fit();
+    // 对预测的算子逐函数推断策略，结果按 函数名/变量名 索引
+    static std::vector<AccessFeatureVector> deduct(const OperatorInfo &op, std::vector<std::string> &funcNames);
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 带内联存储的小向量
+ *
+ * 元素个数不超过N时存放在对象内部，不进行堆分配；超过N时整体迁移到由Alloc分配的存储上。
+ * 接口为std::vector的常用子集。
+ */
+template <typename T, size_t N, typename Alloc = std::allocator<T>>
+class SmallVector
+{
+public:
+    typedef T value_type;
+    typedef T *iterator;
+    typedef const T *const_iterator;
+    typedef size_t size_type;
+
+    SmallVector() : data_(inlineData()), size_(0), capacity_(N) {}
+    SmallVector(std::initializer_list<T> init) : SmallVector() { assign(init.begin(), init.end()); }
+    SmallVector(const std::vector<T> &other) : SmallVector() { assign(other.begin(), other.end()); }
+    SmallVector(const SmallVector &other)
+        : data_(inlineData()), size_(0), capacity_(N),
+          alloc_(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_))
+    {
+        assign(other.begin(), other.end());
+    }
+    SmallVector(SmallVector &&other) : data_(inlineData()), size_(0), capacity_(N), alloc_(other.alloc_)
+    {
+        moveFrom(other);
+    }
+    ~SmallVector()
+    {
+        clear();
+        releaseHeap();
+    }
+
+    SmallVector &operator=(const SmallVector &other)
+    {
+        if (this != &other) {
+            clear();
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    SmallVector &operator=(SmallVector &&other)
+    {
+        if (this != &other) {
+            clear();
+            releaseHeap();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        clear();
+        reserve(static_cast<size_t>(std::distance(first, last)));
+        for (; first != last; ++first) {
+            new (data_ + size_) T(*first);
+            size_++;
+        }
+    }
+
+    void push_back(const T &value) { emplace_back(value); }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+    template <typename... Args>
+    void emplace_back(Args &&...args)
+    {
+        if (size_ < capacity_) {
+            new (data_ + size_) T(std::forward<Args>(args)...);
+            size_++;
+            return;
+        }
+        // 参数可能引用本向量中的元素（如push_back(v[0])），须先在新存储中构造新元素，再迁移原有元素
+        size_t capacity = std::max<size_t>(1, capacity_ * 2);
+        T *heap = alloc_.allocate(capacity);
+        new (heap + size_) T(std::forward<Args>(args)...);
+        for (size_t i = 0; i < size_; i++) {
+            new (heap + i) T(std::move(data_[i]));
+            data_[i].~T();
+        }
+        releaseHeap();
+        data_ = heap;
+        capacity_ = capacity;
+        size_++;
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= capacity_) {
+            return;
+        }
+        T *heap = alloc_.allocate(capacity);
+        for (size_t i = 0; i < size_; i++) {
+            new (heap + i) T(std::move(data_[i]));
+            data_[i].~T();
+        }
+        releaseHeap();
+        data_ = heap;
+        capacity_ = capacity;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < size_; i++) {
+            data_[i].~T();
+        }
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    // 元素是否存放在内联存储中
+    bool isInline() const { return data_ == inlineData(); }
+
+    T &operator[](size_t i) { return data_[i]; }
+    const T &operator[](size_t i) const { return data_[i]; }
+    T &front() { return data_[0]; }
+    const T &front() const { return data_[0]; }
+    T &back() { return data_[size_ - 1]; }
+    const T &back() const { return data_[size_ - 1]; }
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    bool operator==(const SmallVector &other) const
+    {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const SmallVector &other) const { return !(*this == other); }
+
+    std::vector<T> toVector() const { return std::vector<T>(begin(), end()); }
+
+private:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type inline_[N];
+    T *data_;
+    size_t size_;
+    size_t capacity_;
+    Alloc alloc_;
+
+    T *inlineData() { return reinterpret_cast<T *>(inline_); }
+    const T *inlineData() const { return reinterpret_cast<const T *>(inline_); }
+
+    void releaseHeap()
+    {
+        if (!isInline()) {
+            alloc_.deallocate(data_, capacity_);
+            data_ = inlineData();
+            capacity_ = N;
+        }
+    }
+
+    // 前置条件：当前为空且使用内联存储
+    void moveFrom(SmallVector &other)
+    {
+        if (other.isInline() || !(alloc_ == other.alloc_)) {
+            // 内联存储或分配器不同时逐个移动元素
+            reserve(other.size_);
+            for (size_t i = 0; i < other.size_; i++) {
+                new (data_ + i) T(std::move(other.data_[i]));
+            }
+            size_ = other.size_;
+            other.clear();
+        } else {
+            // 堆存储直接接管
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.data_ = other.inlineData();
+            other.size_ = 0;
+            other.capacity_ = N;
+        }
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// 阈值策略模型使用的决断阈值
+class DecisionThresholds
+{
+public:
+    // 空间局部性高于该值时使用SINGLE策略，否则使用DIRECT策略
+    double strategyDetermineFactor = AccessStrategyDeducter::strategy_determine_factor;
+    // 单一零步长模式下，空间局部性低于该值视为随机访问，使用DIRECT策略
+    double randomAccessLocality = 0.9;
+
+    // 全局阈值，启动时可从校准生成的阈值文件加载，默认阈值模型使用该值
+    static DecisionThresholds &getInstance()
+    {
+        static DecisionThresholds instance;
+        return instance;
+    }
+
+    /**
+     * @brief 从阈值文件加载
+     *
+     * 格式与硬件配置文件相同，每行一个 key = value：strategy_determine_factor、random_access_locality
+     *
+     * @return false 文件无法打开或存在无法解析的行
+     */
+    bool loadFromFile(const std::string &path);
+    // 写入阈值文件，header为写在文件开头的注释
+    bool saveToFile(const std::string &path, const std::string &header) const;
+};
+
+// 缓存策略选择模型，C已划分且各候选策略的代价已估算后，为单个变量选择策略
+class StrategyCostModel
+{
+public:
+    virtual ~StrategyCostModel() {};
+    virtual std::string getName() const = 0;
+    // 选择缓存策略（F为0的变量由推断器直接判定为UNSUITABLE，不会传入模型）
+    virtual AccessStrategy selectStrategy(const AccessFeatureVector &featureVector) const = 0;
+
+    /**
+     * @brief 估算各候选策略的执行周期
+     *
+     * BULK: 一次DMA载入全部数据，之后所有访问命中SM，仅当C >= S时可行；
+     * SINGLE: 单行缓冲，按步长直方图估算跨行访问的缺失率，每次缺失传输一整行；
+     * DIRECT: 直接映射缓存，额外计入标签检查开销，随机访问部分按容量比例命中（有重用距离直方图时按LRU命中率）。
+     *
+     * @param featureVector 访存特征向量，结果写入strategyCosts
+     * @param profile 硬件参数
+     */
+    static void estimateCosts(AccessFeatureVector &featureVector, const HardwareProfile &profile);
+    // 按C及策略参数估算的行填充次数（即DMA传输次数），BULK为一次，C为0或UNSUITABLE时为无穷大
+    static double estimateLineFills(const AccessFeatureVector &featureVector, AccessStrategy strategy,
+                                    const HardwareProfile &profile);
+    // 所选策略的估算周期；UNSUITABLE或代价无法估算时按直接访问DDR计算
+    static double getSelectedCycles(const AccessFeatureVector &featureVector, const HardwareProfile &profile);
+
+    // 按名称创建模型，名称无效时返回空指针
+    static std::unique_ptr<StrategyCostModel> create(const std::string &name);
+    // 全局默认模型，未选择时为阈值模型
+    static const StrategyCostModel &getDefault();
+    // 设置全局默认模型，名称无效时返回false
+    static bool selectDefault(const std::string &name);
+    // 可用模型名称
+    static std::vector<std::string> getModelNames();
+};
+
+// 原有的固定阈值决策逻辑（默认模型）
+class ThresholdStrategyModel : public StrategyCostModel
+{
+public:
+    DecisionThresholds thresholds;
+    ThresholdStrategyModel() : thresholds(DecisionThresholds::getInstance()) {};
+    ThresholdStrategyModel(const DecisionThresholds &thresholds) : thresholds(thresholds) {};
+    std::string getName() const override { return "threshold"; }
+    AccessStrategy selectStrategy(const AccessFeatureVector &featureVector) const override;
+};
+
+// 周期代价模型：选择估算周期最小的可行策略
+class CycleCostStrategyModel : public StrategyCostModel
+{
+public:
+    std::string getName() const override { return "cycle"; }
+    AccessStrategy selectStrategy(const AccessFeatureVector &featureVector) const override;
+};
+
+// AM模式中向量访问变量的策略：AM只按整体或按向量宽度对齐的整行批量传输，C不小于按向量宽度对齐的S时BULK，否则SINGLE
+class AmStrategyModel : public StrategyCostModel
+{
+public:
+    explicit AmStrategyModel(int vectorWidth = 1) : vectorWidth(vectorWidth) {};
+    std::string getName() const override { return "am"; }
+    AccessStrategy selectStrategy(const AccessFeatureVector &featureVector) const override;
+
+private:
+    int vectorWidth;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 字符串驻留表
+ *
+ * 每个不同的字符串只保存一份，以32位编号引用。字符串存放在deque中，驻留后地址不变；
+ * 查找使用开放寻址哈希表，表中只保存编号。驻留非线程安全，每个算子在解析时独占自己的表；
+ * 算子的名称驻留在OperatorInfo以shared_ptr持有的表中，随最后一个持有者释放。
+ */
+class StringTable
+{
+public:
+    StringTable() {};
+    StringTable(const StringTable &) = delete;
+    StringTable &operator=(const StringTable &) = delete;
+
+    // 驻留字符串并返回编号
+    uint32_t intern(const std::string &str);
+    const std::string &get(uint32_t id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+
+private:
+    static const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+    std::deque<std::string> strings;
+    std::vector<uint32_t> slots;
+
+    static uint64_t hash(const std::string &str);
+    void rehash(size_t slotCount);
+};
+
+/**
+ * @brief 驻留名称的引用：指向驻留表中字符串的指针加编号
+ *
+ * 复制时不分配内存，读取不加锁。引用在所属驻留表销毁前有效：算子的名称须在持有其表的
+ * OperatorInfo（或其names的副本）存活期间使用。只能通过所属的表构造，不从字符串隐式转换。
+ */
+class InternedName
+{
+public:
+    InternedName() {};
+    InternedName(const StringTable *table, uint32_t id) : name(&table->get(id)), id(id) {};
+
+    const std::string &str() const { return (name != nullptr) ? *name : emptyName(); }
+    // 在所属驻留表中的编号，只在同一张表的名称之间可比
+    uint32_t getId() const { return id; }
+    bool empty() const { return str().empty(); }
+
+    // 同一张表中的同一个名称指向同一字符串，其余情况比较内容
+    bool operator==(const InternedName &other) const { return name == other.name || str() == other.str(); }
+    bool operator!=(const InternedName &other) const { return !(*this == other); }
+    bool operator==(const std::string &other) const { return str() == other; }
+    bool operator!=(const std::string &other) const { return str() != other; }
+    bool operator<(const InternedName &other) const { return str() < other.str(); }
+
+private:
+    const std::string *name = nullptr;
+    uint32_t id = 0;
+
+    static const std::string &emptyName();
+};
+
+inline std::ostream &operator<<(std::ostream &os, const InternedName &name) { return os << name.str(); }
+inline std::string operator+(const std::string &lhs, const InternedName &rhs) { return lhs + rhs.str(); }
+inline std::string operator+(const InternedName &lhs, const std::string &rhs) { return lhs.str() + rhs; }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "OperatorInfo.hpp"
+#include "StrategyCostModel.hpp"
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 单个变量在硬件上实测的各策略执行周期，按AccessStrategy索引，UNSUITABLE为直接访问DDR，未测量的策略为无穷大
+class StrategyMeasurement
+{
+public:
+    std::string opName;
+    // 传统格式的数据集名（去掉_DATASET后缀），通用格式为空
+    std::string dataset;
+    std::string funcName;
+    std::string varName;
+    double cycles[UNSUITABLE + 1] = {
+        std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+
+    // 实测最快的策略
+    AccessStrategy getFastest() const;
+};
+
+// 参与校准的已解析输入
+class CalibrationInput
+{
+public:
+    std::string opName;
+    // 与StrategyMeasurement::dataset相同的约定
+    std::string dataset;
+    OperatorInfo op;
+};
+
+// 校准结果：校准前后的阈值及与实测最快策略一致的变量数
+class CalibrationResult
+{
+public:
+    DecisionThresholds before;
+    DecisionThresholds after;
+    // 实测的变量数及其中在输入中找到的变量数
+    size_t measured = 0;
+    size_t matched = 0;
+    size_t gridPoints = 0;
+    // 按实测最快策略统计的变量数及校准前后推断一致的个数
+    size_t fastestCount[UNSUITABLE + 1] = {0, 0, 0, 0};
+    size_t agreeBefore[UNSUITABLE + 1] = {0, 0, 0, 0};
+    size_t agreeAfter[UNSUITABLE + 1] = {0, 0, 0, 0};
+
+    size_t getAgreeBefore() const;
+    size_t getAgreeAfter() const;
+};
+
+/**
+ * @brief 按实测数据校准阈值模型的决断阈值
+ *
+ * 实测文件为CSV，文件名（去掉扩展名）为算子名，标题行须含 核函数名、变量名、访存策略名、实测周期 列，
+ * 可选 计算负载 列（传统格式的数据集）；每行为一个变量在一种策略下的实测周期，重复测量取最小值。
+ * 校准在 strategy_determine_factor × random_access_locality 网格（另加当前阈值）上并行评估：
+ * 每个网格点用阈值模型对含实测变量的函数完整推断一次，统计推断策略与实测最快策略一致的变量数。
+ * 一致数最多的网格点中取与当前阈值最接近的一个，因此校准后的一致数不低于校准前。
+ */
+class ThresholdCalibrator
+{
+public:
+    constexpr static double FACTOR_MIN = 0.0;
+    constexpr static double FACTOR_MAX = 0.5;
+    constexpr static double FACTOR_STEP = 0.01;
+    constexpr static double RANDOM_LOCALITY_MIN = 0.5;
+    constexpr static double RANDOM_LOCALITY_MAX = 1.0;
+    constexpr static double RANDOM_LOCALITY_STEP = 0.02;
+
+    // 并行线程数，0表示使用硬件并发数
+    unsigned int jobs = 0;
+
+    // 默认的阈值文件，启动时存在则自动加载
+    static std::string getDefaultPath() { return ".masamt/thresholds"; }
+
+    /**
+     * @brief 读取实测文件
+     *
+     * @param path CSV文件，或目录（读取其中所有.csv）
+     * @return false 文件无法打开或缺少必需的列
+     */
+    static bool loadMeasurements(const std::string &path, std::vector<StrategyMeasurement> &measurements);
+
+    // 从current出发校准阈值
+    CalibrationResult calibrate(const std::vector<CalibrationInput> &inputs,
+                                const std::vector<StrategyMeasurement> &measurements,
+                                const DecisionThresholds &current) const;
+    static void printReport(const CalibrationResult &result, std::ostream &os);
+
+private:
+    // 含实测变量的函数及各变量的实测最快策略
+    class Target
+    {
+    public:
+        const FunctionInfo *func = nullptr;
+        std::vector<std::pair<std::string, AccessStrategy>> fastest;
+    };
+
+    static bool loadFile(const std::string &path, std::vector<StrategyMeasurement> &measurements);
+    // 在给定阈值下推断，按实测最快策略统计一致的变量数
+    static void countAgreement(const std::vector<Target> &targets, const DecisionThresholds &thresholds,
+                               size_t (&agree)[UNSUITABLE + 1]);
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 由步长推断的数组形状（元素数，行优先），一维数组rows为1
+class ArrayShape
+{
+public:
+    uint64_t rows = 1;
+    uint64_t cols = 0;
+};
+
+// 单个SINGLE/DIRECT变量的分块方案
+class TileChoice
+{
+public:
+    std::string name;
+    // 推断器原先选择的策略及其估算周期
+    AccessStrategy strategy = UNSUITABLE;
+    double originalCycles = 0.0;
+    ArrayShape shape;
+    // 是否改为分块BULK；否则保持原策略，以下字段无意义
+    bool tiled = false;
+    uint64_t tileRows = 0;
+    uint64_t tileCols = 0;
+    // 单个分块占用的SM空间（字节）
+    int tileBytes = 0;
+    uint64_t tiles = 0;
+    // DMA传输次数与总传输量（字节），passes为传输量相当于整个数组的遍数
+    uint64_t transfers = 0;
+    double dmaVolume = 0.0;
+    double passes = 1.0;
+    double cycles = 0.0;
+};
+
+// 单个函数的分块建议
+class TilingPlan
+{
+public:
+    std::string funcName;
+    // 扣除BULK变量后留给SINGLE/DIRECT变量的SM空间，及方案实际占用的空间
+    int budget = 0;
+    int used = 0;
+    std::vector<TileChoice> choices;
+    double originalCycles = 0.0;
+    double tiledCycles = 0.0;
+
+    bool hasTiles() const;
+};
+
+/**
+ * @brief 分块建议：把S超过分配空间C的SINGLE/DIRECT变量改为按分块BULK载入
+ *
+ * 数组形状由主要步长推断：某个大于1的步长d满足 d | E（或 d+1 | E，行末回绕）时视为行长，E为元素数，否则视为一维。
+ * 分块的行数、列数取不超过对应维度的2的幂及其约数；整行分块一次DMA传输，否则每行一次。
+ * 有重用距离直方图时，以分块大小的LRU命中率估计跨块的重新载入量；否则假设循环按块遍历，每个分块只载入一次。
+ * 所有候选变量在扣除BULK变量后的共享SM预算内按估算周期之和最小联合选择（以smAlignment为单位的背包），
+ * 分块不能降低周期的变量保持原策略并保留其原有占用。
+ */
+class TilingAdvisor
+{
+public:
+    // 推断后是否给出分块建议（--tiling）
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    static ArrayShape inferShape(const AccessFeatureVector &featureVector, int elementSize);
+    // 候选分块形状(行数, 列数)，不含整个数组
+    static std::vector<std::pair<uint64_t, uint64_t>> candidateTiles(const ArrayShape &shape);
+
+    /**
+     * @brief 为函数生成分块建议
+     *
+     * @param accessFeatureVectors 推断器给出的结果
+     * @param C_total SM总空间（字节）
+     */
+    static TilingPlan advise(const std::string &funcName, const FeatureVectorList &accessFeatureVectors, int C_total,
+                             const HardwareProfile &profile);
+    // 只输出含SINGLE/DIRECT变量的函数
+    static void printReport(const std::vector<TilingPlan> &plans, std::ostream &os);
+
+private:
+    // 把变量按指定分块改为BULK后的传输量与周期
+    static TileChoice evaluateTile(const AccessFeatureVector &featureVector, const ArrayShape &shape,
+                                   uint64_t tileRows, uint64_t tileCols, const HardwareProfile &profile);
+};
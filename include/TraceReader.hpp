@@ -0,0 +1,133 @@
+#pragma once
+
+#include "MasamtTrace.hpp"
+#include "OperatorInfo.hpp"
+#include "ReuseDistance.hpp"
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 从跟踪中统计出的单个变量的访存特征
+class TraceVariable
+{
+public:
+    std::string kernel;
+    std::string name;
+    uint64_t size = 0;
+    uint32_t elementSize = 1;
+    uint64_t accesses = 0;
+    MasamtTrace::StrideHistogram strides;
+    // 各线程访问序列的重用距离直方图之和
+    ReuseHistogram reuse;
+
+    // 以下仅用于抽样跟踪：样本序列数、批次数、各步长在每批中占比之和与平方和、被选中地址的访问次数（哈希抽样）
+    uint64_t streams = 0;
+    uint64_t batches = 0;
+    std::unordered_map<int64_t, std::pair<double, double>> batchFractions;
+    std::unordered_map<uint64_t, uint64_t> addressCounts;
+};
+
+// 抽样估计的步长占比（百分数）及其95%置信区间半宽
+class StrideEstimate
+{
+public:
+    int64_t stride = 0;
+    double percent = 0.0;
+    double error = 0.0;
+};
+
+// 单个变量由抽样跟踪得到的估计值，误差均为95%置信区间半宽
+class SampledEstimate
+{
+public:
+    std::string kernel;
+    std::string name;
+    uint64_t samples = 0;
+    uint64_t batches = 0;
+    double accesses = 0.0;
+    double accessesError = 0.0;
+    // 实际访问到的数据量（字节），只有哈希抽样可以估计，否则为负
+    double footprint = -1.0;
+    double footprintError = 0.0;
+    std::vector<StrideEstimate> strides;
+};
+
+// 抽样跟踪的抽样方式及各变量的估计值
+class TraceSampling
+{
+public:
+    MasamtTrace::SamplingConfig config;
+    std::vector<SampledEstimate> variables;
+
+    bool isSampled() const { return config.isSampled(); }
+};
+
+/**
+ * @brief 访存跟踪读取
+ *
+ * 读取masamt-trace生成的原始二进制跟踪（.mtrace）或由其转换的分块压缩跟踪（.mtc），按线程、变量计算相邻访问的步长并统计直方图，
+ * 生成与CSV输入相同的OperatorInfo：函数为内核，变量按注册顺序排列，每个变量保留出现最多的MAX_STRIDES个步长。
+ * 抽样跟踪的访问次数按抽样比例放大；步长占比的置信区间由批次均值法给出（突发抽样一个突发为一批），
+ * 哈希抽样另外按被选中地址估计访问次数与实际访问数据量的方差。
+ */
+class TraceReader
+{
+public:
+    static const size_t MAX_STRIDES = MasamtTrace::Tracer::MAX_STRIDES;
+
+    static bool isTracePath(const std::string &path);
+
+    // 分块压缩跟踪的解码线程数，0表示使用硬件并发数
+    static unsigned int getDecodeJobs();
+    static void setDecodeJobs(unsigned int jobs);
+    // 解析跟踪时重用距离的地址抽样模数：0不计算，1精确计算，R>1只统计约1/R的地址，
+    // REUSE_SAMPLE_AUTO（默认）按跟踪的访问次数选择，使参与计算的访问不超过REUSE_EXACT_ACCESSES
+    static const uint64_t REUSE_SAMPLE_AUTO = ~0ull;
+    static const uint64_t REUSE_EXACT_ACCESSES = 1ull << 24;
+    static uint64_t getReuseSampleRate();
+    static void setReuseSampleRate(uint64_t rate);
+    static uint64_t resolveReuseSampleRate(uint64_t rate, uint64_t accesses);
+
+    // 原始跟踪中一个地址块的回调：块记录与其地址数组（未对齐，按uint64_t逐个读取）
+    typedef std::function<void(const MasamtTrace::TraceBlockRecord &, const char *)> BlockVisitor;
+
+    /**
+     * @brief 按文件顺序读取原始二进制跟踪
+     *
+     * 变量定义写入variables（只有名称、大小与元素长度），抽样方式写入sampling，每个地址块交给visitor。
+     *
+     * @return false 文件头或记录格式错误
+     */
+    static bool readRawTrace(const std::string &content, std::vector<TraceVariable> &variables,
+                             MasamtTrace::SamplingConfig &sampling, const BlockVisitor &visitor);
+
+    /**
+     * @brief 统计原始二进制跟踪
+     *
+     * @param content 跟踪文件内容
+     * @param variables 按变量编号排列的统计结果（输出参数）
+     * @param sampling 跟踪的抽样方式（输出参数）
+     * @param reuseSampleRate 重用距离的地址抽样模数，0表示不计算重用距离，1表示精确计算
+     * @return false 文件头或记录格式错误
+     */
+    static bool scanRawTrace(const std::string &content, std::vector<TraceVariable> &variables,
+                             MasamtTrace::SamplingConfig &sampling, uint64_t reuseSampleRate = 0);
+
+    /**
+     * @brief 由抽样跟踪的统计计算各变量的估计值，并把变量的访问次数替换为估计值
+     *
+     * @param sampling 抽样方式已填写，估计值写入其variables
+     */
+    static void estimate(std::vector<TraceVariable> &variables, TraceSampling &sampling);
+
+    // 由变量统计构建算子信息
+    static void buildOperatorInfo(const std::string &opName, const std::vector<TraceVariable> &variables,
+                                  OperatorInfo &op);
+
+    // 从跟踪文件内容解析算子信息（按文件头区分两种格式），格式错误时给出警告并返回false
+    static bool parse(const std::string &opName, const std::string &content, OperatorInfo &op);
+    // 同上，抽样跟踪的估计值写入sampling
+    static bool parse(const std::string &opName, const std::string &content, OperatorInfo &op,
+                      TraceSampling &sampling);
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "AccessStrategyDeduct.hpp"
+#include "HardwareProfile.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 原始跟踪中一个内核各变量在等长窗口上的访问次数，用于判断变量是否同步访问
+class CoAccessProfile
+{
+public:
+    std::string kernel;
+    std::vector<std::string> names;
+    // windows[v][w]为变量names[v]在第w个窗口中的访问次数
+    std::vector<std::vector<uint64_t>> windows;
+
+    // 变量在profile中的序号，不存在时返回-1
+    int find(const std::string &name) const;
+};
+
+// 共享一个交错缓存区域的变量组
+class VariableGroup
+{
+public:
+    std::vector<std::string> members;
+    AccessStrategy strategy = SINGLE;
+    // 组内每个变量的子行长度（log2字节），共享区域每行依次存放各变量的同号子行，合并行长为 members.size() × 2^line
+    int set = 0;
+    int line = 0;
+    // 成员的C之和及共享区域的大小（字节）
+    int budget = 0;
+    int regionBytes = 0;
+    // 分组前各成员区域之和（含对齐填充）及未使用的划分空间（碎片）
+    int footprintBefore = 0;
+    int wastedBefore = 0;
+    int wastedAfter = 0;
+    // DMA传输（描述符）次数与估算周期，分组后每次填充用一个描述符链载入所有成员的子行
+    double transfersBefore = 0.0;
+    double transfersAfter = 0.0;
+    double cyclesBefore = 0.0;
+    double cyclesAfter = 0.0;
+    // 成员间最低的跟踪同步访问相似度，没有跟踪数据时为-1
+    double coAccess = -1.0;
+};
+
+// 单个函数的分组结果
+class GroupingPlan
+{
+public:
+    std::string funcName;
+    std::vector<VariableGroup> groups;
+};
+
+/**
+ * @brief 同步访问变量的分组分析
+ *
+ * 步长签名相近（各步长占比的L1距离不超过SIGNATURE_DISTANCE）、访问次数相近（比值不超过LOCKSTEP_RATIO）、
+ * 且推断为同一种SINGLE/DIRECT策略的变量视为同步访问；有原始跟踪时还要求各窗口访问次数分布的重叠度
+ * 不低于CO_ACCESS_SIMILARITY。每组合用成员C之和作为一个交错区域：各成员取相同的2的幂子行，
+ * 共享区域每行依次存放各成员的同号子行，按组内最多的行填充次数估算，每次填充以一个描述符链载入所有子行，
+ * 只需一次DMA启动延迟。分组后估算周期不增加、且传输次数或碎片减少时才保留该组。
+ */
+class VariableGrouper
+{
+public:
+    constexpr static double SIGNATURE_DISTANCE = 0.05;
+    constexpr static double LOCKSTEP_RATIO = 1.1;
+    constexpr static double CO_ACCESS_SIMILARITY = 0.9;
+    // 统计同步访问时每个内核的窗口数
+    static const size_t CO_ACCESS_WINDOWS = 256;
+
+    // 推断后是否给出分组建议（--grouping）
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief 统计原始跟踪中各内核变量在窗口上的访问次数
+     *
+     * @return false 不是原始跟踪（.mtrace）或格式错误
+     */
+    static bool collect(const std::string &content, std::vector<CoAccessProfile> &profiles);
+
+    // 两个变量步长占比的L1距离
+    static double signatureDistance(const AccessFeatureVector &a, const AccessFeatureVector &b);
+    // 两个变量窗口访问分布的重叠度（0～1）
+    static double coAccessSimilarity(const CoAccessProfile &profile, int a, int b);
+
+    /**
+     * @brief 为函数中的同步访问变量分组
+     *
+     * @param coAccess 该函数对应内核的跟踪统计，可以为空
+     */
+    static GroupingPlan group(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                              const CoAccessProfile *coAccess, const HardwareProfile &profile);
+    // 只输出有变量组的函数
+    static void printReport(const std::vector<GroupingPlan> &plans, std::ostream &os);
+
+private:
+    // 估算一组变量合用交错区域后的参数、传输次数与周期，组不可行时返回false
+    static bool evaluateGroup(const FeatureVectorList &accessFeatureVectors, const std::vector<size_t> &members,
+                              const HardwareProfile &profile, VariableGroup &group);
+};
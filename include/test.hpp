@@ -36,7 +36,7 @@ int test_operator_info()
  * 空间局部性计算公式：SL = Σ(p_i * e^(-s_i))
  * 其中p_i为步长s_i的访问占比,e^(-s_i)为步长s_i对应的衰减因子
  */
-double calcuSpatialLocality(const std::vector<std::pair<int, double>> &patterns)
+double calcuSpatialLocality(const AccessPatterns &patterns)
 {
     if (patterns.empty()) {
         return 0.0;
@@ -116,7 +116,7 @@ void test_adi_operator()
         std::cout << "\n[函数] " << func.name << std::endl;
 
         // 将变量按访存次数排序
-        std::vector<VariableInfo> sorted_vars = func.variables;
+        VariableList sorted_vars = func.variables;
         std::sort(sorted_vars.begin(), sorted_vars.end(),
                   [](const VariableInfo &a, const VariableInfo &b) { return a.access > b.access; });
 
@@ -1,6 +1,21 @@
 #include "AccessStrategyDeduct.hpp"
-#include <cmath>
+#include "DMAPipelineAdvisor.hpp"
+#include "StrategyCostModel.hpp"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+
+std::atomic<bool> &amEnabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+} // namespace
 
 AccessFeatureVector::AccessFeatureVector(const VariableInfo &var)
 {
@@ -8,7 +23,9 @@ AccessFeatureVector::AccessFeatureVector(const VariableInfo &var)
     this->S = var.size;
     this->N = var.access;
     this->patterns = var.patterns;
+    this->reuse = var.reuse;
     calculateL();
+    calculateT();
     calculateD();
     calculateF();
 }
@@ -27,9 +44,15 @@ void AccessFeatureVector::calculateL()
     this->L = locality;
 }
 
+void AccessFeatureVector::calculateT()
+{
+    // 以SM容量为参考：重用距离内访问的数据远小于SM时，重用可由缓存满足
+    this->T = (reuse != nullptr) ? reuse->getTemporalLocality(HardwareProfile::getInstance().smSize) : 0.0;
+}
+
 void AccessFeatureVector::calculateD() { this->D = static_cast<double>(N) / S; }
 
-void AccessFeatureVector::calculateF() { this->F = L * D; }
+void AccessFeatureVector::calculateF() { this->F = (L + T) * D; }
 
 void AccessFeatureVector::printInfo() const
 {
@@ -43,16 +66,59 @@ void AccessFeatureVector::printInfo() const
     }
 
     std::cout << ", 密度=" << std::fixed << std::setprecision(2) << D << ", 局部性=" << std::fixed
-              << std::setprecision(4) << L << ", 策略=" << accessStrategyConfig.getStrategyName()
-              << ", line=" << accessStrategyConfig.line << ", set=" << accessStrategyConfig.set << std::endl;
+              << std::setprecision(4) << L;
+    if (reuse != nullptr) {
+        std::cout << ", 时间局部性=" << std::fixed << std::setprecision(4) << T;
+    }
+    std::cout << ", 策略=" << accessStrategyConfig.getStrategyName()
+              << ", line=" << accessStrategyConfig.line << ", set=" << accessStrategyConfig.set;
+    if (memory == MEMORY_AM) {
+        std::cout << ", 存储=AM";
+    }
+    if (accessStrategyConfig.accessStrategy != UNSUITABLE) {
+        std::cout << ", 代价(BULK/SINGLE/DIRECT)=" << StrategyCosts::formatCycles(strategyCosts.cycles[BULK]) << "/"
+                  << StrategyCosts::formatCycles(strategyCosts.cycles[SINGLE]) << "/"
+                  << StrategyCosts::formatCycles(strategyCosts.cycles[DIRECT]);
+    }
+    if (bufferingPlan.bufferCount > 1) {
+        std::cout << ", 缓冲=" << bufferingPlan.getBufferingName() << "(" << bufferingPlan.bufferCount << "x"
+                  << bufferingPlan.bufferSize << "B)" << ", 停顿降低=" << std::fixed << std::setprecision(1)
+                  << bufferingPlan.getStallReduction() * 100 << "%";
+    }
+    if (prefetchPlan.isEnabled()) {
+        std::cout << ", 预取=距离" << prefetchPlan.distance << "x" << prefetchPlan.chunkSize << "B"
+                  << ", 停顿降低=" << std::fixed << std::setprecision(1) << prefetchPlan.getStallReduction() * 100
+                  << "%";
+    }
+    std::cout << std::endl;
 }
 
 void AccessFeatureVector::printOneLine() const
 {
     // 根据新的列顺序输出简洁的一行信息
     std::cout << varName << " C=" << C << " S=" << S << " N=" << N << " D=" << std::fixed << std::setprecision(2) << D
-              << " L=" << std::fixed << std::setprecision(4) << L << " " << accessStrategyConfig.getStrategyName()
+              << " L=" << std::fixed << std::setprecision(4) << L;
+    if (reuse != nullptr) {
+        std::cout << " T=" << std::fixed << std::setprecision(4) << T;
+    }
+    std::cout << " " << accessStrategyConfig.getStrategyName()
               << " line=" << accessStrategyConfig.line << " set=" << accessStrategyConfig.set;
+    if (memory == MEMORY_AM) {
+        std::cout << " mem=AM";
+    }
+    if (accessStrategyConfig.accessStrategy != UNSUITABLE) {
+        std::cout << " cost=" << StrategyCosts::formatCycles(strategyCosts.cycles[BULK]) << "/"
+                  << StrategyCosts::formatCycles(strategyCosts.cycles[SINGLE]) << "/"
+                  << StrategyCosts::formatCycles(strategyCosts.cycles[DIRECT]);
+    }
+    if (bufferingPlan.bufferCount > 1) {
+        std::cout << " buf=" << bufferingPlan.bufferCount << "x" << bufferingPlan.bufferSize << " stall-=" << std::fixed
+                  << std::setprecision(1) << bufferingPlan.getStallReduction() * 100 << "%";
+    }
+    if (prefetchPlan.isEnabled()) {
+        std::cout << " pf=" << prefetchPlan.distance << "x" << prefetchPlan.chunkSize << " stall-=" << std::fixed
+                  << std::setprecision(1) << prefetchPlan.getStallReduction() * 100 << "%";
+    }
 }
 
 void AccessStrategyDeducter::calculateC()
@@ -67,7 +133,7 @@ void AccessStrategyDeducter::calculateC()
     }
 }
 
-void AccessStrategyDeducter::calculateC(std::vector<AccessFeatureVector> &accessFeatureVectors, int C_total)
+void AccessStrategyDeducter::calculateC(FeatureVectorList &accessFeatureVectors, int C_total)
 {
     // 归一化各个变量的空间划分因子，然后计算划分后的SM空间大小
     double sumF = 0.0;
@@ -79,70 +145,69 @@ void AccessStrategyDeducter::calculateC(std::vector<AccessFeatureVector> &access
     }
 }
 
-void AccessStrategyDeducter::determineStrategy(std::vector<AccessFeatureVector> &accessFeatureVectors)
+void AccessStrategyDeducter::determineStrategy(FeatureVectorList &accessFeatureVectors)
+{
+    determineStrategy(accessFeatureVectors, StrategyCostModel::getDefault(), HardwareProfile::getInstance());
+}
+
+void AccessStrategyDeducter::determineStrategy(FeatureVectorList &accessFeatureVectors,
+                                               const StrategyCostModel &model, const HardwareProfile &profile)
 {
     for (auto &featureVector : accessFeatureVectors) {
         // 如果空间划分因子为0，则使用UNSUITABLE策略
         if (featureVector.F == 0) {
+            featureVector.strategyCosts = StrategyCosts();
             featureVector.accessStrategyConfig.setStrategy(AccessStrategy::UNSUITABLE);
             continue;
         }
-        // 如果划分后的SM空间大小大于访存空间大小，则使用BULK策略
-        if (static_cast<unsigned long long>(featureVector.C) >= featureVector.S) {
-            featureVector.accessStrategyConfig.setStrategy(AccessStrategy::BULK);
+        // 估算各候选策略的代价，由模型选择策略
+        StrategyCostModel::estimateCosts(featureVector, profile);
+        AccessStrategy accessStrategy = model.selectStrategy(featureVector);
+        featureVector.accessStrategyConfig.setStrategy(accessStrategy);
+        if (accessStrategy == AccessStrategy::BULK) {
             featureVector.accessStrategyConfig.setParm(0, featureVector.S);
-            continue;
-        }
-        // 如果划分后的SM空间大小小于访存空间大小，则使用SINGLE/DIRECT策略
-        if (static_cast<unsigned long long>(featureVector.C) < featureVector.S) {
-            // 如果空间局部性大于策略决断常量，则使用SINGLE策略
-            if (featureVector.L > AccessStrategyDeducter::strategy_determine_factor) {
-                // 如果只有一个步长且步长为0，且空间局部性小于0.9，说明这个变量的访问实际上是随机的，用DIRECT策略
-                if (featureVector.patterns.size() == 1 && featureVector.patterns[0].first == 0 &&
-                    featureVector.L < 0.9) {
-                    featureVector.accessStrategyConfig.setStrategy(AccessStrategy::DIRECT);
-                } else {
-                    featureVector.accessStrategyConfig.setStrategy(AccessStrategy::SINGLE);
-                }
-            } else { // 如果空间局部性小于策略决断常量，则使用DIRECT策略
-                featureVector.accessStrategyConfig.setStrategy(AccessStrategy::DIRECT);
-            }
         }
     }
 }
 
-void AccessStrategyDeducter::determineParameters(std::vector<AccessFeatureVector> &accessFeatureVectors)
+void AccessStrategyDeducter::calculateDirectParameters(const AccessFeatureVector &featureVector, int &set, int &line)
+{
+    // 找出patterns中的最大步长
+    int maxStride = 0;
+    for (const auto &pattern : featureVector.patterns) {
+        maxStride = std::max(maxStride, static_cast<int>(pattern.first));
+    }
+    if (maxStride == 0) { // 完全随机访问
+        // line = static_cast<int>(floor(log2(featureVector.C / 2.0)));
+        // set = 1;
+        maxStride = featureVector.D;
+        line = static_cast<int>(std::round(std::log2(maxStride)));
+    } else {
+        // 找到最接近maxStride的2的幂的指数，这里假设数据类型长度为32字节（4Bytes）
+        line = static_cast<int>(std::round(std::log2(maxStride))) + 2;
+    }
+    // 限制line的范围，确保set*2^line <= C
+    line = std::max(4, std::min(line, static_cast<int>(std::floor(std::log2(featureVector.C)))));
+
+    set = std::max(1, static_cast<int>(std::floor(featureVector.C / (1 << line))));
+    set = static_cast<int>(std::floor(std::log2(set)));
+}
+
+void AccessStrategyDeducter::determineParameters(FeatureVectorList &accessFeatureVectors, int alignment)
 {
+    int minLine = static_cast<int>(std::log2(alignment));
     for (auto &featureVector : accessFeatureVectors) {
         if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::UNSUITABLE) {
             featureVector.accessStrategyConfig.setParm(0, 0);
         } else if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::BULK) {
-            featureVector.accessStrategyConfig.setParm(0, featureVector.S);
+            featureVector.accessStrategyConfig.setParm(0, AccessStrategyConfig::alignSize(featureVector.S, alignment));
         } else if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::SINGLE) {
-            // line = floor(log2(C))
-            featureVector.accessStrategyConfig.setParm(0, std::floor(std::log2(featureVector.C)));
+            // line = floor(log2(C))，且整行按对齐大小传输
+            int line = static_cast<int>(std::floor(std::log2(featureVector.C)));
+            featureVector.accessStrategyConfig.setParm(0, std::max(line, minLine));
         } else if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::DIRECT) {
             int line, set;
-            // 找出patterns中的最大步长
-            int maxStride = 0;
-            for (const auto &pattern : featureVector.patterns) {
-                maxStride = std::max(maxStride, static_cast<int>(pattern.first));
-            }
-            if (maxStride == 0) { // 完全随机访问
-                // line = static_cast<int>(floor(log2(featureVector.C / 2.0)));
-                // set = 1;
-                maxStride = featureVector.D;
-                line = static_cast<int>(std::round(std::log2(maxStride)));
-            } else {
-                // 找到最接近maxStride的2的幂的指数，这里假设数据类型长度为32字节（4Bytes）
-                line = static_cast<int>(std::round(std::log2(maxStride))) + 2;
-            }
-            // 限制line的范围，确保set*2^line <= C
-            line = std::max(4, std::min(line, static_cast<int>(std::floor(std::log2(featureVector.C)))));
-
-            set = std::max(1, static_cast<int>(std::floor(featureVector.C / (1 << line))));
-            set = static_cast<int>(std::floor(std::log2(set)));
-
+            calculateDirectParameters(featureVector, set, line);
             featureVector.accessStrategyConfig.setParm(set, line);
         }
     }
@@ -154,42 +219,93 @@ void AccessStrategyDeducter::deductAccessStrategy(const FunctionInfo &func)
     this->funcName = func.name;
     accessFeatureVectors.clear(); // 清空最终结果向量
 
-    // 初始SM可用空间
-    int C_total = AccessStrategyDeducter::C_total;
+    const StrategyCostModel &model = (costModel != nullptr) ? *costModel : StrategyCostModel::getDefault();
 
-    // 将所有变量添加到临时向量
-    std::vector<AccessFeatureVector> accessFeatureVectors_tmp;
+    // 将所有变量添加到临时向量，AM模式下向量访问的变量单独划分
+    FeatureVectorList accessFeatureVectors_tmp, vectorCandidates;
+    accessFeatureVectors.reserve(func.variables.size());
+    accessFeatureVectors_tmp.reserve(func.variables.size());
+    bool amEnabled = isAmEnabled();
     for (const auto &var : func.variables) {
         AccessFeatureVector featureVector(var);
-        accessFeatureVectors_tmp.push_back(featureVector);
+        if (amEnabled && isVectorAccess(featureVector)) {
+            vectorCandidates.push_back(featureVector);
+        } else {
+            accessFeatureVectors_tmp.push_back(featureVector);
+        }
+    }
+
+    // AM中初次划分放不下一个向量宽度的变量仍由SM缓存；此后BULK变量释放空间，其余变量的C只会增加。
+    // 两个存储此后各自决策，不再互相回退：UNSUITABLE只在F为0时出现，与所在存储无关
+    FeatureVectorList amFeatureVectors_tmp;
+    if (!vectorCandidates.empty()) {
+        calculateC(vectorCandidates, amTotal);
+        for (auto &featureVector : vectorCandidates) {
+            if (featureVector.C >= profile.vectorWidth) {
+                featureVector.memory = MEMORY_AM;
+                amFeatureVectors_tmp.push_back(featureVector);
+            } else {
+                accessFeatureVectors_tmp.push_back(featureVector);
+            }
+        }
     }
 
     /*-----------------------循环决策过程--------------------------------*/
+    deductMemory(accessFeatureVectors_tmp, C_total, model, 1, accessFeatureVectors);
+    FeatureVectorList amFeatureVectors;
+    deductMemory(amFeatureVectors_tmp, amTotal, AmStrategyModel(profile.vectorWidth), profile.vectorWidth,
+                 amFeatureVectors);
+
+    /*-----------------------确定参数--------------------------------*/
+    // 根据需要调用参数确定函数，AM中的区域按向量宽度对齐
+    determineParameters(accessFeatureVectors);
+    determineParameters(amFeatureVectors, profile.vectorWidth);
+
+    /*-----------------------DMA流水分析--------------------------------*/
+    DMAPipelineAdvisor::adviseBuffering(accessFeatureVectors, AccessStrategyDeducter::C_total, profile);
+    DMAPipelineAdvisor::advisePrefetch(accessFeatureVectors, AccessStrategyDeducter::C_total, profile);
+    if (!amFeatureVectors.empty()) {
+        DMAPipelineAdvisor::adviseBuffering(amFeatureVectors, amTotal, profile);
+        DMAPipelineAdvisor::advisePrefetch(amFeatureVectors, amTotal, profile);
+        // SM与AM分别推断，合并后按变量在函数中的原始顺序排列；同一函数的变量名驻留在同一个表中
+        std::unordered_map<uint32_t, size_t> positions;
+        for (size_t i = 0; i < func.variables.size(); i++) {
+            positions[func.variables[i].name.getId()] = i;
+        }
+        accessFeatureVectors.insert(accessFeatureVectors.end(), amFeatureVectors.begin(), amFeatureVectors.end());
+        std::stable_sort(accessFeatureVectors.begin(), accessFeatureVectors.end(),
+                         [&positions](const AccessFeatureVector &a, const AccessFeatureVector &b) {
+                             return positions.at(a.varName.getId()) < positions.at(b.varName.getId());
+                         });
+    }
+}
+
+void AccessStrategyDeducter::deductMemory(FeatureVectorList &candidates, int C_total, const StrategyCostModel &model,
+                                          int alignment, FeatureVectorList &results) const
+{
+    FeatureVectorList accessFeatureVectors_tmp = std::move(candidates);
     bool hasChanges = true;
-    // int loop_count = 0;
     while (hasChanges && !accessFeatureVectors_tmp.empty()) {
-        // loop_count++;
-        // std::cout << "第" << loop_count << "次循环" << std::endl;
         // 划分空间
         calculateC(accessFeatureVectors_tmp, C_total);
 
         // 决策策略
-        determineStrategy(accessFeatureVectors_tmp);
+        determineStrategy(accessFeatureVectors_tmp, model, profile);
 
         // 创建新向量存储非BULK和非UNSUITABLE的变量
-        std::vector<AccessFeatureVector> remaining;
+        FeatureVectorList remaining;
         hasChanges = false; // 重置变化标志
 
         for (auto &featureVector : accessFeatureVectors_tmp) {
             if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::BULK) {
-                // 更新可用空间 - BULK只需要实际访存大小的空间
-                C_total -= featureVector.S;
+                // 更新可用空间 - BULK只需要实际访存大小（按对齐取整）的空间
+                C_total -= AccessStrategyConfig::alignSize(featureVector.S, alignment);
                 // 添加到最终结果
-                accessFeatureVectors.push_back(featureVector);
+                results.push_back(featureVector);
                 hasChanges = true; // 标记有变化
             } else if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::UNSUITABLE) {
                 // 添加到最终结果
-                accessFeatureVectors.push_back(featureVector);
+                results.push_back(featureVector);
                 hasChanges = true; // 标记有变化
             } else {
                 // 保留非BULK和非UNSUITABLE的变量进入下一轮
@@ -198,27 +314,46 @@ void AccessStrategyDeducter::deductAccessStrategy(const FunctionInfo &func)
         }
 
         // 更新临时向量
-        accessFeatureVectors_tmp = remaining;
-        // std::cout << "剩余变量数量: " << accessFeatureVectors_tmp.size() << std::endl;
-        // output C_total
-        // std::cout << "C_total: " << C_total << std::endl;
+        accessFeatureVectors_tmp = std::move(remaining);
     }
 
     /*-----------------------处理剩余变量--------------------------------*/
     // 对剩余变量进行最终决策
     if (!accessFeatureVectors_tmp.empty()) {
         calculateC(accessFeatureVectors_tmp, C_total);
-        determineStrategy(accessFeatureVectors_tmp);
+        determineStrategy(accessFeatureVectors_tmp, model, profile);
 
         // 将剩余变量添加到最终结果
         for (auto &featureVector : accessFeatureVectors_tmp) {
-            accessFeatureVectors.push_back(featureVector);
+            results.push_back(featureVector);
         }
     }
+}
 
-    /*-----------------------确定参数--------------------------------*/
-    // 根据需要调用参数确定函数
-    determineParameters(accessFeatureVectors);
+bool AccessStrategyDeducter::isAmEnabled() { return amEnabledStorage().load(); }
+
+void AccessStrategyDeducter::setAmEnabled(bool enabled) { amEnabledStorage().store(enabled); }
+
+bool AccessStrategyDeducter::isVectorAccess(const AccessFeatureVector &featureVector)
+{
+    double unitShare = 0.0;
+    for (const auto &pattern : featureVector.patterns) {
+        if (pattern.first == 1 || pattern.first == -1) {
+            unitShare += pattern.second;
+        }
+    }
+    return unitShare >= vector_stride_share;
+}
+
+int AccessStrategyDeducter::getSpaceUsage(const FeatureVectorList &accessFeatureVectors, TargetMemory memory)
+{
+    int usage = 0;
+    for (const auto &featureVector : accessFeatureVectors) {
+        if (featureVector.memory == memory) {
+            usage += std::max(0, featureVector.accessStrategyConfig.getSMFootprint());
+        }
+    }
+    return usage;
 }
 
 void AccessStrategyDeducter::printAccessStrategy() const
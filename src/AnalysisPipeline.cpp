@@ -0,0 +1,200 @@
+#include "AnalysisPipeline.hpp"
+#include "FileUtils.hpp"
+#include "MemoryInstrument.hpp"
+#include "TraceReader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+void AnalysisPipeline::parse(AnalysisJob &job)
+{
+    MemoryInstrument::PhaseScope phaseScope(PHASE_PARSE);
+    ArenaScope arenaScope(job.arena);
+    if (TraceReader::isTracePath(job.input.path)) {
+        TraceReader::parse(job.input.opName, job.content, job.op, job.sampling);
+        if (PhaseDetector::isEnabled() && !PhaseDetector::detect(job.content, job.phases)) {
+            std::cerr << "警告: 阶段检测需要未抽样的原始跟踪(.mtrace): " << job.input.path << std::endl;
+        }
+        // 分块压缩跟踪按块重排，没有同步访问统计，分组只按步长签名
+        if (VariableGrouper::isEnabled()) {
+            VariableGrouper::collect(job.content, job.coAccess);
+        }
+    } else {
+        job.op.getOperatorInfoFromBuffer(job.input.opName, job.content);
+    }
+    std::string().swap(job.content);
+    if (MemoryInstrument::isEnabled()) {
+        for (const auto &func : job.op.functions) {
+            MemoryInstrument::addRows(func.variables.size());
+        }
+    }
+}
+
+void AnalysisPipeline::deduce(AnalysisJob &job)
+{
+    MemoryInstrument::PhaseScope phaseScope(PHASE_DEDUCE);
+    // 推断的临时分配放在本线程的内存池中并逐函数回退，只有结果复制到任务的内存池
+    ArenaScope scratchScope(MonotonicArena::threadArena(), true);
+    job.results.reserve(job.op.functions.size());
+    for (const auto &func : job.op.functions) {
+        ArenaCheckpoint checkpoint;
+        AccessStrategyDeducter deducter;
+        deducter.deductAccessStrategy(func);
+
+        ArenaScope jobScope(job.arena);
+        job.results.push_back(deducter.accessFeatureVectors);
+    }
+    if (job.sampling.isSampled()) {
+        job.samplingRisks = SamplingUncertainty::analyse(job.op, job.results, job.sampling);
+    }
+    PhaseDetector::evaluate(job.phases);
+    if (TilingAdvisor::isEnabled()) {
+        const HardwareProfile &profile = HardwareProfile::getInstance();
+        for (size_t f = 0; f < job.op.functions.size(); f++) {
+            job.tilingPlans.push_back(
+                TilingAdvisor::advise(job.op.functions[f].name.str(), job.results[f], profile.smSize, profile));
+        }
+    }
+    if (DirectPlacement::isEnabled()) {
+        const HardwareProfile &profile = HardwareProfile::getInstance();
+        for (size_t f = 0; f < job.op.functions.size(); f++) {
+            job.placements.push_back(DirectPlacement::place(job.op.functions[f].name.str(), job.results[f], profile));
+        }
+    }
+    if (HierarchyPlanner::isEnabled()) {
+        const HardwareProfile &profile = HardwareProfile::getInstance();
+        for (size_t f = 0; f < job.op.functions.size(); f++) {
+            job.hierarchyPlans.push_back(HierarchyPlanner::plan(job.op.functions[f].name.str(), job.results[f], profile));
+        }
+    }
+    if (VariableGrouper::isEnabled()) {
+        const HardwareProfile &profile = HardwareProfile::getInstance();
+        for (size_t f = 0; f < job.op.functions.size(); f++) {
+            std::string funcName = job.op.functions[f].name.str();
+            const CoAccessProfile *coAccess = nullptr;
+            for (const auto &kernel : job.coAccess) {
+                if (kernel.kernel == funcName) {
+                    coAccess = &kernel;
+                }
+            }
+            job.groupingPlans.push_back(VariableGrouper::group(funcName, job.results[f], coAccess, profile));
+        }
+    }
+}
+
+void AnalysisPipeline::run(const std::vector<AnalysisInput> &inputs, const Writer &writer)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned int workers = (jobs > 0) ? jobs : std::max(1u, std::thread::hardware_concurrency());
+    // 推断比解析耗时，约三分之一的工作线程用于解析
+    unsigned int parsers = std::max(1u, workers / 3);
+    unsigned int deducers = std::max(1u, workers - std::min(workers, parsers));
+
+    BoundedQueue<AnalysisJob *> readQueue(queueDepth);
+    BoundedQueue<AnalysisJob *> parseQueue(queueDepth);
+    BoundedQueue<AnalysisJob *> deduceQueue(queueDepth);
+    // 限制在途任务数，使等待重排序的任务也受队列深度约束
+    const size_t maxInFlight = readQueue.getCapacity() * 2 + parsers + deducers;
+    std::atomic<size_t> inFlight(0);
+
+    std::vector<std::thread> threads;
+    threads.push_back(std::thread([&]() {
+        for (size_t i = 0; i < inputs.size(); i++) {
+            while (inFlight.load(std::memory_order_acquire) >= maxInFlight) {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            inFlight.fetch_add(1, std::memory_order_acq_rel);
+            AnalysisJob *job = new AnalysisJob();
+            job->sequence = i;
+            job->input = inputs[i];
+            job->exists = FileUtils::readFile(job->input.path, job->content);
+            readQueue.push(job);
+        }
+        readQueue.close();
+    }));
+
+    // 每级的最后一个工作线程结束时关闭下游队列
+    auto startStage = [&](unsigned int count, BoundedQueue<AnalysisJob *> &from, BoundedQueue<AnalysisJob *> &to,
+                          void (*process)(AnalysisJob &), std::atomic<unsigned int> &remaining) {
+        for (unsigned int t = 0; t < count; t++) {
+            threads.push_back(std::thread([&from, &to, process, &remaining]() {
+                AnalysisJob *job;
+                while (from.pop(job)) {
+                    if (job->exists) {
+                        process(*job);
+                    }
+                    to.push(job);
+                }
+                if (remaining.fetch_sub(1) == 1) {
+                    to.close();
+                }
+            }));
+        }
+    };
+    std::atomic<unsigned int> parsersRemaining(parsers);
+    std::atomic<unsigned int> deducersRemaining(deducers);
+    startStage(parsers, readQueue, parseQueue, &AnalysisPipeline::parse, parsersRemaining);
+    startStage(deducers, parseQueue, deduceQueue, &AnalysisPipeline::deduce, deducersRemaining);
+
+    // 调用线程按输入顺序写出
+    std::map<size_t, AnalysisJob *> pending;
+    size_t next = 0;
+    maxReorderBacklog = 0;
+    AnalysisJob *job;
+    while (deduceQueue.pop(job)) {
+        pending[job->sequence] = job;
+        maxReorderBacklog = std::max(maxReorderBacklog, pending.size() - 1);
+        while (!pending.empty() && pending.begin()->first == next) {
+            AnalysisJob *ready = pending.begin()->second;
+            pending.erase(pending.begin());
+            MemoryInstrument::PhaseScope phaseScope(PHASE_WRITE);
+            writer(*ready);
+            delete ready;
+            inFlight.fetch_sub(1, std::memory_order_acq_rel);
+            next++;
+        }
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    stats.clear();
+    StageStats stage;
+    stage.name = "read";
+    stage.workers = 1;
+    stage.queue = readQueue.getStats();
+    stats.push_back(stage);
+    stage.name = "parse";
+    stage.workers = parsers;
+    stage.queue = parseQueue.getStats();
+    stats.push_back(stage);
+    stage.name = "deduce";
+    stage.workers = deducers;
+    stage.queue = deduceQueue.getStats();
+    stats.push_back(stage);
+    elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AnalysisPipeline::printStats(std::ostream &os) const
+{
+    if (stats.empty()) {
+        return;
+    }
+    os << "Pipeline stats (" << stats.front().queue.pushes << " files, " << std::fixed << std::setprecision(3)
+       << elapsedSeconds << " s)\n";
+    os << "  " << std::left << std::setw(8) << "stage" << std::right << std::setw(8) << "workers" << std::setw(10)
+       << "out-queue" << std::setw(10) << "avg-occ" << std::setw(10) << "max-occ" << std::setw(12) << "full-waits"
+       << std::setw(12) << "empty-waits" << "\n";
+    for (const auto &stage : stats) {
+        os << "  " << std::left << std::setw(8) << stage.name << std::right << std::setw(8) << stage.workers
+           << std::setw(10) << stage.queue.capacity << std::setw(10) << std::setprecision(2)
+           << stage.queue.getAverageOccupancy() << std::setw(10) << stage.queue.maxOccupancy << std::setw(12)
+           << stage.queue.fullWaits << std::setw(12) << stage.queue.emptyWaits << "\n";
+    }
+    os << "  write: 1 ordered writer, max reorder backlog " << maxReorderBacklog << " jobs\n";
+    // 某级输出队列经常满说明下游是瓶颈，经常空说明该级本身是瓶颈
+    os << "  (full-waits: the next stage is the bottleneck; empty-waits: this stage cannot keep up)" << std::endl;
+}
@@ -1,5 +1,8 @@
 #include "CSVHandler.hpp"
+#include "FileUtils.hpp"
+#include "TraceReader.hpp"
 #include <sys/stat.h>
+#include <cstdio>
 #include <iostream>
 #include <cmath>
 #include <locale>
@@ -18,7 +21,7 @@ void CSVHandler::createDirectory(const std::string& path) {
     mkdir(path.c_str(), 0777);
 }
 
-std::string CSVHandler::buildPatternsString(const std::vector<std::pair<int, double>>& patterns) {
+std::string CSVHandler::buildPatternsString(const AccessPatterns& patterns) {
     std::stringstream patternsStr;
     bool first = true;
     for (const auto& pattern : patterns) {
@@ -50,6 +53,12 @@ void CSVHandler::validateAndFixMetrics(double& density, double& locality) {
 }
 
 void CSVHandler::readOperatorInfo(const std::string& opName, const std::string& csvPath, OperatorInfo& op) {
+    // masamt-trace生成的二进制跟踪按访存序列统计步长
+    std::string content;
+    if (TraceReader::isTracePath(csvPath) && FileUtils::readFile(csvPath, content)) {
+        TraceReader::parse(opName, content, op);
+        return;
+    }
     op.getOperatorInfoFromCSV(opName, csvPath);
 }
 
@@ -73,14 +82,25 @@ void CSVHandler::writeAccessStrategyInternal(const std::string& opName, const st
     std::string csvFileName = "results/" + opName + ".csv";
     bool isNewFile = !fileExists(csvFileName);
     
+    // 选择对应的列定义
+    const std::vector<std::string>& columns = useLegacyFormat ? legacyColumns : genericColumns;
+    
+    // 旧版本写出的文件列不同，追加的行会与标题错位：原文件改名保留，重新创建
+    if (!isNewFile && checkedFiles.insert(csvFileName).second && !headerMatches(csvFileName, columns)) {
+        std::string oldFileName = csvFileName + ".old";
+        if (std::rename(csvFileName.c_str(), oldFileName.c_str()) == 0) {
+            std::cerr << "警告: " << csvFileName << " 的列与当前版本不一致，原文件已改名为 " << oldFileName << std::endl;
+        } else {
+            std::cerr << "警告: " << csvFileName << " 的列与当前版本不一致，已重写" << std::endl;
+        }
+        isNewFile = true;
+    }
+    
     // 使用wofstream实现UTF-8输出，配合二进制模式
     std::locale utf8Locale(std::locale(), new std::codecvt_utf8<wchar_t>());
     std::wofstream csvFile;
     csvFile.imbue(utf8Locale);
     
-    // 选择对应的列定义
-    const std::vector<std::string>& columns = useLegacyFormat ? legacyColumns : genericColumns;
-    
     if (isNewFile) {
         // 以二进制模式打开，防止自动行结束符转换
         csvFile.open(csvFileName, std::ios::binary);
@@ -116,7 +136,7 @@ void CSVHandler::writeAccessStrategyInternal(const std::string& opName, const st
         // 传统格式：包含计算负载列
         csvFile << utf8ToWide(dataset + "_DATASET") << L","              // 计算负载
                 << utf8ToWide(funcName) << L","                          // 核函数名
-                << utf8ToWide(featureVector.varName) << L","             // 变量名
+                << utf8ToWide(featureVector.varName.str()) << L","             // 变量名
                 << featureVector.C << L","                               // 预分配空间大小
                 << featureVector.S << L","                               // 数据块大小
                 << featureVector.N << L","                               // 访存次数
@@ -125,11 +145,11 @@ void CSVHandler::writeAccessStrategyInternal(const std::string& opName, const st
                 << std::fixed << std::setprecision(6) << locality << L","           // 访存空间局部性
                 << utf8ToWide(featureVector.accessStrategyConfig.getStrategyName()) << L","  // 访存策略名
                 << featureVector.accessStrategyConfig.line << L","                  // line参数
-                << featureVector.accessStrategyConfig.set;                          // set参数
+                << featureVector.accessStrategyConfig.set << L",";                  // set参数
     } else {
         // 通用格式：不包含计算负载列
         csvFile << utf8ToWide(funcName) << L","                          // 核函数名
-                << utf8ToWide(featureVector.varName) << L","             // 变量名
+                << utf8ToWide(featureVector.varName.str()) << L","             // 变量名
                 << featureVector.C << L","                               // 预分配空间大小
                 << featureVector.S << L","                               // 数据块大小
                 << featureVector.N << L","                               // 访存次数
@@ -138,8 +158,9 @@ void CSVHandler::writeAccessStrategyInternal(const std::string& opName, const st
                 << std::fixed << std::setprecision(6) << locality << L","           // 访存空间局部性
                 << utf8ToWide(featureVector.accessStrategyConfig.getStrategyName()) << L","  // 访存策略名
                 << featureVector.accessStrategyConfig.line << L","                  // line参数
-                << featureVector.accessStrategyConfig.set;                          // set参数
+                << featureVector.accessStrategyConfig.set << L",";                  // set参数
     }
+    writeAppendedColumns(csvFile, featureVector);
             
     // 使用显式的CRLF以获得最大兼容性
     csvFile << L"\r\n";
@@ -149,6 +170,36 @@ void CSVHandler::writeAccessStrategyInternal(const std::string& opName, const st
     csvFile.close();
 }
 
+void CSVHandler::writeAppendedColumns(std::wostream& csvFile, const AccessFeatureVector& featureVector) {
+    csvFile << featureVector.bufferingPlan.bufferCount << L","                  // 缓冲级数
+            << featureVector.bufferingPlan.bufferSize << L","                   // 缓冲区大小
+            << std::fixed << std::setprecision(4) << featureVector.bufferingPlan.getStallReduction() << L","  // 停顿降低比例
+            << utf8ToWide(StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[BULK])) << L","    // BULK代价
+            << utf8ToWide(StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[SINGLE])) << L","  // SINGLE代价
+            << utf8ToWide(StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[DIRECT])) << L","  // DIRECT代价
+            << featureVector.prefetchPlan.distance << L","                      // 预取距离
+            << featureVector.prefetchPlan.chunkSize;                            // 预取块大小
+}
+
+bool CSVHandler::headerMatches(const std::string& path, const std::vector<std::string>& columns) {
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    if (line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        line.erase(0, 3);
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    std::string expected;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        expected += (i == 0) ? columns[i] : "," + columns[i];
+    }
+    return line == expected;
+}
+
 // 将UTF-8字符串转换为宽字符串
 std::wstring CSVHandler::utf8ToWide(const std::string& str) {
     std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
@@ -0,0 +1,301 @@
+#include "CacheCodeGenerator.hpp"
+#include "DMAPipelineAdvisor.hpp"
+#include "FileUtils.hpp"
+#include "HardwareProfile.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+namespace
+{
+
+const char *const FILE_FIELDS[] = {"op",       "dataset", "function", "prefix",  "guard",         "alignment",
+                                   "sm_size",  "sm_total", "am_size", "am_total", "variable_count"};
+const char *const SECTIONS[] = {"variables", "vectors", "unsuitable"};
+const char *const VARIABLE_FIELDS[] = {"var",    "VAR",          "strategy",    "set",               "line",
+                                       "offset", "size",         "budget",      "buffer_count",      "buffer_size",
+                                       "prefetch_distance", "prefetch_chunk"};
+
+template <size_t Count> bool contains(const char *const (&names)[Count], const std::string &name)
+{
+    return std::find(names, names + Count, name) != names + Count;
+}
+
+std::string &templateStorage()
+{
+    static std::string text = CacheCodeGenerator::getBuiltinTemplate();
+    return text;
+}
+
+} // namespace
+
+CacheVariable::CacheVariable(const AccessFeatureVector &featureVector)
+    : name(featureVector.varName.str()), strategy(featureVector.accessStrategyConfig.accessStrategy),
+      set(featureVector.accessStrategyConfig.set), line(featureVector.accessStrategyConfig.line),
+      budget(featureVector.C), bufferCount(featureVector.bufferingPlan.bufferCount),
+      bufferSize(featureVector.bufferingPlan.bufferSize), prefetchDistance(featureVector.prefetchPlan.distance),
+      prefetchChunk(featureVector.prefetchPlan.chunkSize), memory(featureVector.memory)
+{
+    footprint = DMAPipelineAdvisor::getRegionSize(featureVector);
+}
+
+CacheCodeGenerator::CacheCodeGenerator()
+    : alignment(HardwareProfile::getInstance().smAlignment), smSize(HardwareProfile::getInstance().smSize),
+      amSize(HardwareProfile::getInstance().amSize), vectorWidth(HardwareProfile::getInstance().vectorWidth)
+{
+    std::string error;
+    parse(getDefaultTemplate(), tokens, error);
+}
+
+const std::string &CacheCodeGenerator::getBuiltinTemplate()
+{
+    static const std::string text = "/* MT-3000 cache configuration for {{op}}/{{dataset}}/{{function}}, generated by masamt */\n"
+                                    "#ifndef {{guard}}\n"
+                                    "#define {{guard}}\n"
+                                    "\n"
+                                    "#define {{prefix}}_SM_ALIGN {{alignment}}\n"
+                                    "#define {{prefix}}_SM_USED {{sm_total}}\n"
+                                    "\n"
+                                    "{{#variables}}\n"
+                                    "/* {{var}}: {{strategy}}, SM [{{offset}}, {{offset}} + {{size}}) of C = {{budget}} */\n"
+                                    "#define {{prefix}}_{{VAR}}_STRATEGY {{strategy}}\n"
+                                    "#define {{prefix}}_{{VAR}}_SET {{set}}\n"
+                                    "#define {{prefix}}_{{VAR}}_LINE {{line}}\n"
+                                    "#define {{prefix}}_{{VAR}}_SM_OFFSET {{offset}}\n"
+                                    "#define {{prefix}}_{{VAR}}_SM_SIZE {{size}}\n"
+                                    "#define {{prefix}}_{{VAR}}_BUFFERS {{buffer_count}}\n"
+                                    "#define {{prefix}}_{{VAR}}_BUFFER_SIZE {{buffer_size}}\n"
+                                    "#define {{prefix}}_{{VAR}}_PREFETCH_DISTANCE {{prefetch_distance}}\n"
+                                    "#define {{prefix}}_{{VAR}}_PREFETCH_CHUNK {{prefetch_chunk}}\n"
+                                    "\n"
+                                    "{{/variables}}\n"
+                                    "{{#vectors}}\n"
+                                    "/* {{var}}: {{strategy}}, AM [{{offset}}, {{offset}} + {{size}}) of C = {{budget}} */\n"
+                                    "#define {{prefix}}_{{VAR}}_STRATEGY {{strategy}}\n"
+                                    "#define {{prefix}}_{{VAR}}_LINE {{line}}\n"
+                                    "#define {{prefix}}_{{VAR}}_AM_OFFSET {{offset}}\n"
+                                    "#define {{prefix}}_{{VAR}}_AM_SIZE {{size}}\n"
+                                    "#define {{prefix}}_{{VAR}}_BUFFERS {{buffer_count}}\n"
+                                    "#define {{prefix}}_{{VAR}}_BUFFER_SIZE {{buffer_size}}\n"
+                                    "#define {{prefix}}_{{VAR}}_PREFETCH_DISTANCE {{prefetch_distance}}\n"
+                                    "#define {{prefix}}_{{VAR}}_PREFETCH_CHUNK {{prefetch_chunk}}\n"
+                                    "\n"
+                                    "{{/vectors}}\n"
+                                    "{{#unsuitable}}\n"
+                                    "/* {{var}}: not cached, accessed directly in DDR */\n"
+                                    "#define {{prefix}}_{{VAR}}_STRATEGY {{strategy}}\n"
+                                    "\n"
+                                    "{{/unsuitable}}\n"
+                                    "#if {{prefix}}_SM_USED > {{sm_size}}\n"
+                                    "#error \"{{prefix}}: SM regions exceed the SM size\"\n"
+                                    "#endif\n"
+                                    "\n"
+                                    "#endif /* {{guard}} */\n";
+    return text;
+}
+
+const std::string &CacheCodeGenerator::getDefaultTemplate() { return templateStorage(); }
+
+bool CacheCodeGenerator::loadDefaultTemplate(const std::string &path)
+{
+    std::string text, error;
+    if (!FileUtils::readFile(path, text)) {
+        std::cerr << "无法打开代码模板: " << path << std::endl;
+        return false;
+    }
+    std::vector<Token> parsed;
+    if (!parse(text, parsed, error)) {
+        std::cerr << "代码模板无效: " << path << ": " << error << std::endl;
+        return false;
+    }
+    templateStorage() = text;
+    return true;
+}
+
+bool CacheCodeGenerator::parse(const std::string &text, std::vector<Token> &tokens, std::string &error)
+{
+    tokens.clear();
+    size_t section = std::string::npos;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t open = text.find("{{", pos);
+        if (open == std::string::npos) {
+            open = text.size();
+        }
+        if (open > pos) {
+            Token token;
+            token.kind = Token::TEXT;
+            token.text = text.substr(pos, open - pos);
+            tokens.push_back(token);
+        }
+        if (open == text.size()) {
+            break;
+        }
+        size_t close = text.find("}}", open + 2);
+        if (close == std::string::npos) {
+            error = "unterminated '{{'";
+            return false;
+        }
+        std::string name = text.substr(open + 2, close - open - 2);
+        pos = close + 2;
+
+        if (!name.empty() && (name[0] == '#' || name[0] == '/')) {
+            std::string sectionName = name.substr(1);
+            if (!contains(SECTIONS, sectionName)) {
+                error = "unknown section '" + sectionName + "'";
+                return false;
+            }
+            if (name[0] == '#') {
+                if (section != std::string::npos) {
+                    error = "nested section '" + sectionName + "'";
+                    return false;
+                }
+                Token token;
+                token.kind = Token::SECTION;
+                token.text = sectionName;
+                section = tokens.size();
+                tokens.push_back(token);
+            } else {
+                if (section == std::string::npos || tokens[section].text != sectionName) {
+                    error = "unmatched '{{/" + sectionName + "}}'";
+                    return false;
+                }
+                tokens[section].end = tokens.size();
+                section = std::string::npos;
+            }
+            // 节标记后的换行不输出，使标记可以单独占一行
+            if (pos < text.size() && text[pos] == '\n') {
+                pos++;
+            }
+            continue;
+        }
+
+        bool known = contains(FILE_FIELDS, name) || (section != std::string::npos && contains(VARIABLE_FIELDS, name));
+        if (!known) {
+            error = "unknown field '" + name + "'";
+            return false;
+        }
+        Token token;
+        token.kind = Token::FIELD;
+        token.text = name;
+        tokens.push_back(token);
+    }
+    if (section != std::string::npos) {
+        error = "section '" + tokens[section].text + "' is not closed";
+        return false;
+    }
+    return true;
+}
+
+int CacheCodeGenerator::packOffsets(std::vector<CacheVariable> &variables, int alignment, TargetMemory memory)
+{
+    int used = 0;
+    for (auto &variable : variables) {
+        if (variable.memory != memory) {
+            continue;
+        }
+        if (variable.strategy == UNSUITABLE) {
+            variable.smOffset = 0;
+            continue;
+        }
+        variable.smOffset = (used + alignment - 1) / alignment * alignment;
+        used = variable.smOffset + variable.footprint;
+    }
+    return used;
+}
+
+std::string CacheCodeGenerator::toIdentifier(const std::string &name)
+{
+    std::string identifier;
+    for (char ch : name) {
+        identifier += std::isalnum(static_cast<unsigned char>(ch)) ? static_cast<char>(std::toupper(ch)) : '_';
+    }
+    if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier[0]))) {
+        identifier.insert(identifier.begin(), '_');
+    }
+    return identifier;
+}
+
+std::string CacheCodeGenerator::getFileName(const std::string &opName, const std::string &dataset,
+                                            const std::string &funcName)
+{
+    return opName + (dataset.empty() ? "" : "_" + dataset) + "_" + funcName + ".h";
+}
+
+bool CacheCodeGenerator::generate(const std::string &opName, const std::string &dataset, const std::string &funcName,
+                                  std::vector<CacheVariable> &variables, std::string &output,
+                                  std::string &error) const
+{
+    int used = packOffsets(variables, alignment);
+    if (used > smSize) {
+        error = "SM regions need " + std::to_string(used) + " bytes, SM size is " + std::to_string(smSize);
+        return false;
+    }
+    int amUsed = packOffsets(variables, std::max(alignment, vectorWidth), MEMORY_AM);
+    if (amUsed > amSize) {
+        error = "AM regions need " + std::to_string(amUsed) + " bytes, AM size is " + std::to_string(amSize);
+        return false;
+    }
+
+    FieldMap fileFields;
+    std::string prefix = toIdentifier(opName + (dataset.empty() ? "" : "_" + dataset) + "_" + funcName);
+    fileFields["op"] = opName;
+    fileFields["dataset"] = dataset;
+    fileFields["function"] = funcName;
+    fileFields["prefix"] = prefix;
+    fileFields["guard"] = prefix + "_CACHE_CONFIG_H";
+    fileFields["alignment"] = std::to_string(alignment);
+    fileFields["sm_size"] = std::to_string(smSize);
+    fileFields["sm_total"] = std::to_string(used);
+    fileFields["am_size"] = std::to_string(amSize);
+    fileFields["am_total"] = std::to_string(amUsed);
+
+    SectionMap sections;
+    std::vector<FieldMap> &cached = sections["variables"];
+    for (const auto &variable : variables) {
+        FieldMap fields;
+        fields["var"] = variable.name;
+        fields["VAR"] = toIdentifier(variable.name);
+        fields["strategy"] = AccessStrategyConfig(variable.strategy).getStrategyName();
+        fields["set"] = std::to_string(variable.set);
+        fields["line"] = std::to_string(variable.line);
+        fields["offset"] = std::to_string(variable.smOffset);
+        fields["size"] = std::to_string((variable.usesSM() || variable.usesAM()) ? variable.footprint : 0);
+        fields["budget"] = std::to_string(variable.budget);
+        fields["buffer_count"] = std::to_string(variable.bufferCount);
+        fields["buffer_size"] = std::to_string(variable.bufferSize);
+        fields["prefetch_distance"] = std::to_string(variable.prefetchDistance);
+        fields["prefetch_chunk"] = std::to_string(variable.prefetchChunk);
+        sections[variable.usesSM() ? "variables" : (variable.usesAM() ? "vectors" : "unsuitable")].push_back(fields);
+    }
+    fileFields["variable_count"] = std::to_string(cached.size());
+
+    output.clear();
+    render(0, tokens.size(), fileFields, nullptr, sections, output);
+    return true;
+}
+
+void CacheCodeGenerator::render(size_t begin, size_t end, const FieldMap &fileFields, const FieldMap *variableFields,
+                                const SectionMap &sections, std::string &output) const
+{
+    for (size_t i = begin; i < end; i++) {
+        const Token &token = tokens[i];
+        if (token.kind == Token::TEXT) {
+            output += token.text;
+        } else if (token.kind == Token::FIELD) {
+            auto it = (variableFields != nullptr) ? variableFields->find(token.text) : fileFields.end();
+            if (variableFields == nullptr || it == variableFields->end()) {
+                it = fileFields.find(token.text);
+            }
+            output += it->second;
+        } else {
+            auto section = sections.find(token.text);
+            if (section != sections.end()) {
+                for (const auto &fields : section->second) {
+                    render(i + 1, token.end, fileFields, &fields, sections, output);
+                }
+            }
+            i = token.end - 1;
+        }
+    }
+}
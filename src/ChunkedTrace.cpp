@@ -0,0 +1,442 @@
+#include "ChunkedTrace.hpp"
+#include "FileUtils.hpp"
+#include "ParallelFor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+
+namespace
+{
+
+const char CHUNKED_MAGIC[8] = {'M', 'A', 'S', 'A', 'M', 'T', 'C', '\0'};
+
+inline void appendVarint(std::string &out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// 解码一个varint，数据不完整时返回false
+inline bool readVarint(const unsigned char *&pos, const unsigned char *end, uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end) {
+            return false;
+        }
+        unsigned char byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint64_t zigzagEncode(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+inline int64_t zigzagDecode(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+// 转换中的单个(线程, 变量)访问序列
+class PendingStream
+{
+public:
+    std::vector<uint64_t> addresses;
+    // 已写出部分的最后一个地址
+    uint64_t previousAddress = 0;
+};
+
+class VariableDefinition
+{
+public:
+    MasamtTrace::TraceVariableRecord record;
+    std::string kernel;
+    std::string name;
+};
+
+// 步长换算：元素长度为2的幂时用移位代替除法，结果相同
+class StrideScale
+{
+public:
+    explicit StrideScale(uint32_t elementSize) : divisor(std::max(1u, elementSize))
+    {
+        shift = -1;
+        if ((divisor & (divisor - 1)) == 0) {
+            shift = 0;
+            while ((1ull << shift) < divisor) {
+                shift++;
+            }
+        }
+    }
+    uint64_t apply(uint64_t distance) const { return (shift >= 0) ? distance >> shift : distance / divisor; }
+
+private:
+    uint64_t divisor;
+    int shift;
+};
+
+bool decodeChunk(const unsigned char *data, const ChunkIndexEntry &entry, const StrideScale &scale,
+                 MasamtTrace::StrideHistogram &strides)
+{
+    const unsigned char *pos = data + entry.offset;
+    const unsigned char *end = pos + entry.length;
+    uint64_t last = entry.previousAddress;
+    for (uint32_t i = 0; i < entry.count; i++) {
+        uint64_t encoded;
+        if (!readVarint(pos, end, encoded)) {
+            return false;
+        }
+        int64_t delta = zigzagDecode(encoded);
+        if (last != 0) {
+            uint64_t distance = (delta < 0) ? 0 - static_cast<uint64_t>(delta) : static_cast<uint64_t>(delta);
+            strides.add(static_cast<int64_t>(scale.apply(distance)));
+        }
+        last += static_cast<uint64_t>(delta);
+    }
+    return pos == end;
+}
+
+// 解码一个块的地址序列，交给reuse分析
+bool reuseChunk(const unsigned char *data, const ChunkIndexEntry &entry, ReuseDistanceAnalyzer &analyzer)
+{
+    const unsigned char *pos = data + entry.offset;
+    const unsigned char *end = pos + entry.length;
+    uint64_t address = entry.previousAddress;
+    for (uint32_t i = 0; i < entry.count; i++) {
+        uint64_t encoded;
+        if (!readVarint(pos, end, encoded)) {
+            return false;
+        }
+        address += static_cast<uint64_t>(zigzagDecode(encoded));
+        analyzer.access(address);
+    }
+    return true;
+}
+
+} // namespace
+
+bool ChunkedTrace::isChunkedTrace(const std::string &content)
+{
+    return content.size() >= sizeof(ChunkedTraceHeader) && memcmp(content.data(), CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC)) == 0;
+}
+
+bool ChunkedTrace::isChunkedTracePath(const std::string &path)
+{
+    const std::string extension = ".mtc";
+    return path.size() > extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+uint64_t ChunkedTrace::getAddressCount(const std::string &content)
+{
+    if (!isChunkedTrace(content)) {
+        return 0;
+    }
+    ChunkedTraceHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    return header.addressCount;
+}
+
+bool ChunkedTrace::convert(const std::string &rawPath, const std::string &outPath, ConvertStats &stats)
+{
+    using namespace MasamtTrace;
+    stats = ConvertStats();
+    std::ifstream in(rawPath, std::ios::binary);
+    TraceFileHeader rawHeader;
+    if (!in.read(reinterpret_cast<char *>(&rawHeader), sizeof(rawHeader)) ||
+        memcmp(rawHeader.magic, TRACE_MAGIC, sizeof(rawHeader.magic)) != 0 || rawHeader.version != TRACE_VERSION) {
+        return false;
+    }
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    ChunkedTraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHUNKED_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    uint64_t offset = sizeof(header);
+    stats.rawBytes = sizeof(rawHeader);
+
+    std::map<uint32_t, VariableDefinition> definitions;
+    std::map<std::pair<uint32_t, uint32_t>, PendingStream> streams;
+    std::vector<ChunkIndexEntry> index;
+    std::string payload;
+
+    auto writeChunk = [&](uint32_t thread, uint32_t variable, PendingStream &stream) {
+        payload.clear();
+        uint64_t last = stream.previousAddress;
+        for (uint64_t address : stream.addresses) {
+            appendVarint(payload, zigzagEncode(static_cast<int64_t>(address - last)));
+            last = address;
+        }
+        ChunkIndexEntry entry;
+        entry.offset = offset;
+        entry.previousAddress = stream.previousAddress;
+        entry.length = static_cast<uint32_t>(payload.size());
+        entry.count = static_cast<uint32_t>(stream.addresses.size());
+        entry.variable = variable;
+        entry.thread = thread;
+        index.push_back(entry);
+        out.write(payload.data(), payload.size());
+        offset += payload.size();
+        stats.addresses += stream.addresses.size();
+        stream.previousAddress = last;
+        stream.addresses.clear();
+    };
+
+    std::vector<uint64_t> block;
+    uint32_t tag;
+    while (in.read(reinterpret_cast<char *>(&tag), sizeof(tag))) {
+        if (tag == TRACE_VARIABLE) {
+            VariableDefinition definition;
+            definition.record.tag = tag;
+            if (!in.read(reinterpret_cast<char *>(&definition.record) + sizeof(tag), sizeof(definition.record) - sizeof(tag))) {
+                return false;
+            }
+            definition.kernel.resize(definition.record.kernelLength);
+            definition.name.resize(definition.record.nameLength);
+            if (!in.read(&definition.kernel[0], definition.kernel.size()) || !in.read(&definition.name[0], definition.name.size())) {
+                return false;
+            }
+            stats.rawBytes += sizeof(definition.record) + definition.kernel.size() + definition.name.size();
+            definitions[definition.record.id] = definition;
+        } else if (tag == TRACE_BLOCK) {
+            TraceBlockRecord record;
+            record.tag = tag;
+            if (!in.read(reinterpret_cast<char *>(&record) + sizeof(tag), sizeof(record) - sizeof(tag))) {
+                return false;
+            }
+            // 与原始跟踪的读取一致：变量定义必须在其第一个地址块之前
+            auto definition = definitions.find(record.variable);
+            if (definition == definitions.end() || definition->second.name.empty()) {
+                return false;
+            }
+            block.resize(record.count);
+            if (!in.read(reinterpret_cast<char *>(block.data()), record.count * sizeof(uint64_t))) {
+                return false;
+            }
+            stats.rawBytes += sizeof(record) + record.count * sizeof(uint64_t);
+            PendingStream &stream = streams[std::make_pair(record.thread, record.variable)];
+            for (uint64_t address : block) {
+                stream.addresses.push_back(address);
+                if (stream.addresses.size() == CHUNK_ADDRESSES) {
+                    writeChunk(record.thread, record.variable, stream);
+                }
+            }
+        } else {
+            // 抽样跟踪（TRACE_SAMPLING）的样本并非连续访问，分块后无法独立解码，不支持转换
+            return false;
+        }
+    }
+    if (!in.eof() || in.gcount() != 0) {
+        return false;
+    }
+    for (auto &stream : streams) {
+        if (!stream.second.addresses.empty()) {
+            writeChunk(stream.first.first, stream.first.second, stream.second);
+        }
+    }
+
+    header.variablesOffset = offset;
+    for (const auto &definition : definitions) {
+        out.write(reinterpret_cast<const char *>(&definition.second.record), sizeof(definition.second.record));
+        out.write(definition.second.kernel.data(), definition.second.kernel.size());
+        out.write(definition.second.name.data(), definition.second.name.size());
+        offset += sizeof(definition.second.record) + definition.second.kernel.size() + definition.second.name.size();
+    }
+    header.indexOffset = offset;
+    out.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(ChunkIndexEntry));
+    offset += index.size() * sizeof(ChunkIndexEntry);
+
+    header.variableCount = static_cast<uint32_t>(definitions.size());
+    header.chunkCount = index.size();
+    header.addressCount = stats.addresses;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+
+    stats.chunks = index.size();
+    stats.compressedBytes = offset;
+    return !out.fail();
+}
+
+bool ChunkedTrace::decode(const std::string &content, unsigned int jobs, std::vector<TraceVariable> &variables,
+                          uint64_t reuseSampleRate)
+{
+    using namespace MasamtTrace;
+    variables.clear();
+    if (!isChunkedTrace(content)) {
+        return false;
+    }
+    ChunkedTraceHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    if (header.version != VERSION || header.variablesOffset > header.indexOffset || header.indexOffset > content.size() ||
+        (content.size() - header.indexOffset) / sizeof(ChunkIndexEntry) < header.chunkCount) {
+        return false;
+    }
+
+    size_t pos = header.variablesOffset;
+    for (uint32_t v = 0; v < header.variableCount; v++) {
+        TraceVariableRecord record;
+        if (header.indexOffset - pos < sizeof(record)) {
+            return false;
+        }
+        memcpy(&record, content.data() + pos, sizeof(record));
+        pos += sizeof(record);
+        if (header.indexOffset - pos < static_cast<size_t>(record.kernelLength) + record.nameLength) {
+            return false;
+        }
+        if (record.id >= variables.size()) {
+            variables.resize(record.id + 1);
+        }
+        TraceVariable &variable = variables[record.id];
+        variable.kernel.assign(content.data() + pos, record.kernelLength);
+        variable.name.assign(content.data() + pos + record.kernelLength, record.nameLength);
+        variable.size = record.size;
+        variable.elementSize = std::max(1u, record.elementSize);
+        pos += record.kernelLength + record.nameLength;
+    }
+
+    std::vector<ChunkIndexEntry> index(header.chunkCount);
+    memcpy(index.data(), content.data() + header.indexOffset, index.size() * sizeof(ChunkIndexEntry));
+    for (const auto &entry : index) {
+        if (entry.offset > header.variablesOffset || header.variablesOffset - entry.offset < entry.length ||
+            entry.variable >= variables.size() || variables[entry.variable].name.empty()) {
+            return false;
+        }
+    }
+    std::vector<StrideScale> scales;
+    for (const auto &variable : variables) {
+        scales.push_back(StrideScale(variable.elementSize));
+    }
+
+    // 每个任务解码一段连续的块并累计到自己的直方图，最后合并
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t taskCount = std::min<size_t>(index.size(), static_cast<size_t>(jobs) * 4);
+    std::vector<std::vector<StrideHistogram>> taskStrides(taskCount);
+    std::vector<char> taskValid(taskCount, 1);
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(content.data());
+    parallelFor(taskCount, jobs, [&](size_t task) {
+        std::vector<StrideHistogram> &strides = taskStrides[task];
+        strides.resize(variables.size());
+        size_t begin = index.size() * task / taskCount;
+        size_t end = index.size() * (task + 1) / taskCount;
+        for (size_t i = begin; i < end && taskValid[task]; i++) {
+            const ChunkIndexEntry &entry = index[i];
+            taskValid[task] = decodeChunk(data, entry, scales[entry.variable], strides[entry.variable]);
+        }
+    });
+    if (std::find(taskValid.begin(), taskValid.end(), 0) != taskValid.end()) {
+        return false;
+    }
+    for (const auto &entry : index) {
+        variables[entry.variable].accesses += entry.count;
+    }
+    if (reuseSampleRate > 0 && !decodeReuse(data, index, jobs, reuseSampleRate, variables)) {
+        return false;
+    }
+    for (const auto &strides : taskStrides) {
+        for (size_t v = 0; v < variables.size(); v++) {
+            variables[v].strides.merge(strides[v]);
+        }
+    }
+    return true;
+}
+
+bool ChunkedTrace::decodeReuse(const unsigned char *data, const std::vector<ChunkIndexEntry> &index, unsigned int jobs,
+                               uint64_t reuseSampleRate, std::vector<TraceVariable> &variables)
+{
+    // 重用距离须按访问顺序计算，按(线程, 变量)分组后各序列并行，序列内的块按索引顺序解码
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < index.size(); i++) {
+        groups[std::make_pair(index[i].thread, index[i].variable)].push_back(i);
+    }
+    std::vector<const std::vector<size_t> *> streams;
+    for (const auto &group : groups) {
+        streams.push_back(&group.second);
+    }
+    std::vector<ReuseHistogram> histograms(streams.size());
+    std::vector<char> valid(streams.size(), 1);
+    parallelFor(streams.size(), jobs, [&](size_t stream) {
+        ReuseDistanceAnalyzer analyzer(reuseSampleRate);
+        for (size_t chunk : *streams[stream]) {
+            if (!reuseChunk(data, index[chunk], analyzer)) {
+                valid[stream] = 0;
+                return;
+            }
+        }
+        histograms[stream] = analyzer.getHistogram();
+    });
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end()) {
+        return false;
+    }
+    for (size_t stream = 0; stream < streams.size(); stream++) {
+        TraceVariable &variable = variables[index[streams[stream]->front()].variable];
+        variable.reuse.merge(histograms[stream]);
+        variable.reuse.elementSize = variable.elementSize;
+    }
+    return true;
+}
+
+int ChunkedTrace::runBenchmark(const std::string &path, unsigned int jobs, std::ostream &os)
+{
+    std::string content;
+    if (!FileUtils::readFile(path, content)) {
+        std::cerr << "无法打开跟踪文件: " << path << std::endl;
+        return 1;
+    }
+    if (!isChunkedTrace(content)) {
+        std::cerr << "不是分块压缩跟踪（请先用--convert-trace转换）: " << path << std::endl;
+        return 1;
+    }
+    ChunkedTraceHeader header;
+    memcpy(&header, content.data(), sizeof(header));
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // 原始格式每个地址8字节，另加每TRACE_BLOCK_ADDRESSES个地址一个块头
+    double rawBytes = header.addressCount * 8.0 +
+                      static_cast<double>(header.addressCount) / MasamtTrace::TRACE_BLOCK_ADDRESSES *
+                          sizeof(MasamtTrace::TraceBlockRecord);
+    os << "Trace " << path << ": " << header.addressCount << " addresses, " << header.chunkCount << " chunks, "
+       << std::fixed << std::setprecision(2) << content.size() / 1e6 << " MB (" << content.size() * 8.0 / std::max<uint64_t>(1, header.addressCount)
+       << " bits/address, " << std::setprecision(1) << rawBytes / content.size() << "x smaller than raw)\n";
+    os << "  " << std::setw(8) << "threads" << std::setw(12) << "seconds" << std::setw(12) << "MB/s"
+       << std::setw(16) << "Maddr/s" << "\n";
+
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < jobs; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(jobs);
+    for (unsigned int threads : threadCounts) {
+        // 取三次中最快的一次
+        double best = 0;
+        for (int run = 0; run < 3; run++) {
+            std::vector<TraceVariable> variables;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (!decode(content, threads, variables)) {
+                std::cerr << "跟踪文件格式不正确: " << path << std::endl;
+                return 1;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = (run == 0) ? seconds : std::min(best, seconds);
+        }
+        os << "  " << std::setw(8) << threads << std::setw(12) << std::setprecision(4) << best << std::setw(12)
+           << std::setprecision(1) << content.size() / 1e6 / best << std::setw(16) << header.addressCount / 1e6 / best
+           << "\n";
+    }
+    os.flush();
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "DMAPipelineAdvisor.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+double DMAPipelineAdvisor::pipelinedStall(const AccessFeatureVector &featureVector, int chunk, int bufferCount,
+                                          const HardwareProfile &profile)
+{
+    double transfers = std::ceil(static_cast<double>(featureVector.S) / chunk);
+    // 单块传输周期与该块数据上的计算周期（访存密度D为每字节访问次数）
+    double dma = profile.dmaCycles(chunk);
+    double compute = featureVector.D * chunk * profile.computeCyclesPerAccess;
+    // 首块传输无法被隐藏；稳态下k-1个在途传输掩盖延迟，但总吞吐仍受DMA带宽限制
+    double latencyStall = dma - (bufferCount - 1) * compute;
+    double bandwidthStall = chunk / profile.dmaBandwidth - compute;
+    double steadyStall = std::max(0.0, std::max(latencyStall, bandwidthStall));
+    return dma + (transfers - 1) * steadyStall;
+}
+
+BufferingPlan DMAPipelineAdvisor::planSingle(const AccessFeatureVector &featureVector, int spareSpace,
+                                             const HardwareProfile &profile)
+{
+    BufferingPlan plan;
+    int line = featureVector.accessStrategyConfig.line;
+    int footprint = featureVector.accessStrategyConfig.getSMFootprint();
+    plan.bufferSize = footprint;
+    plan.stallCycles = std::ceil(static_cast<double>(featureVector.S) / footprint) * profile.dmaCycles(footprint);
+    plan.pipelinedStallCycles = plan.stallCycles;
+    if (line < MIN_BUFFER_LINE) {
+        return plan;
+    }
+
+    // 候选方案：缓冲区个数2~3，块大小从原line逐级减半；既可申请额外空间，也可在原区域内切分
+    int bestSpace = footprint;
+    for (int bufferCount = 2; bufferCount <= 3; bufferCount++) {
+        for (int chunkLine = line; chunkLine >= MIN_BUFFER_LINE; chunkLine--) {
+            int chunk = 1 << chunkLine;
+            int space = bufferCount * chunk;
+            if (space > footprint + spareSpace) {
+                continue;
+            }
+            double stall = pipelinedStall(featureVector, chunk, bufferCount, profile);
+            // 停顿收益不足1%时优先选择占用空间更小的方案
+            double margin = 0.01 * plan.stallCycles;
+            bool better = stall < plan.pipelinedStallCycles - margin ||
+                          (stall <= plan.pipelinedStallCycles + margin && plan.bufferCount > 1 && space < bestSpace);
+            if (better) {
+                plan.bufferCount = bufferCount;
+                plan.bufferSize = chunk;
+                plan.pipelinedStallCycles = stall;
+                bestSpace = space;
+            }
+        }
+    }
+    return plan;
+}
+
+PrefetchPlan DMAPipelineAdvisor::planPrefetch(const AccessFeatureVector &featureVector, int spareSpace,
+                                              const HardwareProfile &profile)
+{
+    PrefetchPlan plan;
+    if (featureVector.patterns.empty() || featureVector.N == 0) {
+        return plan;
+    }
+    // 主导步长：占比最大的访存模式，须为较小的非零步长
+    auto dominant = std::max_element(
+        featureVector.patterns.begin(), featureVector.patterns.end(),
+        [](const std::pair<int, double> &a, const std::pair<int, double> &b) { return a.second < b.second; });
+    int stride = std::abs(dominant->first);
+    double share = dominant->second;
+    if (stride == 0 || stride > MAX_PREFETCH_STRIDE || share < MIN_STREAM_SHARE) {
+        return plan;
+    }
+    double strideBytes = static_cast<double>(stride) * profile.elementSize;
+
+    // 不预取时按line逐行缺失载入
+    int line = featureVector.accessStrategyConfig.line;
+    int region = getRegionSize(featureVector);
+    int lineBytes = AccessStrategyConfig::calculateLineSpace(line);
+    double lineAccesses = std::min(featureVector.D * lineBytes, lineBytes / (strideBytes * share));
+    plan.stallCycles = std::ceil(featureVector.N / std::max(1.0, lineAccesses)) * profile.dmaCycles(lineBytes);
+    plan.prefetchStallCycles = plan.stallCycles;
+
+    // 环形区域至少两个最小块，放不下时不预取
+    int available = region + spareSpace;
+    if (available < (2 << MIN_BUFFER_LINE)) {
+        return plan;
+    }
+    // 数据块大小可能超过int范围，块大小本就受环形区域限制，截断到INT_MAX即可
+    int blockSize = static_cast<int>(std::max(1ULL, std::min<unsigned long long>(featureVector.S, INT_MAX)));
+    int maxLine = std::min(static_cast<int>(std::floor(std::log2(available / 2))),
+                           AccessStrategyConfig::getLineBasedOnSize(blockSize));
+    int bestRing = 0;
+    for (int chunkLine = MIN_BUFFER_LINE; chunkLine <= maxLine; chunkLine++) {
+        int chunk = 1 << chunkLine;
+        // 每块上的访问次数：流式前进chunk字节所需的访问，未完整遍历变量时以D×chunk为上限
+        double accesses = std::max(1.0, std::min(featureVector.D * chunk, chunk / (strideBytes * share)));
+        double compute = accesses * profile.computeCyclesPerAccess;
+        double dma = profile.dmaCycles(chunk);
+        int distance = std::max(1, static_cast<int>(std::ceil(dma / compute)));
+        distance = std::min(distance, available / chunk - 1);
+        if (distance < 1) {
+            continue;
+        }
+        // 首块无法隐藏；稳态下distance个在途传输掩盖延迟，吞吐仍受DMA带宽限制
+        double transfers = std::ceil(featureVector.N / accesses);
+        double steadyStall = std::max(0.0, std::max(dma - distance * compute, chunk / profile.dmaBandwidth - compute));
+        double stall = dma + (transfers - 1) * steadyStall;
+        int ring = (distance + 1) * chunk;
+        double margin = 0.01 * plan.stallCycles;
+        bool better = stall < plan.prefetchStallCycles - margin ||
+                      (stall <= plan.prefetchStallCycles + margin && plan.isEnabled() && ring < bestRing);
+        if (better) {
+            plan.distance = distance;
+            plan.chunkSize = chunk;
+            plan.prefetchStallCycles = stall;
+            bestRing = ring;
+        }
+    }
+    return plan;
+}
+
+BufferingPlan DMAPipelineAdvisor::planBulk(const AccessFeatureVector &featureVector, const HardwareProfile &profile)
+{
+    BufferingPlan plan;
+    int footprint = featureVector.accessStrategyConfig.getSMFootprint();
+    plan.bufferSize = footprint;
+    plan.stallCycles = profile.dmaCycles(footprint);
+    plan.pipelinedStallCycles = plan.stallCycles;
+    if (footprint < 2 * (1 << MIN_BUFFER_LINE)) {
+        return plan;
+    }
+
+    // 整块加载改为分块流水，块在变量自身的BULK区域内轮转，不需要额外SM空间
+    int maxLine = static_cast<int>(std::floor(std::log2(footprint / 2)));
+    for (int bufferCount = 2; bufferCount <= 3; bufferCount++) {
+        for (int chunkLine = maxLine; chunkLine >= MIN_BUFFER_LINE; chunkLine--) {
+            int chunk = 1 << chunkLine;
+            if (bufferCount * chunk > footprint) {
+                continue;
+            }
+            double stall = pipelinedStall(featureVector, chunk, bufferCount, profile);
+            if (stall < plan.pipelinedStallCycles - 0.01 * plan.stallCycles) {
+                plan.bufferCount = bufferCount;
+                plan.bufferSize = chunk;
+                plan.pipelinedStallCycles = stall;
+            }
+        }
+    }
+    return plan;
+}
+
+void DMAPipelineAdvisor::adviseBuffering(FeatureVectorList &accessFeatureVectors, int C_total,
+                                         const HardwareProfile &profile)
+{
+    // 统计各策略实际占用后剩余的SM空间
+    int remaining = C_total;
+    for (const auto &featureVector : accessFeatureVectors) {
+        remaining -= featureVector.accessStrategyConfig.getSMFootprint();
+    }
+    remaining = std::max(0, remaining);
+
+    // 先在不限额外空间的条件下评估SINGLE变量的收益，据此决定剩余空间的分配顺序
+    std::vector<std::pair<double, size_t>> singles;
+    for (size_t i = 0; i < accessFeatureVectors.size(); i++) {
+        AccessFeatureVector &featureVector = accessFeatureVectors[i];
+        featureVector.bufferingPlan = BufferingPlan();
+        if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::BULK) {
+            featureVector.bufferingPlan = planBulk(featureVector, profile);
+        } else if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::SINGLE) {
+            BufferingPlan ideal = planSingle(featureVector, C_total, profile);
+            singles.push_back(std::make_pair(ideal.stallCycles - ideal.pipelinedStallCycles, i));
+        }
+    }
+    std::sort(singles.begin(), singles.end(),
+              [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) { return a.first > b.first; });
+
+    for (const auto &single : singles) {
+        AccessFeatureVector &featureVector = accessFeatureVectors[single.second];
+        featureVector.bufferingPlan = planSingle(featureVector, remaining, profile);
+        int extra = featureVector.bufferingPlan.bufferCount * featureVector.bufferingPlan.bufferSize -
+                    featureVector.accessStrategyConfig.getSMFootprint();
+        remaining -= std::max(0, extra);
+    }
+}
+
+void DMAPipelineAdvisor::advisePrefetch(FeatureVectorList &accessFeatureVectors, int C_total,
+                                        const HardwareProfile &profile)
+{
+    // 多缓冲分配之后剩余的SM空间
+    std::vector<std::pair<double, size_t>> singles;
+    int remaining = C_total;
+    for (size_t i = 0; i < accessFeatureVectors.size(); i++) {
+        AccessFeatureVector &featureVector = accessFeatureVectors[i];
+        featureVector.prefetchPlan = PrefetchPlan();
+        remaining -= getRegionSize(featureVector);
+        if (featureVector.accessStrategyConfig.accessStrategy == AccessStrategy::SINGLE) {
+            PrefetchPlan ideal = planPrefetch(featureVector, C_total, profile);
+            if (ideal.isEnabled()) {
+                singles.push_back(std::make_pair(ideal.stallCycles - ideal.prefetchStallCycles, i));
+            }
+        }
+    }
+    remaining = std::max(0, remaining);
+    std::sort(singles.begin(), singles.end(),
+              [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) { return a.first > b.first; });
+
+    for (const auto &single : singles) {
+        AccessFeatureVector &featureVector = accessFeatureVectors[single.second];
+        PrefetchPlan plan = planPrefetch(featureVector, remaining, profile);
+        // 预取环形区域与多缓冲是同一区域的两种用法，只保留停顿降低比例更高的一种
+        if (!plan.isEnabled() || plan.getStallReduction() <= featureVector.bufferingPlan.getStallReduction()) {
+            continue;
+        }
+        int region = getRegionSize(featureVector);
+        featureVector.prefetchPlan = plan;
+        featureVector.bufferingPlan.bufferCount = 1;
+        featureVector.bufferingPlan.bufferSize = featureVector.accessStrategyConfig.getSMFootprint();
+        featureVector.bufferingPlan.pipelinedStallCycles = featureVector.bufferingPlan.stallCycles;
+        remaining -= getRegionSize(featureVector) - region;
+    }
+}
+
+int DMAPipelineAdvisor::getRegionSize(const AccessFeatureVector &featureVector)
+{
+    int region = std::max(0, featureVector.accessStrategyConfig.getSMFootprint());
+    // SINGLE策略的多缓冲、预取可能申请超出原footprint的空间，BULK的多缓冲在自身区域内轮转
+    if (featureVector.accessStrategyConfig.accessStrategy == SINGLE) {
+        if (featureVector.bufferingPlan.bufferCount > 1) {
+            region = std::max(region, featureVector.bufferingPlan.bufferCount * featureVector.bufferingPlan.bufferSize);
+        }
+        if (featureVector.prefetchPlan.isEnabled()) {
+            region = std::max(region, featureVector.prefetchPlan.getRingSize());
+        }
+    }
+    return region;
+}
@@ -0,0 +1,215 @@
+#include "DirectPlacement.hpp"
+#include "CacheCodeGenerator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+
+namespace
+{
+
+std::atomic<bool> &enabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+/**
+ * @brief 按步长直方图合成的元素下标序列
+ *
+ * 各步长按占比平滑加权轮转选取；占比最大的步长连续前进，其余步长不超过本段已前进的距离时向后跳转
+ * （如按行遍历时回到行首、按列遍历时回到下一列的顶部），否则向前；未被步长覆盖的占比为伪随机访问。
+ */
+class SyntheticStream
+{
+public:
+    SyntheticStream(const AccessPatterns &patterns, uint64_t elements) : elements(std::max<uint64_t>(1, elements))
+    {
+        double covered = 0.0;
+        for (const auto &pattern : patterns) {
+            strides.push_back(static_cast<uint64_t>(std::abs(static_cast<long long>(pattern.first))));
+            weights.push_back(pattern.second);
+            covered += pattern.second;
+        }
+        dominant = std::max_element(weights.begin(), weights.end()) - weights.begin();
+        // 最后一个选项为随机访问
+        strides.push_back(0);
+        weights.push_back(std::max(0.0, 1.0 - covered));
+        credits.assign(weights.size(), 0.0);
+    }
+
+    uint64_t next()
+    {
+        size_t choice = 0;
+        for (size_t i = 0; i < weights.size(); i++) {
+            credits[i] += weights[i];
+            if (credits[i] > credits[choice]) {
+                choice = i;
+            }
+        }
+        credits[choice] -= 1.0;
+        uint64_t stride = strides[choice] % elements;
+        if (choice + 1 == weights.size()) {
+            random = random * 6364136223846793005ull + 1442695040888963407ull;
+            index = (random >> 33) % elements;
+            run = 0;
+        } else if (choice == dominant) {
+            index = (index + stride) % elements;
+            run += stride;
+        } else {
+            index = (stride <= run) ? index + elements - stride : index + stride;
+            index %= elements;
+            run = 0;
+        }
+        return index;
+    }
+
+private:
+    std::vector<uint64_t> strides;
+    std::vector<double> weights;
+    std::vector<double> credits;
+    size_t dominant = 0;
+    uint64_t elements;
+    uint64_t index = 0;
+    uint64_t run = 0;
+    uint64_t random = 1;
+};
+
+} // namespace
+
+bool PlacementMap::hasDirect() const
+{
+    for (const auto &variable : variables) {
+        if (variable.strategy == DIRECT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DirectPlacement::isEnabled() { return enabledStorage().load(); }
+
+void DirectPlacement::setEnabled(bool enabled) { enabledStorage().store(enabled); }
+
+double DirectPlacement::simulate(const AccessFeatureVector &featureVector, const ArrayShape &shape, int set, int line,
+                                 uint64_t padElements, int elementSize)
+{
+    uint64_t accesses = std::min(static_cast<uint64_t>(featureVector.N), static_cast<uint64_t>(SIMULATION_ACCESSES));
+    if (accesses == 0) {
+        return 0.0;
+    }
+    std::vector<uint64_t> tags(static_cast<size_t>(1) << set, ~0ull);
+    uint64_t setMask = tags.size() - 1;
+    uint64_t paddedCols = shape.cols + padElements;
+    SyntheticStream stream(featureVector.patterns, shape.rows * shape.cols);
+    uint64_t misses = 0;
+    for (uint64_t i = 0; i < accesses; i++) {
+        uint64_t element = stream.next();
+        uint64_t address = (shape.rows > 1) ? (element / shape.cols * paddedCols + element % shape.cols) * elementSize
+                                            : element * elementSize;
+        uint64_t lineId = address >> line;
+        uint64_t &tag = tags[lineId & setMask];
+        if (tag != lineId) {
+            tag = lineId;
+            misses++;
+        }
+    }
+    return static_cast<double>(misses) / accesses;
+}
+
+PlacementMap DirectPlacement::place(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                                    const HardwareProfile &profile)
+{
+    PlacementMap map;
+    map.funcName = funcName;
+    std::vector<CacheVariable> regions;
+    for (const auto &featureVector : accessFeatureVectors) {
+        regions.push_back(CacheVariable(featureVector));
+    }
+    map.smUsed = CacheCodeGenerator::packOffsets(regions, profile.smAlignment);
+    CacheCodeGenerator::packOffsets(regions, std::max(profile.smAlignment, profile.vectorWidth), MEMORY_AM);
+
+    for (size_t i = 0; i < regions.size(); i++) {
+        const AccessFeatureVector &featureVector = accessFeatureVectors[i];
+        VariablePlacement placement;
+        placement.name = regions[i].name;
+        placement.strategy = regions[i].strategy;
+        placement.set = regions[i].set;
+        placement.line = regions[i].line;
+        placement.memory = regions[i].memory;
+        placement.smOffset = regions[i].smOffset;
+        placement.footprint = (regions[i].usesSM() || regions[i].usesAM()) ? regions[i].footprint : 0;
+        if (placement.strategy == DIRECT) {
+            placement.shape = TilingAdvisor::inferShape(featureVector, profile.elementSize);
+            placement.baseMissRate =
+                simulate(featureVector, placement.shape, placement.set, placement.line, 0, profile.elementSize);
+            placement.missRate = placement.baseMissRate;
+            if (placement.shape.rows > 1 && placement.set > 0) {
+                std::vector<uint64_t> pads;
+                for (uint64_t pad = 1; pad <= MAX_LINEAR_PAD; pad++) {
+                    pads.push_back(pad);
+                }
+                uint64_t lineElements = AccessStrategyConfig::calculateLineSpace(placement.line) / profile.elementSize;
+                for (uint64_t pad = MAX_LINEAR_PAD * 2; pad <= lineElements; pad <<= 1) {
+                    pads.push_back(pad);
+                }
+                for (uint64_t pad : pads) {
+                    double missRate = simulate(featureVector, placement.shape, placement.set, placement.line, pad,
+                                               profile.elementSize);
+                    if (missRate < placement.missRate) {
+                        placement.missRate = missRate;
+                        placement.padElements = pad;
+                    }
+                }
+            }
+            placement.skewBytes = placement.padElements * profile.elementSize;
+            placement.missReduction = (placement.baseMissRate - placement.missRate) * featureVector.N;
+            placement.cyclesSaved =
+                placement.missReduction * profile.dmaCycles(AccessStrategyConfig::calculateLineSpace(placement.line));
+            map.missReduction += placement.missReduction;
+            map.cyclesSaved += placement.cyclesSaved;
+        }
+        map.variables.push_back(placement);
+    }
+    return map;
+}
+
+void DirectPlacement::printReport(const std::vector<PlacementMap> &maps, std::ostream &os)
+{
+    std::ios::fmtflags flags = os.flags();
+    for (const auto &map : maps) {
+        if (!map.hasDirect()) {
+            continue;
+        }
+        os << "[DIRECT放置] " << map.funcName << ": SM占用=" << map.smUsed << "B" << std::endl;
+        for (const auto &variable : map.variables) {
+            os << "  " << variable.name << ": " << AccessStrategyConfig(variable.strategy).getStrategyName();
+            if (variable.strategy == UNSUITABLE) {
+                os << ", DDR" << std::endl;
+                continue;
+            }
+            os << ((variable.memory == MEMORY_AM) ? ", AM[" : ", SM[") << variable.smOffset << ", " << variable.smOffset + variable.footprint << ")";
+            if (variable.strategy != DIRECT) {
+                os << std::endl;
+                continue;
+            }
+            os << ", set=" << variable.set << ", line=" << variable.line << ", 形状=";
+            if (variable.shape.rows > 1) {
+                os << variable.shape.rows << "x";
+            }
+            os << variable.shape.cols;
+            if (variable.padElements > 0) {
+                os << ", 行填充=" << variable.padElements << "元素(组索引偏移=行号×" << variable.skewBytes << "B)";
+            } else {
+                os << ", 无需偏移";
+            }
+            os << ", 模拟缺失率 " << std::fixed << std::setprecision(1) << variable.baseMissRate * 100 << "% → "
+               << variable.missRate * 100 << "%, 减少缺失" << std::setprecision(0) << variable.missReduction << "次";
+            os.flags(flags);
+            os << std::endl;
+        }
+        os << "  合计减少缺失" << std::fixed << std::setprecision(0) << map.missReduction << "次, 节省"
+           << StrategyCosts::formatCycles(map.cyclesSaved) << "周期" << std::endl
+           << std::endl;
+        os.flags(flags);
+    }
+}
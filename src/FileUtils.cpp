@@ -1,7 +1,7 @@
 #include "FileUtils.hpp"
 #include <sys/stat.h>
 #include <iostream>
-#include <regex>
+#include <fstream>
 #include <algorithm>
 
 #ifdef _WIN32
@@ -20,6 +20,84 @@ bool fileExists(const std::string& path) {
     return (stat(path.c_str(), &buffer) == 0);
 }
 
+bool isDirectory(const std::string& path) {
+    struct stat buffer;
+    return (stat(path.c_str(), &buffer) == 0) && (buffer.st_mode & S_IFDIR);
+}
+
+bool getModificationTime(const std::string& path, long long& seconds, long long& nanoseconds) {
+    struct stat buffer;
+    if (stat(path.c_str(), &buffer) != 0) {
+        return false;
+    }
+    seconds = static_cast<long long>(buffer.st_mtime);
+#if defined(__APPLE__)
+    nanoseconds = static_cast<long long>(buffer.st_mtimespec.tv_nsec);
+#elif defined(_WIN32)
+    nanoseconds = 0;
+#else
+    nanoseconds = static_cast<long long>(buffer.st_mtim.tv_nsec);
+#endif
+    return true;
+}
+
+bool readFile(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    content.clear();
+    file.seekg(0, std::ios::end);
+    std::streamoff length = file.tellg();
+    if (length > 0) {
+        content.resize(static_cast<size_t>(length));
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], length);
+    }
+    return true;
+}
+
+std::string trim(const std::string& str) {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+bool parseKeyValueLines(std::istream& in, const std::string& path,
+                        const std::function<bool(const std::string&, const std::string&)>& handler) {
+    bool ok = true;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << "警告: " << path << ":" << lineNo << " 缺少'='，跳过该行" << std::endl;
+            ok = false;
+            continue;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        try {
+            if (!handler(key, value)) {
+                std::cerr << "警告: " << path << ":" << lineNo << " 未知参数 " << key << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "警告: " << path << ":" << lineNo << " 参数 " << key << " 解析失败: " << e.what()
+                      << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
 void createDirectory(const std::string& path) {
     if (!fileExists(path)) {
         if (MKDIR(path.c_str()) != 0) {
@@ -73,27 +151,85 @@ std::vector<std::string> getSubdirectories(const std::string& path,
 }
 
 bool isLegacyCSVFormat(const std::string& filename, std::string& extractedDataset, std::string& extractedOpName) {
-    // 传统格式：{DATASET}_DATASET_{opName}.csv
-    // 使用正则表达式匹配
-    std::regex legacyPattern(R"(^([A-Z]+)_DATASET_(.+)\.csv$)");
-    std::smatch matches;
+    // 传统格式：{DATASET}_DATASET_{opName}.csv，DATASET为大写字母，opName至少一个字符
+    static const char MARKER[] = "_DATASET_";
+    static const char EXTENSION[] = ".csv";
+    const size_t markerLength = sizeof(MARKER) - 1;
+    const size_t extensionLength = sizeof(EXTENSION) - 1;
     
-    if (std::regex_match(filename, matches, legacyPattern)) {
-        extractedDataset = matches[1].str();
-        extractedOpName = matches[2].str();
-        return true;
+    size_t datasetLength = 0;
+    while (datasetLength < filename.size() && filename[datasetLength] >= 'A' && filename[datasetLength] <= 'Z') {
+        datasetLength++;
+    }
+    size_t opBegin = datasetLength + markerLength;
+    if (datasetLength == 0 || filename.size() < opBegin + 1 + extensionLength ||
+        filename.compare(datasetLength, markerLength, MARKER) != 0 ||
+        filename.compare(filename.size() - extensionLength, extensionLength, EXTENSION) != 0 ||
+        filename.find_first_of("\r\n", opBegin) != std::string::npos) {
+        return false;
     }
     
-    return false;
+    extractedDataset = filename.substr(0, datasetLength);
+    extractedOpName = filename.substr(opBegin, filename.size() - extensionLength - opBegin);
+    return true;
+}
+
+bool listDirectory(const std::string& path, std::vector<std::string>& files, std::vector<std::string>& dirs,
+                   const std::vector<std::string>& excludeList) {
+#ifdef _WIN32
+    WIN32_FIND_DATA findData;
+    HANDLE hFind = FindFirstFile((path + "\\*").c_str(), &findData);
+    if (hFind == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    do {
+        std::string name = findData.cFileName;
+        if (std::find(excludeList.begin(), excludeList.end(), name) != excludeList.end()) {
+            continue;
+        }
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            dirs.push_back(name);
+        } else {
+            files.push_back(name);
+        }
+    } while (FindNextFile(hFind, &findData) != 0);
+    FindClose(hFind);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string name = entry->d_name;
+        if (std::find(excludeList.begin(), excludeList.end(), name) != excludeList.end()) {
+            continue;
+        }
+        // 部分文件系统不提供d_type，退回stat判断
+        bool isDir = (entry->d_type == DT_DIR) ||
+                     (entry->d_type == DT_UNKNOWN && isDirectory(path + "/" + name));
+        if (isDir) {
+            dirs.push_back(name);
+        } else if (entry->d_type == DT_REG || entry->d_type == DT_UNKNOWN) {
+            files.push_back(name);
+        }
+    }
+    closedir(dir);
+#endif
+    return true;
 }
 
 std::vector<std::string> getCSVFiles(const std::string& path) {
+    return getFilesWithExtension(path, ".csv");
+}
+
+std::vector<std::string> getFilesWithExtension(const std::string& path, const std::string& extension) {
     std::vector<std::string> csvFiles;
     
 #ifdef _WIN32
     // Windows 实现
     WIN32_FIND_DATA findData;
-    HANDLE hFind = FindFirstFile((path + "\\*.csv").c_str(), &findData);
+    HANDLE hFind = FindFirstFile((path + "\\*" + extension).c_str(), &findData);
     
     if (hFind != INVALID_HANDLE_VALUE) {
         do {
@@ -111,8 +247,9 @@ std::vector<std::string> getCSVFiles(const std::string& path) {
         while ((entry = readdir(dir)) != nullptr) {
             if (entry->d_type == DT_REG) { // 普通文件
                 std::string filename = entry->d_name;
-                // 检查是否以.csv结尾
-                if (filename.length() > 4 && filename.substr(filename.length() - 4) == ".csv") {
+                // 检查扩展名
+                if (filename.length() > extension.length() &&
+                    filename.compare(filename.length() - extension.length(), extension.length(), extension) == 0) {
                     csvFiles.push_back(filename);
                 }
             }
@@ -0,0 +1,85 @@
+#include "HardwareProfile.hpp"
+#include "FileUtils.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool HardwareProfile::loadFromFile(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "无法打开硬件配置文件: " << path << std::endl;
+        return false;
+    }
+
+    bool ok = FileUtils::parseKeyValueLines(file, path, [this](const std::string &key, const std::string &value) {
+        if (key == "sm_size") {
+            smSize = std::stoi(value);
+        } else if (key == "sm_alignment") {
+            smAlignment = std::stoi(value);
+        } else if (key == "sm_latency") {
+            smLatency = std::stod(value);
+        } else if (key == "ddr_latency") {
+            ddrLatency = std::stod(value);
+        } else if (key == "dma_latency") {
+            dmaLatency = std::stod(value);
+        } else if (key == "dma_bandwidth") {
+            dmaBandwidth = std::stod(value);
+        } else if (key == "compute_cycles_per_access") {
+            computeCyclesPerAccess = std::stod(value);
+        } else if (key == "element_size") {
+            elementSize = std::stoi(value);
+        } else if (key == "am_size") {
+            amSize = std::stoi(value);
+        } else if (key == "vector_width") {
+            vectorWidth = std::stoi(value);
+        } else if (key == "gsm_size") {
+            gsmSize = std::stoi(value);
+        } else if (key == "gsm_latency") {
+            gsmLatency = std::stod(value);
+        } else if (key == "gsm_dma_latency") {
+            gsmDmaLatency = std::stod(value);
+        } else if (key == "gsm_dma_bandwidth") {
+            gsmDmaBandwidth = std::stod(value);
+        } else {
+            return false;
+        }
+        return true;
+    });
+
+    if (dmaBandwidth <= 0 || smSize <= 0 || elementSize <= 0) {
+        std::cerr << "错误: 硬件配置中的sm_size、dma_bandwidth和element_size必须为正数" << std::endl;
+        return false;
+    }
+    if (amSize < 0 || vectorWidth <= 0 || (vectorWidth & (vectorWidth - 1)) != 0) {
+        std::cerr << "错误: 硬件配置中的am_size不能为负数，vector_width必须为2的幂" << std::endl;
+        return false;
+    }
+    if (gsmSize < 0 || gsmDmaBandwidth <= 0) {
+        std::cerr << "错误: 硬件配置中的gsm_size不能为负数，gsm_dma_bandwidth必须为正数" << std::endl;
+        return false;
+    }
+    if (smAlignment <= 0 || (smAlignment & (smAlignment - 1)) != 0) {
+        std::cerr << "错误: 硬件配置中的sm_alignment必须为2的幂" << std::endl;
+        return false;
+    }
+    return ok;
+}
+
+HardwareProfile HardwareProfile::getGsmSourced() const
+{
+    HardwareProfile sourced = *this;
+    sourced.ddrLatency = gsmLatency;
+    sourced.dmaLatency = gsmDmaLatency;
+    sourced.dmaBandwidth = gsmDmaBandwidth;
+    return sourced;
+}
+
+void HardwareProfile::printInfo() const
+{
+    std::cout << "硬件配置: SM=" << smSize << "B, SM对齐=" << smAlignment << "B, SM延迟=" << smLatency << ", DDR延迟=" << ddrLatency
+              << ", DMA延迟=" << dmaLatency << ", DMA带宽=" << dmaBandwidth << "B/周期"
+              << ", 计算周期/访存=" << computeCyclesPerAccess << ", 元素长度=" << elementSize << "B"
+              << ", AM=" << amSize << "B, 向量宽度=" << vectorWidth << "B, GSM=" << gsmSize << "B, GSM延迟=" << gsmLatency
+              << ", GSM DMA延迟=" << gsmDmaLatency << ", GSM DMA带宽=" << gsmDmaBandwidth << "B/周期" << std::endl;
+}
@@ -0,0 +1,178 @@
+#include "HierarchyPlanner.hpp"
+#include "StrategyCostModel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace
+{
+
+std::atomic<bool> &enabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// SM一侧的策略及参数，UNSUITABLE时为直接访问来源层
+std::string formatConfig(const AccessStrategyConfig &config)
+{
+    switch (config.accessStrategy) {
+    case SINGLE:
+        return "SM " + config.getStrategyName() + "(line=" + std::to_string(config.line) + ")";
+    case DIRECT:
+        return "SM " + config.getStrategyName() + "(set=" + std::to_string(config.set) + ",line=" +
+               std::to_string(config.line) + ")";
+    case UNSUITABLE:
+        return "直接访问";
+    default:
+        return "SM " + config.getStrategyName();
+    }
+}
+
+} // namespace
+
+bool HierarchyPlan::hasStaging() const
+{
+    for (const auto &variable : variables) {
+        if (variable.home == TIER_GSM) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HierarchyPlanner::isEnabled() { return enabledStorage().load(); }
+
+void HierarchyPlanner::setEnabled(bool enabled) { enabledStorage().store(enabled); }
+
+TierPlacement HierarchyPlanner::evaluateStaging(const AccessFeatureVector &featureVector,
+                                                const HardwareProfile &profile)
+{
+    TierPlacement placement;
+    placement.name = featureVector.varName.str();
+    placement.home = TIER_GSM;
+    placement.cycles = std::numeric_limits<double>::infinity();
+    if (profile.gsmSize <= 0 || featureVector.S > static_cast<unsigned long long>(profile.gsmSize)) {
+        return placement;
+    }
+    placement.gsmBytes = featureVector.S;
+    placement.stagingCycles = profile.dmaCycles(static_cast<double>(featureVector.S));
+
+    // SM一侧沿用推断器划分的C及其策略模型，缺失改由GSM供给；所选策略不可行时直接访问GSM
+    FeatureVectorList staged;
+    staged.push_back(featureVector);
+    AccessFeatureVector &sourced = staged.front();
+    HardwareProfile gsmProfile = profile.getGsmSourced();
+    AccessStrategy strategy = UNSUITABLE;
+    if (featureVector.F != 0) {
+        StrategyCostModel::estimateCosts(sourced, gsmProfile);
+        strategy = StrategyCostModel::getDefault().selectStrategy(sourced);
+        if (std::isinf(sourced.strategyCosts.get(strategy))) {
+            strategy = UNSUITABLE;
+        }
+    }
+    sourced.accessStrategyConfig.setStrategy(strategy);
+    AccessStrategyDeducter::determineParameters(staged);
+    placement.config = sourced.accessStrategyConfig;
+    placement.cycles = placement.stagingCycles + StrategyCostModel::getSelectedCycles(sourced, gsmProfile);
+    return placement;
+}
+
+HierarchyPlan HierarchyPlanner::plan(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                                     const HardwareProfile &profile)
+{
+    HierarchyPlan plan;
+    plan.funcName = funcName;
+    plan.gsmCapacity = profile.gsmSize;
+
+    // 每个变量的候选：0为留在DDR（推断器结果），1为暂存到GSM（仅在可行且更快时）
+    std::vector<std::vector<TierPlacement>> options(accessFeatureVectors.size());
+    for (size_t v = 0; v < accessFeatureVectors.size(); v++) {
+        const AccessFeatureVector &featureVector = accessFeatureVectors[v];
+        TierPlacement keep;
+        keep.name = featureVector.varName.str();
+        keep.original = featureVector.accessStrategyConfig;
+        keep.originalCycles = StrategyCostModel::getSelectedCycles(featureVector, profile);
+        keep.config = keep.original;
+        keep.cycles = keep.originalCycles;
+        options[v].push_back(keep);
+
+        TierPlacement staged = evaluateStaging(featureVector, profile);
+        if (staged.gsmBytes > 0 && staged.cycles < keep.cycles) {
+            staged.original = keep.original;
+            staged.originalCycles = keep.originalCycles;
+            options[v].push_back(staged);
+        }
+    }
+
+    // 0/1背包：best[u]为已处理变量占用不超过u个单位时的最小周期
+    unsigned long long unit = std::max<unsigned long long>(
+        profile.smAlignment, (static_cast<unsigned long long>(profile.gsmSize) + GSM_UNITS - 1) / GSM_UNITS);
+    size_t capacity = static_cast<size_t>(std::max(0, profile.gsmSize) / unit);
+    std::vector<double> best(capacity + 1, 0.0);
+    std::vector<std::vector<bool>> staged(options.size(), std::vector<bool>(capacity + 1, false));
+    for (size_t v = 0; v < options.size(); v++) {
+        std::vector<double> next(capacity + 1);
+        size_t weight = (options[v].size() > 1) ? static_cast<size_t>((options[v][1].gsmBytes + unit - 1) / unit) : 0;
+        for (size_t u = 0; u <= capacity; u++) {
+            next[u] = best[u] + options[v][0].cycles;
+            if (options[v].size() > 1 && weight <= u && best[u - weight] + options[v][1].cycles < next[u]) {
+                next[u] = best[u - weight] + options[v][1].cycles;
+                staged[v][u] = true;
+            }
+        }
+        best = std::move(next);
+    }
+
+    std::vector<size_t> chosen(options.size(), 0);
+    size_t u = capacity;
+    for (size_t v = options.size(); v-- > 0;) {
+        if (staged[v][u]) {
+            chosen[v] = 1;
+            u -= static_cast<size_t>((options[v][1].gsmBytes + unit - 1) / unit);
+        }
+    }
+    for (size_t v = 0; v < options.size(); v++) {
+        const TierPlacement &placement = options[v][chosen[v]];
+        plan.variables.push_back(placement);
+        plan.gsmUsed += placement.gsmBytes;
+        plan.originalCycles += placement.originalCycles;
+        plan.plannedCycles += placement.cycles;
+    }
+    return plan;
+}
+
+void HierarchyPlanner::printReport(const std::vector<HierarchyPlan> &plans, std::ostream &os)
+{
+    std::ios::fmtflags flags = os.flags();
+    for (const auto &plan : plans) {
+        if (plan.variables.empty()) {
+            continue;
+        }
+        os << "[两级放置] " << plan.funcName << ": GSM占用=" << plan.gsmUsed << "B/" << plan.gsmCapacity << "B"
+           << std::endl;
+        for (const auto &variable : plan.variables) {
+            os << "  " << variable.name << ": ";
+            if (variable.home == TIER_GSM) {
+                os << "DDR → GSM(" << variable.gsmBytes << "B, 载入" << StrategyCosts::formatCycles(variable.stagingCycles)
+                   << "周期) → " << formatConfig(variable.config) << ", 原为DDR → " << formatConfig(variable.original)
+                   << ", ";
+            } else {
+                os << "DDR → " << formatConfig(variable.config) << ", ";
+            }
+            os << "周期 " << StrategyCosts::formatCycles(variable.originalCycles) << " → "
+               << StrategyCosts::formatCycles(variable.cycles) << std::endl;
+        }
+        if (plan.hasStaging()) {
+            os << "  估算周期 " << StrategyCosts::formatCycles(plan.originalCycles) << " → "
+               << StrategyCosts::formatCycles(plan.plannedCycles) << ", 节省" << std::fixed << std::setprecision(1)
+               << (1.0 - plan.plannedCycles / plan.originalCycles) * 100 << "%" << std::endl;
+            os.flags(flags);
+        } else {
+            os << "  没有值得暂存到GSM的变量" << std::endl;
+        }
+        os << std::endl;
+    }
+}
@@ -0,0 +1,230 @@
+#include "InputDiscovery.hpp"
+#include "FileUtils.hpp"
+#include "ParallelFor.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+const char CACHE_MAGIC[] = "MASAMT-MANIFEST 1";
+
+std::string joinPath(const std::string &directory, const std::string &name)
+{
+    return (directory == ".") ? name : directory + "/" + name;
+}
+
+bool entryLess(const InputManifest::Entry &a, const InputManifest::Entry &b)
+{
+    if (a.opName != b.opName) {
+        return a.opName < b.opName;
+    }
+    size_t rankA = InputDiscovery::getDatasetRank(a.dataset);
+    size_t rankB = InputDiscovery::getDatasetRank(b.dataset);
+    if (rankA != rankB) {
+        return rankA < rankB;
+    }
+    return (a.dataset != b.dataset) ? a.dataset < b.dataset : a.path < b.path;
+}
+
+} // namespace
+
+std::vector<std::string> InputManifest::getOperators() const
+{
+    std::vector<std::string> operators;
+    for (const auto &entry : legacyFiles) {
+        if (operators.empty() || operators.back() != entry.opName) {
+            operators.push_back(entry.opName);
+        }
+    }
+    return operators;
+}
+
+const std::vector<std::string> &InputDiscovery::getStandardDatasets()
+{
+    static const std::vector<std::string> datasets = {"MINI", "SMALL", "STANDARD", "LARGE", "EXTRALARGE"};
+    return datasets;
+}
+
+size_t InputDiscovery::getDatasetRank(const std::string &dataset)
+{
+    const std::vector<std::string> &datasets = getStandardDatasets();
+    return std::find(datasets.begin(), datasets.end(), dataset) - datasets.begin();
+}
+
+bool InputDiscovery::stampDirectory(const std::string &path, DirectoryStamp &stamp)
+{
+    stamp.path = path;
+    return FileUtils::getModificationTime(path, stamp.seconds, stamp.nanoseconds);
+}
+
+bool InputDiscovery::classify(const std::string &directory, const std::string &filename, bool underDataDir,
+                              InputManifest::Entry &entry) const
+{
+    std::string dataset, opName;
+    bool isLegacy = FileUtils::isLegacyCSVFormat(filename, dataset, opName);
+    entry.path = joinPath(directory, filename);
+    entry.isLegacy = isLegacy;
+    if (underDataDir) {
+        // 数据目录下只收集data/<op>/中属于该算子的传统格式文件
+        entry.opName = opName;
+        entry.dataset = dataset;
+        return isLegacy && directory == dataDir + "/" + opName;
+    }
+    // 工作目录下的传统格式文件不作为通用格式处理
+    if (isLegacy || filename.size() <= 4 || filename.compare(filename.size() - 4, 4, ".csv") != 0) {
+        return false;
+    }
+    entry.opName = FileUtils::getFileNameWithoutExtension(filename);
+    entry.dataset.clear();
+    return true;
+}
+
+InputManifest InputDiscovery::scan(std::vector<DirectoryStamp> &stamps) const
+{
+    InputManifest manifest;
+    stamps.clear();
+
+    // 工作目录只扫描顶层
+    DirectoryStamp stamp;
+    if (stampDirectory(workDir, stamp)) {
+        stamps.push_back(stamp);
+        std::vector<std::string> files, dirs;
+        FileUtils::listDirectory(workDir, files, dirs);
+        for (const auto &filename : files) {
+            InputManifest::Entry entry;
+            if (classify(workDir, filename, false, entry)) {
+                manifest.genericFiles.push_back(entry);
+            }
+        }
+    }
+
+    // 数据目录：每个算子子目录作为一个并行任务，只看该目录本身
+    std::vector<std::string> topFiles, topDirs;
+    if (stampDirectory(dataDir, stamp) && FileUtils::listDirectory(dataDir, topFiles, topDirs)) {
+        stamps.push_back(stamp);
+        std::vector<std::vector<InputManifest::Entry>> taskEntries(topDirs.size());
+        std::vector<std::vector<DirectoryStamp>> taskStamps(topDirs.size());
+        parallelFor(topDirs.size(), jobs, [&](size_t task) {
+            std::string directory = dataDir + "/" + topDirs[task];
+            DirectoryStamp directoryStamp;
+            std::vector<std::string> files, dirs;
+            if (!stampDirectory(directory, directoryStamp) || !FileUtils::listDirectory(directory, files, dirs)) {
+                return;
+            }
+            taskStamps[task].push_back(directoryStamp);
+            for (const auto &filename : files) {
+                InputManifest::Entry entry;
+                if (classify(directory, filename, true, entry)) {
+                    taskEntries[task].push_back(entry);
+                }
+            }
+        });
+        for (size_t task = 0; task < topDirs.size(); task++) {
+            manifest.legacyFiles.insert(manifest.legacyFiles.end(), taskEntries[task].begin(), taskEntries[task].end());
+            stamps.insert(stamps.end(), taskStamps[task].begin(), taskStamps[task].end());
+        }
+    }
+
+    std::sort(manifest.legacyFiles.begin(), manifest.legacyFiles.end(), entryLess);
+    std::sort(manifest.genericFiles.begin(), manifest.genericFiles.end(),
+              [](const InputManifest::Entry &a, const InputManifest::Entry &b) { return a.path < b.path; });
+    return manifest;
+}
+
+bool InputDiscovery::loadCache(InputManifest &manifest) const
+{
+    std::ifstream file(cachePath);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    if (!std::getline(file, line) || line != CACHE_MAGIC || !std::getline(file, line) || line != "R " + dataDir ||
+        !std::getline(file, line) || line != "W " + workDir) {
+        return false;
+    }
+
+    // D <秒> <纳秒> <目录>：任一目录的修改时间变化（有文件或子目录增删）即视为失效
+    // F <L|G> <文件>：清单中的文件，算子与数据集按文件名重新解析
+    bool hasStamps = false;
+    while (std::getline(file, line)) {
+        if (line.size() < 2) {
+            return false;
+        }
+        std::istringstream fields(line.substr(2));
+        if (line[0] == 'D') {
+            DirectoryStamp expected, actual;
+            fields >> expected.seconds >> expected.nanoseconds;
+            fields.get();
+            std::getline(fields, expected.path);
+            if (!fields || !stampDirectory(expected.path, actual) || actual.seconds != expected.seconds ||
+                actual.nanoseconds != expected.nanoseconds) {
+                return false;
+            }
+            hasStamps = true;
+        } else if (line[0] == 'F' && line.size() > 4) {
+            bool underDataDir = line[2] == 'L';
+            std::string path = line.substr(4);
+            size_t slash = path.find_last_of('/');
+            std::string directory = (slash == std::string::npos) ? "." : path.substr(0, slash);
+            std::string filename = (slash == std::string::npos) ? path : path.substr(slash + 1);
+            InputManifest::Entry entry;
+            if (!classify(directory, filename, underDataDir, entry)) {
+                return false;
+            }
+            (underDataDir ? manifest.legacyFiles : manifest.genericFiles).push_back(entry);
+        } else {
+            return false;
+        }
+    }
+    return hasStamps;
+}
+
+void InputDiscovery::saveCache(const InputManifest &manifest, const std::vector<DirectoryStamp> &stamps) const
+{
+    std::string tempPath = cachePath + ".tmp";
+    std::ofstream file(tempPath, std::ios::trunc);
+    if (!file.is_open()) {
+        return;
+    }
+    file << CACHE_MAGIC << "\n" << "R " << dataDir << "\n" << "W " << workDir << "\n";
+    for (const auto &stamp : stamps) {
+        file << "D " << stamp.seconds << " " << stamp.nanoseconds << " " << stamp.path << "\n";
+    }
+    for (const auto &entry : manifest.legacyFiles) {
+        file << "F L " << entry.path << "\n";
+    }
+    for (const auto &entry : manifest.genericFiles) {
+        file << "F G " << entry.path << "\n";
+    }
+    file.close();
+    if (!file || std::rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+    }
+}
+
+InputManifest InputDiscovery::discover() const
+{
+    InputManifest manifest;
+    if (!cachePath.empty()) {
+        // 先建立缓存目录，之后写缓存文件不会改变工作目录的修改时间
+        size_t slash = cachePath.find_last_of('/');
+        if (slash != std::string::npos) {
+            FileUtils::createDirectory(cachePath.substr(0, slash));
+        }
+        if (loadCache(manifest)) {
+            manifest.fromCache = true;
+            return manifest;
+        }
+        manifest = InputManifest();
+    }
+
+    std::vector<DirectoryStamp> stamps;
+    manifest = scan(stamps);
+    if (!cachePath.empty()) {
+        saveCache(manifest, stamps);
+    }
+    return manifest;
+}
@@ -0,0 +1,244 @@
+#include "MemoryInstrument.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+
+namespace
+{
+
+const char *const PHASE_NAMES[PHASE_COUNT] = {"other", "parse", "group", "deduce", "write"};
+
+#ifdef MASAMT_INSTRUMENT
+
+// 计数器只用原子量，operator new中不能再分配内存
+class Counters
+{
+public:
+    std::atomic<uint64_t> allocations[PHASE_COUNT];
+    std::atomic<uint64_t> bytes[PHASE_COUNT];
+    std::atomic<uint64_t> arenaAllocations[PHASE_COUNT];
+    std::atomic<uint64_t> arenaBytes[PHASE_COUNT];
+    std::atomic<uint64_t> liveBytes;
+    std::atomic<uint64_t> peakBytes;
+    std::atomic<uint64_t> rows;
+};
+
+// 零初始化的静态存储，在任何静态构造之前即可使用
+Counters counters;
+
+thread_local MemoryPhase currentPhase = PHASE_OTHER;
+
+// 每块分配前的头部保存请求大小，释放时据此扣减存活字节，大小为最大对齐保证返回地址的对齐
+const size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void *allocate(size_t size)
+{
+    char *block = static_cast<char *>(std::malloc(size + HEADER_SIZE));
+    if (block == nullptr) {
+        return nullptr;
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+    counters.allocations[currentPhase].fetch_add(1, std::memory_order_relaxed);
+    counters.bytes[currentPhase].fetch_add(size, std::memory_order_relaxed);
+    uint64_t live = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return block + HEADER_SIZE;
+}
+
+void *allocateOrThrow(size_t size)
+{
+    void *pointer = allocate(size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void release(void *pointer)
+{
+    if (pointer == nullptr) {
+        return;
+    }
+    char *block = static_cast<char *>(pointer) - HEADER_SIZE;
+    counters.liveBytes.fetch_sub(*reinterpret_cast<size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+std::string getOutputPath()
+{
+    const char *path = std::getenv("MASAMT_INSTRUMENT_OUTPUT");
+    return (path != nullptr && *path != '\0') ? path : "masamt_instrument.json";
+}
+
+void reportAtExit()
+{
+    MemoryInstrument::printReport(std::cerr);
+    std::string path = getOutputPath();
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "无法写入内存统计文件: " << path << std::endl;
+        return;
+    }
+    MemoryInstrument::writeJSON(file);
+}
+
+const bool registered = (std::atexit(reportAtExit) == 0);
+
+#endif
+
+double perRow(uint64_t value, uint64_t rows) { return (rows == 0) ? 0.0 : static_cast<double>(value) / rows; }
+
+// 先取快照，报告本身的分配不计入
+void snapshot(MemoryInstrument::PhaseStats (&phases)[PHASE_COUNT], MemoryInstrument::PhaseStats &total)
+{
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        phases[p] = MemoryInstrument::getPhaseStats(static_cast<MemoryPhase>(p));
+        total.allocations += phases[p].allocations;
+        total.bytes += phases[p].bytes;
+        total.arenaAllocations += phases[p].arenaAllocations;
+        total.arenaBytes += phases[p].arenaBytes;
+    }
+}
+
+} // namespace
+
+#ifdef MASAMT_INSTRUMENT
+
+void *operator new(size_t size) { return allocateOrThrow(size); }
+
+void *operator new[](size_t size) { return allocateOrThrow(size); }
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocate(size); }
+
+void operator delete(void *pointer) noexcept { release(pointer); }
+
+void operator delete[](void *pointer) noexcept { release(pointer); }
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { release(pointer); }
+
+MemoryInstrument::PhaseScope::PhaseScope(MemoryPhase phase) : previous(currentPhase)
+{
+    currentPhase = phase;
+}
+
+MemoryInstrument::PhaseScope::~PhaseScope() { currentPhase = previous; }
+
+void MemoryInstrument::addRows(uint64_t rows) { counters.rows.fetch_add(rows, std::memory_order_relaxed); }
+
+void MemoryInstrument::addArenaAllocation(uint64_t bytes)
+{
+    counters.arenaAllocations[currentPhase].fetch_add(1, std::memory_order_relaxed);
+    counters.arenaBytes[currentPhase].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+MemoryInstrument::PhaseStats MemoryInstrument::getPhaseStats(MemoryPhase phase)
+{
+    PhaseStats stats;
+    stats.allocations = counters.allocations[phase].load(std::memory_order_relaxed);
+    stats.bytes = counters.bytes[phase].load(std::memory_order_relaxed);
+    stats.arenaAllocations = counters.arenaAllocations[phase].load(std::memory_order_relaxed);
+    stats.arenaBytes = counters.arenaBytes[phase].load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint64_t MemoryInstrument::getRows() { return counters.rows.load(std::memory_order_relaxed); }
+
+uint64_t MemoryInstrument::getPeakHeapBytes() { return counters.peakBytes.load(std::memory_order_relaxed); }
+
+#else
+
+MemoryInstrument::PhaseStats MemoryInstrument::getPhaseStats(MemoryPhase) { return PhaseStats(); }
+
+uint64_t MemoryInstrument::getRows() { return 0; }
+
+uint64_t MemoryInstrument::getPeakHeapBytes() { return 0; }
+
+#endif
+
+const char *MemoryInstrument::getPhaseName(MemoryPhase phase) { return PHASE_NAMES[phase]; }
+
+uint64_t MemoryInstrument::getPeakRSS()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    // macOS以字节为单位，Linux以KB为单位
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+void MemoryInstrument::printReport(std::ostream &os)
+{
+    PhaseStats phases[PHASE_COUNT];
+    PhaseStats total;
+    snapshot(phases, total);
+    uint64_t rows = getRows();
+    uint64_t peakHeap = getPeakHeapBytes();
+    uint64_t peakRSS = getPeakRSS();
+
+    std::ios::fmtflags flags = os.flags();
+    os << "Memory instrumentation (" << rows << " rows):\n";
+    os << "  " << std::left << std::setw(8) << "phase" << std::right << std::setw(14) << "allocations"
+       << std::setw(16) << "bytes" << std::setw(12) << "allocs/row" << std::setw(12) << "bytes/row"
+       << std::setw(14) << "arena allocs" << std::setw(16) << "arena bytes" << std::setw(12) << "allocs/row"
+       << std::setw(12) << "bytes/row" << "\n";
+    os << std::fixed << std::setprecision(1);
+    for (int p = 0; p <= PHASE_COUNT; p++) {
+        const PhaseStats &stats = (p < PHASE_COUNT) ? phases[p] : total;
+        const char *name = (p < PHASE_COUNT) ? PHASE_NAMES[p] : "total";
+        os << "  " << std::left << std::setw(8) << name << std::right << std::setw(14) << stats.allocations
+           << std::setw(16) << stats.bytes << std::setw(12) << perRow(stats.allocations, rows) << std::setw(12)
+           << perRow(stats.bytes, rows) << std::setw(14) << stats.arenaAllocations << std::setw(16) << stats.arenaBytes
+           << std::setw(12) << perRow(stats.arenaAllocations, rows) << std::setw(12) << perRow(stats.arenaBytes, rows)
+           << "\n";
+    }
+    os << "  peak heap: " << peakHeap << " bytes (" << perRow(peakHeap, rows) << " bytes/row), peak RSS: " << peakRSS
+       << " bytes (" << perRow(peakRSS, rows) << " bytes/row)" << std::endl;
+    os.flags(flags);
+}
+
+void MemoryInstrument::writeJSON(std::ostream &os)
+{
+    PhaseStats phases[PHASE_COUNT];
+    PhaseStats total;
+    snapshot(phases, total);
+    uint64_t rows = getRows();
+    uint64_t peakHeap = getPeakHeapBytes();
+    uint64_t peakRSS = getPeakRSS();
+
+    std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    auto writeStats = [&](const PhaseStats &stats) {
+        os << "{\"allocations\":" << stats.allocations << ",\"bytes\":" << stats.bytes
+           << ",\"allocations_per_row\":" << perRow(stats.allocations, rows)
+           << ",\"bytes_per_row\":" << perRow(stats.bytes, rows) << ",\"arena_allocations\":" << stats.arenaAllocations
+           << ",\"arena_bytes\":" << stats.arenaBytes
+           << ",\"arena_allocations_per_row\":" << perRow(stats.arenaAllocations, rows)
+           << ",\"arena_bytes_per_row\":" << perRow(stats.arenaBytes, rows) << "}";
+    };
+    os << "{\"rows\":" << rows << ",\"phases\":{";
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        os << ((p == 0) ? "" : ",") << "\"" << PHASE_NAMES[p] << "\":";
+        writeStats(phases[p]);
+    }
+    os << "},\"total\":";
+    writeStats(total);
+    os << ",\"peak_heap_bytes\":" << peakHeap << ",\"peak_rss_bytes\":" << peakRSS << "}" << std::endl;
+    os.flags(flags);
+}
@@ -0,0 +1,122 @@
+#include "MonotonicArena.hpp"
+#include "MemoryInstrument.hpp"
+#include <algorithm>
+#include <cstdint>
+
+MonotonicArena::MonotonicArena(size_t blockSize) : blockSize(blockSize) {}
+
+MonotonicArena::~MonotonicArena()
+{
+    for (const auto &block : blocks) {
+        ::operator delete(block.data);
+    }
+}
+
+void MonotonicArena::addBlock(size_t minSize)
+{
+    Block block;
+    block.size = std::max(blockSize, minSize);
+    block.data = static_cast<char *>(::operator new(block.size));
+    blocks.push_back(block);
+    offset = 0;
+}
+
+void *MonotonicArena::allocate(size_t bytes, size_t alignment)
+{
+    if (blocks.empty()) {
+        addBlock(bytes + alignment);
+    }
+    Block &block = blocks.back();
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+    size_t aligned = ((base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+    if (aligned + bytes > block.size) {
+        // 当前块剩余空间不足，按块大小翻倍申请新块，减少大文件的块数
+        blockSize = std::max(blockSize, block.size * 2);
+        addBlock(bytes + alignment);
+        return allocate(bytes, alignment);
+    }
+    offset = aligned + bytes;
+    bytesUsed += bytes;
+    MemoryInstrument::addArenaAllocation(bytes);
+    peakBytesUsed = std::max(peakBytesUsed, bytesUsed);
+    return block.data + aligned;
+}
+
+void MonotonicArena::reset()
+{
+    if (blocks.size() > 1) {
+        size_t total = 0;
+        for (const auto &block : blocks) {
+            total += block.size;
+            ::operator delete(block.data);
+        }
+        blocks.clear();
+        addBlock(total);
+    }
+    offset = 0;
+    bytesUsed = 0;
+}
+
+MonotonicArena::Marker MonotonicArena::mark() const
+{
+    Marker marker;
+    marker.blockIndex = blocks.empty() ? 0 : blocks.size() - 1;
+    marker.offset = offset;
+    marker.bytesUsed = bytesUsed;
+    return marker;
+}
+
+void MonotonicArena::rewind(const Marker &marker)
+{
+    if (blocks.empty()) {
+        return;
+    }
+    while (blocks.size() > marker.blockIndex + 1) {
+        ::operator delete(blocks.back().data);
+        blocks.pop_back();
+    }
+    offset = marker.offset;
+    bytesUsed = marker.bytesUsed;
+}
+
+MonotonicArena *&MonotonicArena::currentSlot()
+{
+    static thread_local MonotonicArena *arena = nullptr;
+    return arena;
+}
+
+MonotonicArena *MonotonicArena::current() { return currentSlot(); }
+
+MonotonicArena &MonotonicArena::threadArena()
+{
+    static thread_local MonotonicArena arena;
+    return arena;
+}
+
+ArenaScope::ArenaScope(MonotonicArena &arena, bool resetOnExit)
+    : arena(arena), previous(MonotonicArena::currentSlot()), resetOnExit(resetOnExit)
+{
+    MonotonicArena::currentSlot() = &arena;
+}
+
+ArenaScope::~ArenaScope()
+{
+    MonotonicArena::currentSlot() = previous;
+    if (resetOnExit) {
+        arena.reset();
+    }
+}
+
+ArenaCheckpoint::ArenaCheckpoint() : arena(MonotonicArena::current())
+{
+    if (arena != nullptr) {
+        marker = arena->mark();
+    }
+}
+
+ArenaCheckpoint::~ArenaCheckpoint()
+{
+    if (arena != nullptr) {
+        arena->rewind(marker);
+    }
+}
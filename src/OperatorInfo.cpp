@@ -1,13 +1,17 @@
 #include "OperatorInfo.hpp"
+#include "MemoryInstrument.hpp"
 #include <fstream>
 #include <sstream>
-#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
 #include <iomanip>
 
 
-VariableInfo::VariableInfo(const std::string& name, const unsigned long long size, 
-                         const unsigned long long access, const std::vector<std::pair<int, double>>& patterns)
+VariableInfo::VariableInfo(const InternedName& name, const unsigned long long size, 
+                         const unsigned long long access, const AccessPatterns& patterns)
 {
     this->name = name;
     this->size = size;
@@ -15,91 +19,234 @@ VariableInfo::VariableInfo(const std::string& name, const unsigned long long siz
     this->patterns = patterns;
 }
 
-FunctionInfo::FunctionInfo(const std::string& name, const std::vector<VariableInfo>& variables)
+FunctionInfo::FunctionInfo(const InternedName& name, const std::vector<VariableInfo>& variables)
 {
     this->name = name;
-    this->variables = variables;
+    this->variables.assign(variables.begin(), variables.end());
+}
+
+FunctionInfo::FunctionInfo(const InternedName& name, VariableList&& variables)
+    : name(name), variables(std::move(variables))
+{
 }
 
 OperatorInfo::OperatorInfo(const std::string& name, const std::vector<FunctionInfo>& functions)
 {
     this->name = name;
-    this->functions = functions;
+    this->functions.assign(functions.begin(), functions.end());
 }
 
-void OperatorInfo::getOperatorInfoFromCSV(const std::string& opName, const std::string& csvPath) {
-    // 设置算子名称
-    this->name = opName;
-    
-    // 创建一个map来存储每个函数的变量信息
-    std::map<std::string, std::vector<VariableInfo>> functionVariables;
-    
-    std::ifstream file(csvPath);
-    if (!file.is_open()) {
-        std::cerr << "无法打开文件: " << csvPath << std::endl;
-        return;
+namespace {
+
+// 取出下一个非空字段，返回false表示行已结束；字段不复制，以[begin, end)表示
+bool nextField(const char*& cursor, const char* lineEnd, const char*& begin, const char*& end) {
+    while (cursor <= lineEnd) {
+        begin = cursor;
+        while (cursor < lineEnd && *cursor != ',') {
+            cursor++;
+        }
+        end = cursor;
+        cursor++;  // 跳过逗号
+        if (end > begin) {  // 只返回非空字段
+            return true;
+        }
+    }
+    return false;
+}
+
+// 解析一行的前四个字段：变量名、函数名、元素数量、访问次数，cursor移动到第5个字段处
+bool parseRowHeader(const char*& cursor, const char* lineEnd, const char* (&fields)[2][2],
+                    unsigned long long& size, unsigned long long& access) {
+    const char* begin;
+    const char* end;
+    const char* numbers[2];
+    for (int i = 0; i < 4; i++) {
+        if (!nextField(cursor, lineEnd, begin, end)) {
+            std::cerr << "警告: 行数据格式不正确，跳过该行" << std::endl;
+            return false;
+        }
+        if (i < 2) {
+            fields[i][0] = begin;
+            fields[i][1] = end;
+        } else {
+            numbers[i - 2] = begin;
+        }
     }
+    char* parsedEnd;
+    size = std::strtoull(numbers[0], &parsedEnd, 10);
+    bool valid = parsedEnd != numbers[0];
+    access = std::strtoull(numbers[1], &parsedEnd, 10);
+    valid = valid && parsedEnd != numbers[1];
+    if (!valid) {
+        std::cerr << "警告: 解析数据块大小或访存次数失败，跳过该行" << std::endl;
+    }
+    return valid;
+}
+
+// 函数槽位表中非函数名（变量名）的编号
+const uint32_t NO_SLOT = 0xFFFFFFFFu;
+
+// 两遍扫描按函数归组：第一遍只取函数名并统计各函数的行数，据此在当前内存池（若有）中一次分配好
+// 各函数的变量列表，第二遍解析并追加，列表不再增长，内存池中不留废弃的旧存储
+class FunctionGrouper {
+public:
+    explicit FunctionGrouper(StringTable& table) : table(table) {}
     
-    std::string line;
-    // 跳过标题行
-    std::getline(file, line);
+    // 第一遍：登记一行的函数名并计数
+    void countRow(const char* cursor, const char* lineEnd) {
+        const char* begin;
+        const char* end;
+        if (!nextField(cursor, lineEnd, begin, end) || !nextField(cursor, lineEnd, begin, end)) {
+            return;
+        }
+        MemoryInstrument::PhaseScope groupScope(PHASE_GROUP);
+        field.assign(begin, end);
+        uint32_t funcId = table.intern(field);
+        if (funcId >= slots.size()) {
+            slots.resize(funcId + 1, NO_SLOT);
+        }
+        if (slots[funcId] == NO_SLOT) {
+            slots[funcId] = static_cast<uint32_t>(groups.size());
+            groups.push_back(std::make_pair(funcId, VariableList()));
+            counts.push_back(0);
+        }
+        counts[slots[funcId]]++;
+    }
     
-    // 读取每一行数据
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string token;
-        std::vector<std::string> tokens;
-        
-        // 将一行分割成多个字段
-        while (std::getline(ss, token, ',')) {
-            if (!token.empty()) {  // 只添加非空字段
-                tokens.push_back(token);
-            }
+    // 按计数为各函数分配变量列表
+    void reserve() {
+        MemoryInstrument::PhaseScope groupScope(PHASE_GROUP);
+        for (size_t i = 0; i < groups.size(); i++) {
+            groups[i].second.reserve(counts[i]);
         }
-        
-        // 检查是否至少有基本字段（变量名、函数名、元素数量、访问次数）
-        if (tokens.size() < 4) {
-            std::cerr << "警告: 行数据格式不正确，跳过该行" << std::endl;
-            continue;
+    }
+    
+    // 第二遍：解析一行并追加到所属函数，无效行给出警告后跳过
+    void addRow(const char* cursor, const char* lineEnd) {
+        const char* fields[2][2];
+        unsigned long long size, access;
+        if (!parseRowHeader(cursor, lineEnd, fields, size, access)) {
+            return;
         }
         
-        std::string varName = tokens[0];
-        std::string funcName = tokens[1];
-        unsigned long long size = std::stoull(tokens[2]);
-        unsigned long long access = std::stoull(tokens[3]);
-        
-        // 创建pattern信息
-        std::vector<std::pair<int, double>> patterns;
-        
         // 从第5个字段开始，每两个字段组成一对步长与占比
-        for (size_t i = 4; i + 1 < tokens.size(); i += 2) {
-            try {
-                int step = std::stoi(tokens[i]);
-                double percentage = std::stod(tokens[i + 1]) / 100.0;
-                patterns.push_back({step, percentage});
-            } catch (const std::exception& e) {
-                std::cerr << "警告: 解析步长或占比失败: " << e.what() << std::endl;
+        AccessPatterns patterns;
+        const char* strideBegin;
+        const char* strideEnd;
+        const char* begin;
+        const char* end;
+        char* parsedEnd;
+        while (nextField(cursor, lineEnd, strideBegin, strideEnd) && nextField(cursor, lineEnd, begin, end)) {
+            long step = std::strtol(strideBegin, &parsedEnd, 10);
+            if (parsedEnd == strideBegin) {
+                std::cerr << "警告: 解析步长或占比失败: stoi" << std::endl;
+                break;
+            }
+            double percentage = std::strtod(begin, &parsedEnd);
+            if (parsedEnd == begin) {
+                std::cerr << "警告: 解析步长或占比失败: stod" << std::endl;
                 break;
             }
+            patterns.push_back({static_cast<int>(step), percentage / 100.0});
         }
         
-        // 创建变量信息
-        VariableInfo varInfo(varName, size, access, patterns);
+        field.assign(fields[0][0], fields[0][1]);
+        InternedName varName(&table, table.intern(field));
+        field.assign(fields[1][0], fields[1][1]);
+        uint32_t funcId = table.intern(field);
         
-        // 将变量信息添加到对应的函数中
-        functionVariables[funcName].push_back(varInfo);
+        // 将变量信息添加到对应的函数中，函数已在第一遍登记
+        MemoryInstrument::PhaseScope groupScope(PHASE_GROUP);
+        groups[slots[funcId]].second.push_back(VariableInfo(varName, size, access, patterns));
     }
     
-    // 将map中的数据转换为FunctionInfo对象列表
-    std::vector<FunctionInfo> functions;
-    for (const auto& pair : functionVariables) {
-        functions.push_back(FunctionInfo(pair.first, pair.second));
+    // 按函数名排序生成函数列表，没有有效行的函数不输出
+    FunctionList finish() {
+        MemoryInstrument::PhaseScope groupScope(PHASE_GROUP);
+        StringTable& names = table;
+        std::sort(groups.begin(), groups.end(),
+                  [&names](const Group& a, const Group& b) { return names.get(a.first) < names.get(b.first); });
+        FunctionList functions;
+        functions.reserve(groups.size());
+        for (auto& group : groups) {
+            if (!group.second.empty()) {
+                functions.push_back(FunctionInfo(InternedName(&table, group.first), std::move(group.second)));
+            }
+        }
+        return functions;
+    }
+    
+private:
+    typedef std::pair<uint32_t, VariableList> Group;
+    
+    StringTable& table;
+    std::string field;
+    // 按驻留编号索引的函数槽位，变量名的编号为NO_SLOT
+    std::vector<uint32_t> slots;
+    // 按首次出现顺序排列的函数编号及其变量，以及第一遍统计的行数
+    std::vector<Group> groups;
+    std::vector<size_t> counts;
+};
+
+// 对标题行之后的每一行调用visitor(行首, 行尾)
+typedef std::function<void(const char*, const char*)> RowVisitor;
+
+// 用forEachRow遍历两遍数据行，解析并按函数归组
+FunctionList groupRows(StringTable& table, const std::function<void(const RowVisitor&)>& forEachRow) {
+    FunctionGrouper grouper(table);
+    forEachRow([&grouper](const char* begin, const char* end) { grouper.countRow(begin, end); });
+    grouper.reserve();
+    forEachRow([&grouper](const char* begin, const char* end) { grouper.addRow(begin, end); });
+    return grouper.finish();
+}
+
+} // namespace
+
+void OperatorInfo::getOperatorInfoFromCSV(const std::string& opName, const std::string& csvPath) {
+    // 设置算子名称，名称驻留到该算子自己的表中
+    this->name = opName;
+    this->names = std::make_shared<StringTable>();
+    
+    std::ifstream file(csvPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开文件: " << csvPath << std::endl;
+        return;
     }
     
-    // 设置functions成员变量
-    this->functions = functions;
+    // 每遍从文件头逐行读取，不保留整个文件；跳过标题行
+    this->functions = groupRows(*names, [&file](const RowVisitor& visit) {
+        file.clear();
+        file.seekg(0);
+        std::string line;
+        std::getline(file, line);
+        while (std::getline(file, line)) {
+            visit(line.data(), line.data() + line.size());
+        }
+    });
+}
+
+void OperatorInfo::getOperatorInfoFromBuffer(const std::string& opName, const std::string& content) {
+    // 设置算子名称，名称驻留到该算子自己的表中
+    this->name = opName;
+    this->names = std::make_shared<StringTable>();
     
-    file.close();
+    // 在缓冲区中逐行遍历，跳过标题行
+    this->functions = groupRows(*names, [&content](const RowVisitor& visit) {
+        const char* cursor = content.data();
+        const char* contentEnd = content.data() + content.size();
+        bool header = true;
+        while (cursor < contentEnd) {
+            const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', contentEnd - cursor));
+            if (lineEnd == nullptr) {
+                lineEnd = contentEnd;
+            }
+            if (!header) {
+                visit(cursor, lineEnd);
+            }
+            header = false;
+            cursor = lineEnd + 1;
+        }
+    });
 }
 
 void OperatorInfo::printInfo() const {
@@ -0,0 +1,228 @@
+#include "ParameterSweep.hpp"
+#include "ParallelFor.hpp"
+#include "StrategyCostModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// 解析字节数，支持K后缀
+bool parseBytes(const std::string &str, int &bytes)
+{
+    try {
+        size_t pos = 0;
+        double value = std::stod(str, &pos);
+        if (pos < str.size() && (str[pos] == 'K' || str[pos] == 'k')) {
+            value *= 1024;
+            pos++;
+        }
+        if (pos != str.size() || value <= 0) {
+            return false;
+        }
+        bytes = static_cast<int>(value);
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+std::vector<std::string> splitRange(const std::string &spec)
+{
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ':')) {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+} // namespace
+
+bool ParameterSweep::parseCTotalRange(const std::string &spec)
+{
+    std::vector<std::string> parts = splitRange(spec);
+    int minBytes, maxBytes;
+    if (parts.size() != 2 || !parseBytes(parts[0], minBytes) || !parseBytes(parts[1], maxBytes) ||
+        minBytes > maxBytes) {
+        return false;
+    }
+    cTotals.clear();
+    for (long long value = minBytes; value <= maxBytes; value *= 2) {
+        cTotals.push_back(static_cast<int>(value));
+    }
+    if (cTotals.back() != maxBytes) {
+        cTotals.push_back(maxBytes);
+    }
+    return true;
+}
+
+bool ParameterSweep::parseFactorRange(const std::string &spec)
+{
+    std::vector<std::string> parts = splitRange(spec);
+    try {
+        if (parts.size() == 1) {
+            factors.assign(1, std::stod(parts[0]));
+            return true;
+        }
+        if (parts.size() != 3) {
+            return false;
+        }
+        double minFactor = std::stod(parts[0]);
+        double maxFactor = std::stod(parts[1]);
+        double step = std::stod(parts[2]);
+        if (step <= 0 || minFactor > maxFactor) {
+            return false;
+        }
+        factors.clear();
+        // 按步数生成，避免浮点累加误差
+        int steps = static_cast<int>(std::floor((maxFactor - minFactor) / step + 1e-9));
+        for (int i = 0; i <= steps; i++) {
+            factors.push_back(minFactor + i * step);
+        }
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+ParameterSweep::SweepResult ParameterSweep::evaluate(const FunctionInfo &func, int C_total, double factor)
+{
+    DecisionThresholds thresholds = DecisionThresholds::getInstance();
+    thresholds.strategyDetermineFactor = factor;
+    ThresholdStrategyModel thresholdModel(thresholds);
+    const StrategyCostModel &defaultModel = StrategyCostModel::getDefault();
+
+    AccessStrategyDeducter deducter;
+    deducter.C_total = C_total;
+    // 策略决断常量只对阈值模型有意义，其它模型保持不变
+    deducter.costModel = (defaultModel.getName() == thresholdModel.getName()) ? &thresholdModel : &defaultModel;
+    deducter.deductAccessStrategy(func);
+
+    SweepResult result;
+    result.C_total = C_total;
+    result.factor = factor;
+    for (const auto &featureVector : deducter.accessFeatureVectors) {
+        AccessStrategy accessStrategy = featureVector.accessStrategyConfig.accessStrategy;
+        result.strategyCount[accessStrategy]++;
+        result.smUsage += featureVector.accessStrategyConfig.getSMFootprint();
+        result.transferCost += StrategyCostModel::getSelectedCycles(featureVector, deducter.profile);
+    }
+    return result;
+}
+
+std::vector<ParameterSweep::SweepResult> ParameterSweep::run(const std::vector<SweepInput> &inputs) const
+{
+    // 任务按 输入 × 函数 × C_total × 常量 展开，每个任务写入独立的结果槽
+    std::vector<SweepResult> results;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        for (size_t f = 0; f < inputs[i].op.functions.size(); f++) {
+            for (int C_total : cTotals) {
+                for (double factor : factors) {
+                    SweepResult slot;
+                    slot.inputIndex = i;
+                    slot.functionIndex = f;
+                    slot.C_total = C_total;
+                    slot.factor = factor;
+                    results.push_back(slot);
+                }
+            }
+        }
+    }
+
+    parallelFor(results.size(), jobs, [&](size_t task) {
+        SweepResult &slot = results[task];
+        // 每个任务的推断过程使用本线程的内存池，任务结束后整体回收
+        ArenaScope arenaScope(MonotonicArena::threadArena(), true);
+        const FunctionInfo &func = inputs[slot.inputIndex].op.functions[slot.functionIndex];
+        SweepResult result = evaluate(func, slot.C_total, slot.factor);
+        result.inputIndex = slot.inputIndex;
+        result.functionIndex = slot.functionIndex;
+        slot = result;
+    });
+
+    markParetoFront(results);
+    return results;
+}
+
+void ParameterSweep::markParetoFront(std::vector<SweepResult> &results)
+{
+    // 结果按函数连续存放；同一函数内，若不存在SM占用和代价都不更差且至少一项更好的点，则该点位于帕累托前沿
+    size_t begin = 0;
+    while (begin < results.size()) {
+        size_t end = begin;
+        while (end < results.size() && results[end].inputIndex == results[begin].inputIndex &&
+               results[end].functionIndex == results[begin].functionIndex) {
+            end++;
+        }
+        for (size_t i = begin; i < end; i++) {
+            SweepResult &candidate = results[i];
+            candidate.paretoOptimal = true;
+            for (size_t j = begin; j < end; j++) {
+                const SweepResult &other = results[j];
+                bool noWorse = other.smUsage <= candidate.smUsage && other.transferCost <= candidate.transferCost;
+                bool better = other.smUsage < candidate.smUsage || other.transferCost < candidate.transferCost;
+                if (noWorse && better) {
+                    candidate.paretoOptimal = false;
+                    break;
+                }
+            }
+        }
+        begin = end;
+    }
+}
+
+void ParameterSweep::printReport(const std::vector<SweepInput> &inputs, const std::vector<SweepResult> &results)
+{
+    std::cout << std::left << std::setw(24) << "Input" << std::setw(24) << "Function" << std::right << std::setw(8)
+              << "C_total" << std::setw(8) << "Factor" << std::setw(10) << "SM" << std::setw(16) << "Cost"
+              << "  B/S/D/U  Pareto" << std::endl;
+    for (const auto &result : results) {
+        const SweepInput &input = inputs[result.inputIndex];
+        std::cout << std::left << std::setw(24) << input.label << std::setw(24)
+                  << input.op.functions[result.functionIndex].name << std::right << std::setw(8) << result.C_total
+                  << std::setw(8) << std::fixed << std::setprecision(3) << result.factor << std::setw(10)
+                  << result.smUsage << std::setw(16) << std::setprecision(0) << result.transferCost << "  "
+                  << result.strategyCount[BULK] << "/" << result.strategyCount[SINGLE] << "/"
+                  << result.strategyCount[DIRECT] << "/" << result.strategyCount[UNSUITABLE]
+                  << (result.paretoOptimal ? "  *" : "") << std::endl;
+    }
+
+    // 帕累托前沿按SM占用升序输出，相同(SM, 代价)的网格点合并显示
+    std::cout << "\nPareto front (SM usage vs. predicted transfer cost):" << std::endl;
+    size_t begin = 0;
+    while (begin < results.size()) {
+        size_t end = begin;
+        while (end < results.size() && results[end].inputIndex == results[begin].inputIndex &&
+               results[end].functionIndex == results[begin].functionIndex) {
+            end++;
+        }
+        std::vector<const SweepResult *> front;
+        for (size_t i = begin; i < end; i++) {
+            if (results[i].paretoOptimal) {
+                front.push_back(&results[i]);
+            }
+        }
+        std::sort(front.begin(), front.end(), [](const SweepResult *a, const SweepResult *b) {
+            return (a->smUsage != b->smUsage) ? a->smUsage < b->smUsage : a->C_total < b->C_total;
+        });
+
+        const SweepInput &input = inputs[results[begin].inputIndex];
+        std::cout << "  " << input.label << " " << input.op.functions[results[begin].functionIndex].name << ":";
+        for (size_t i = 0; i < front.size(); i++) {
+            if (i > 0 && front[i]->smUsage == front[i - 1]->smUsage &&
+                front[i]->transferCost == front[i - 1]->transferCost) {
+                continue;
+            }
+            std::cout << " [SM=" << front[i]->smUsage << " cost=" << std::fixed << std::setprecision(0)
+                      << front[i]->transferCost << " @C=" << front[i]->C_total << ",f=" << std::setprecision(3)
+                      << front[i]->factor << "]";
+        }
+        std::cout << std::endl;
+        begin = end;
+    }
+}
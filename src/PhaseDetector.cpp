@@ -0,0 +1,512 @@
+#include "PhaseDetector.hpp"
+#include "MonotonicArena.hpp"
+#include "StrategyCostModel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+
+namespace
+{
+
+// 一个窗口内各变量（按内核内序号）的访问统计
+class PhaseWindow
+{
+public:
+    uint64_t begin = 0;
+    uint64_t accesses = 0;
+    std::vector<uint64_t> variableAccesses;
+    std::vector<MasamtTrace::StrideHistogram> strides;
+    std::vector<uint64_t> lines;
+};
+
+// 扫描中单个内核的状态
+class KernelScan
+{
+public:
+    // 内核的变量编号，按注册顺序
+    std::vector<uint32_t> members;
+    uint64_t total = 0;
+    uint64_t windowAccesses = 0;
+    uint64_t position = 0;
+    std::vector<PhaseWindow> windows;
+};
+
+// 单个(线程, 变量)访问序列的上一地址、上一缓存行及上一个地址块所在的窗口
+class StreamState
+{
+public:
+    uint64_t lastAddress = 0;
+    uint64_t lastLine = ~0ull;
+    size_t lastWindow = ~static_cast<size_t>(0);
+};
+
+// 候选切点
+class SegmentSplit
+{
+public:
+    size_t begin = 0;
+    size_t end = 0;
+    size_t split = 0;
+    double gain = -1.0;
+};
+
+std::atomic<bool> &enabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// 窗口签名：每个变量的主要步长、其余步长、不同缓存行数各占一维，均除以窗口访问次数
+std::vector<std::vector<double>> buildSignatures(const KernelScan &scan)
+{
+    std::vector<std::vector<int64_t>> topStrides(scan.members.size());
+    for (size_t slot = 0; slot < scan.members.size(); slot++) {
+        MasamtTrace::StrideHistogram merged;
+        for (const auto &window : scan.windows) {
+            merged.merge(window.strides[slot]);
+        }
+        for (const auto &stride : merged.top(TraceReader::MAX_STRIDES)) {
+            topStrides[slot].push_back(stride.first);
+        }
+    }
+
+    std::vector<std::vector<double>> signatures;
+    signatures.reserve(scan.windows.size());
+    for (const auto &window : scan.windows) {
+        std::vector<double> signature;
+        double accesses = static_cast<double>(std::max<uint64_t>(1, window.accesses));
+        for (size_t slot = 0; slot < scan.members.size(); slot++) {
+            const MasamtTrace::StrideHistogram &strides = window.strides[slot];
+            uint64_t covered = 0;
+            for (int64_t stride : topStrides[slot]) {
+                uint64_t count = strides.getCount(stride);
+                covered += count;
+                signature.push_back(count / accesses);
+            }
+            signature.push_back((strides.getTotal() - covered) / accesses);
+            signature.push_back(window.lines[slot] / accesses);
+        }
+        signatures.push_back(signature);
+    }
+    return signatures;
+}
+
+// 在[begin, end)内寻找使平方误差下降最多的切点，prefix为签名的前缀和
+SegmentSplit findSplit(const std::vector<std::vector<double>> &prefix, size_t begin, size_t end)
+{
+    SegmentSplit best;
+    best.begin = begin;
+    best.end = end;
+    size_t dims = prefix[0].size();
+    for (size_t split = begin + PhaseDetector::MIN_PHASE_WINDOWS; split + PhaseDetector::MIN_PHASE_WINDOWS <= end;
+         split++) {
+        double left = static_cast<double>(split - begin);
+        double right = static_cast<double>(end - split);
+        double distance = 0.0;
+        for (size_t d = 0; d < dims; d++) {
+            double delta = (prefix[split][d] - prefix[begin][d]) / left - (prefix[end][d] - prefix[split][d]) / right;
+            distance += delta * delta;
+        }
+        double gain = left * right / (left + right) * distance;
+        if (gain > best.gain) {
+            best.gain = gain;
+            best.split = split;
+        }
+    }
+    if (best.gain < 0) {
+        return best;
+    }
+    // 均值差异不足时不切分
+    double l1 = 0.0;
+    double left = static_cast<double>(best.split - begin);
+    double right = static_cast<double>(end - best.split);
+    for (size_t d = 0; d < dims; d++) {
+        l1 += std::fabs((prefix[best.split][d] - prefix[begin][d]) / left -
+                        (prefix[end][d] - prefix[best.split][d]) / right);
+    }
+    if (l1 < PhaseDetector::PHASE_DISTANCE) {
+        best.gain = -1.0;
+    }
+    return best;
+}
+
+// 二分分段，返回各段的起始窗口（含末尾的窗口总数）
+std::vector<size_t> segment(const std::vector<std::vector<double>> &signatures)
+{
+    size_t count = signatures.size();
+    std::vector<size_t> bounds = {0, count};
+    if (count < 2 * PhaseDetector::MIN_PHASE_WINDOWS || signatures[0].empty()) {
+        return bounds;
+    }
+    std::vector<std::vector<double>> prefix(count + 1, std::vector<double>(signatures[0].size(), 0.0));
+    for (size_t i = 0; i < count; i++) {
+        for (size_t d = 0; d < signatures[i].size(); d++) {
+            prefix[i + 1][d] = prefix[i][d] + signatures[i][d];
+        }
+    }
+
+    std::vector<SegmentSplit> candidates = {findSplit(prefix, 0, count)};
+    while (bounds.size() - 1 < PhaseDetector::MAX_PHASES) {
+        auto best = std::max_element(candidates.begin(), candidates.end(),
+                                     [](const SegmentSplit &a, const SegmentSplit &b) { return a.gain < b.gain; });
+        if (best == candidates.end() || best->gain < 0) {
+            break;
+        }
+        SegmentSplit chosen = *best;
+        candidates.erase(best);
+        bounds.insert(std::upper_bound(bounds.begin(), bounds.end(), chosen.split), chosen.split);
+        candidates.push_back(findSplit(prefix, chosen.begin, chosen.split));
+        candidates.push_back(findSplit(prefix, chosen.split, chosen.end));
+    }
+    return bounds;
+}
+
+// minShare大于0时，访问次数占比低于它的变量不参与推断，留在DDR中
+std::vector<PhaseAssignment> deduce(const std::string &kernel, const std::vector<TraceVariable> &variables,
+                                    double minShare, double &cycles)
+{
+    std::vector<PhaseAssignment> assignments;
+    cycles = 0.0;
+    uint64_t total = 0;
+    for (const auto &variable : variables) {
+        total += variable.accesses;
+    }
+    std::vector<TraceVariable> selected;
+    for (const auto &variable : variables) {
+        if (variable.accesses >= minShare * total) {
+            selected.push_back(variable);
+            continue;
+        }
+        PhaseAssignment assignment;
+        assignment.name = variable.name;
+        assignment.cycles = variable.accesses * HardwareProfile::getInstance().ddrLatency;
+        cycles += assignment.cycles;
+        assignments.push_back(assignment);
+    }
+
+    ArenaCheckpoint checkpoint;
+    OperatorInfo op;
+    TraceReader::buildOperatorInfo(kernel, selected, op);
+    if (op.functions.empty()) {
+        return assignments;
+    }
+    AccessStrategyDeducter deducter;
+    deducter.deductAccessStrategy(op.functions[0]);
+    for (const auto &featureVector : deducter.accessFeatureVectors) {
+        PhaseAssignment assignment;
+        assignment.name = featureVector.varName.str();
+        assignment.config = featureVector.accessStrategyConfig;
+        assignment.cycles = StrategyCostModel::getSelectedCycles(featureVector, deducter.profile);
+        cycles += assignment.cycles;
+        assignments.push_back(assignment);
+    }
+    return assignments;
+}
+
+bool sameConfig(const AccessStrategyConfig &a, const AccessStrategyConfig &b)
+{
+    return a.accessStrategy == b.accessStrategy && a.set == b.set && a.line == b.line;
+}
+
+const PhaseAssignment *findAssignment(const std::vector<PhaseAssignment> &assignments, const std::string &name)
+{
+    for (const auto &assignment : assignments) {
+        if (assignment.name == name) {
+            return &assignment;
+        }
+    }
+    return nullptr;
+}
+
+// 两个阶段中占用SM的变量及其配置完全相同
+bool sameAssignments(const std::vector<PhaseAssignment> &a, const std::vector<PhaseAssignment> &b)
+{
+    for (const auto *first : {&a, &b}) {
+        const std::vector<PhaseAssignment> &second = (first == &a) ? b : a;
+        for (const auto &assignment : *first) {
+            if (assignment.config.getSMFootprint() <= 0) {
+                continue;
+            }
+            const PhaseAssignment *other = findAssignment(second, assignment.name);
+            if (other == nullptr || !sameConfig(other->config, assignment.config)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 按名称累加变量统计，变量保持首次出现的顺序
+void mergeVariables(std::vector<TraceVariable> &target, const std::vector<TraceVariable> &source)
+{
+    for (const auto &variable : source) {
+        auto it = std::find_if(target.begin(), target.end(),
+                               [&](const TraceVariable &other) { return other.name == variable.name; });
+        if (it == target.end()) {
+            target.push_back(variable);
+        } else {
+            it->accesses += variable.accesses;
+            it->strides.merge(variable.strides);
+        }
+    }
+}
+
+std::string formatAssignment(const PhaseAssignment &assignment)
+{
+    const AccessStrategyConfig &config = assignment.config;
+    std::string text = assignment.name + "=" + config.getStrategyName();
+    switch (config.accessStrategy) {
+    case BULK:
+        return text + "(" + std::to_string(config.line) + "B)";
+    case SINGLE:
+        return text + "(line=" + std::to_string(config.line) + ")";
+    case DIRECT:
+        return text + "(set=" + std::to_string(config.set) + ",line=" + std::to_string(config.line) + ")";
+    default:
+        return text;
+    }
+}
+
+void printAssignments(const std::vector<PhaseAssignment> &assignments, std::ostream &os)
+{
+    for (const auto &assignment : assignments) {
+        os << " " << formatAssignment(assignment);
+    }
+}
+
+} // namespace
+
+double KernelPhases::getSaving() const
+{
+    return (singleCycles > 0) ? (singleCycles - phasedCycles) / singleCycles : 0.0;
+}
+
+bool KernelPhases::isReconfigurationWorthwhile() const
+{
+    return phases.size() > 1 && getSaving() >= PhaseDetector::RECONFIGURE_MARGIN;
+}
+
+bool PhaseDetector::isEnabled() { return enabledStorage().load(); }
+
+void PhaseDetector::setEnabled(bool enabled) { enabledStorage().store(enabled); }
+
+bool PhaseDetector::detect(const std::string &content, std::vector<KernelPhases> &kernels)
+{
+    kernels.clear();
+    std::vector<TraceVariable> variables;
+    MasamtTrace::SamplingConfig sampling;
+
+    // 第一遍只统计各变量的访问次数，用于确定窗口长度
+    std::vector<uint64_t> counts;
+    bool valid = TraceReader::readRawTrace(content, variables, sampling,
+                                           [&](const MasamtTrace::TraceBlockRecord &record, const char *) {
+                                               if (record.variable >= counts.size()) {
+                                                   counts.resize(record.variable + 1, 0);
+                                               }
+                                               counts[record.variable] += record.count;
+                                           });
+    if (!valid || sampling.isSampled()) {
+        return false;
+    }
+    counts.resize(variables.size(), 0);
+
+    std::map<std::string, KernelScan> scans;
+    std::vector<KernelScan *> kernelOf(variables.size(), nullptr);
+    std::vector<size_t> slotOf(variables.size(), 0);
+    for (size_t id = 0; id < variables.size(); id++) {
+        if (variables[id].name.empty()) {
+            continue;
+        }
+        KernelScan &scan = scans[variables[id].kernel];
+        kernelOf[id] = &scan;
+        slotOf[id] = scan.members.size();
+        scan.members.push_back(static_cast<uint32_t>(id));
+        scan.total += counts[id];
+    }
+    for (auto &entry : scans) {
+        KernelScan &scan = entry.second;
+        // 每个窗口至少容纳每个变量的两个地址块，使各变量在窗口内都有机会出现
+        uint64_t minimum = 2ull * MasamtTrace::TRACE_BLOCK_ADDRESSES * scan.members.size();
+        scan.windowAccesses = std::max(minimum, (scan.total + MAX_WINDOWS - 1) / MAX_WINDOWS);
+    }
+
+    // 第二遍按窗口统计步长与不同缓存行数
+    std::map<std::pair<uint32_t, uint32_t>, StreamState> streams;
+    std::vector<std::unordered_map<uint64_t, uint32_t>> lineWindows(variables.size());
+    TraceReader::readRawTrace(content, variables, sampling,
+                              [&](const MasamtTrace::TraceBlockRecord &record, const char *addresses) {
+        KernelScan &scan = *kernelOf[record.variable];
+        size_t slot = slotOf[record.variable];
+        StreamState &stream = streams[std::make_pair(record.thread, record.variable)];
+        // 未满的块在结束或手动刷新时才写出，其访问紧接该序列的上一个块，归入上一个块所在的窗口
+        bool partial = record.count < MasamtTrace::TRACE_BLOCK_ADDRESSES && stream.lastWindow < scan.windows.size();
+        if (!partial && (scan.windows.empty() || scan.windows.back().accesses >= scan.windowAccesses)) {
+            PhaseWindow window;
+            window.begin = scan.position;
+            window.variableAccesses.assign(scan.members.size(), 0);
+            window.strides.resize(scan.members.size());
+            window.lines.assign(scan.members.size(), 0);
+            scan.windows.push_back(std::move(window));
+        }
+        if (!partial) {
+            stream.lastWindow = scan.windows.size() - 1;
+        }
+        PhaseWindow &window = scan.windows[stream.lastWindow];
+        uint32_t windowIndex = static_cast<uint32_t>(stream.lastWindow + 1);
+        uint64_t elementSize = variables[record.variable].elementSize;
+        std::unordered_map<uint64_t, uint32_t> &seen = lineWindows[record.variable];
+        for (uint32_t i = 0; i < record.count; i++) {
+            uint64_t address;
+            memcpy(&address, addresses + i * sizeof(uint64_t), sizeof(address));
+            if (stream.lastAddress != 0) {
+                uint64_t distance = (address > stream.lastAddress) ? address - stream.lastAddress
+                                                                   : stream.lastAddress - address;
+                window.strides[slot].add(static_cast<int64_t>(distance / elementSize));
+            }
+            stream.lastAddress = address;
+            // 同一缓存行的连续访问只查一次表
+            uint64_t line = address / FOOTPRINT_LINE_BYTES;
+            if (line != stream.lastLine) {
+                stream.lastLine = line;
+                uint32_t &last = seen[line];
+                if (last != windowIndex) {
+                    last = windowIndex;
+                    window.lines[slot]++;
+                }
+            }
+        }
+        window.variableAccesses[slot] += record.count;
+        window.accesses += record.count;
+        scan.position += record.count;
+    });
+
+    for (auto &entry : scans) {
+        KernelScan &scan = entry.second;
+        if (scan.windows.empty()) {
+            continue;
+        }
+        KernelPhases result;
+        result.kernel = entry.first;
+        result.windowAccesses = scan.windowAccesses;
+        result.windows = scan.windows.size();
+        std::vector<size_t> bounds = segment(buildSignatures(scan));
+        for (size_t p = 0; p + 1 < bounds.size(); p++) {
+            TracePhase phase;
+            phase.begin = scan.windows[bounds[p]].begin;
+            phase.end = (bounds[p + 1] < scan.windows.size()) ? scan.windows[bounds[p + 1]].begin : scan.position;
+            phase.windows = bounds[p + 1] - bounds[p];
+            for (size_t slot = 0; slot < scan.members.size(); slot++) {
+                const TraceVariable &source = variables[scan.members[slot]];
+                TraceVariable variable;
+                variable.kernel = source.kernel;
+                variable.name = source.name;
+                variable.size = source.size;
+                variable.elementSize = source.elementSize;
+                for (size_t w = bounds[p]; w < bounds[p + 1]; w++) {
+                    variable.accesses += scan.windows[w].variableAccesses[slot];
+                    variable.strides.merge(scan.windows[w].strides[slot]);
+                }
+                if (variable.accesses > 0) {
+                    phase.variables.push_back(std::move(variable));
+                }
+            }
+            result.phases.push_back(std::move(phase));
+        }
+        kernels.push_back(std::move(result));
+    }
+    return true;
+}
+
+void PhaseDetector::evaluate(std::vector<KernelPhases> &kernels)
+{
+    const HardwareProfile &profile = HardwareProfile::getInstance();
+    for (auto &kernel : kernels) {
+        std::vector<TraceVariable> whole;
+        for (const auto &phase : kernel.phases) {
+            mergeVariables(whole, phase.variables);
+        }
+        kernel.single = deduce(kernel.kernel, whole, 0.0, kernel.singleCycles);
+
+        std::vector<TracePhase> &phases = kernel.phases;
+        if (phases.size() == 1) {
+            phases[0].assignments = kernel.single;
+            phases[0].cycles = kernel.singleCycles;
+        } else {
+            for (auto &phase : phases) {
+                phase.assignments = deduce(kernel.kernel, phase.variables, MIN_PHASE_SHARE, phase.cycles);
+            }
+        }
+        // 相邻阶段的配置相同时无需重配置，合并后重新推断
+        for (size_t p = 0; p + 1 < phases.size();) {
+            if (!sameAssignments(phases[p].assignments, phases[p + 1].assignments)) {
+                p++;
+                continue;
+            }
+            mergeVariables(phases[p].variables, phases[p + 1].variables);
+            phases[p].end = phases[p + 1].end;
+            phases[p].windows += phases[p + 1].windows;
+            phases.erase(phases.begin() + p + 1);
+            phases[p].assignments = deduce(kernel.kernel, phases[p].variables,
+                                           (phases.size() > 1) ? MIN_PHASE_SHARE : 0.0, phases[p].cycles);
+        }
+
+        kernel.phasedCycles = 0.0;
+        for (size_t p = 0; p < phases.size(); p++) {
+            TracePhase &phase = phases[p];
+            phase.reconfigureCycles = 0.0;
+            kernel.phasedCycles += phase.cycles;
+            if (p + 1 == phases.size()) {
+                break;
+            }
+            for (const auto &assignment : phase.assignments) {
+                int footprint = assignment.config.getSMFootprint();
+                const PhaseAssignment *next = findAssignment(phases[p + 1].assignments, assignment.name);
+                if (footprint > 0 && (next == nullptr || !sameConfig(next->config, assignment.config))) {
+                    phase.reconfigureCycles += profile.dmaCycles(footprint);
+                }
+            }
+            kernel.phasedCycles += phase.reconfigureCycles;
+        }
+    }
+}
+
+void PhaseDetector::printReport(const std::vector<KernelPhases> &kernels, std::ostream &os)
+{
+    for (const auto &kernel : kernels) {
+        os << "[阶段检测] " << kernel.kernel << ": " << kernel.windows << "个窗口，每个约" << kernel.windowAccesses
+           << "次访问，检测到" << kernel.phases.size() << "个阶段" << std::endl;
+        if (kernel.phases.size() < 2) {
+            os << "  单一配置:";
+            printAssignments(kernel.single, os);
+            os << ", 周期=" << StrategyCosts::formatCycles(kernel.singleCycles) << std::endl << std::endl;
+            continue;
+        }
+        for (size_t p = 0; p < kernel.phases.size(); p++) {
+            const TracePhase &phase = kernel.phases[p];
+            os << "  阶段" << p + 1 << " 访问[" << phase.begin << ", " << phase.end << "), " << phase.windows
+               << "个窗口:";
+            printAssignments(phase.assignments, os);
+            os << ", 周期=" << StrategyCosts::formatCycles(phase.cycles);
+            if (p + 1 < kernel.phases.size()) {
+                os << ", 重配置=" << StrategyCosts::formatCycles(phase.reconfigureCycles);
+            }
+            os << std::endl;
+        }
+        os << "  单一配置:";
+        printAssignments(kernel.single, os);
+        os << ", 周期=" << StrategyCosts::formatCycles(kernel.singleCycles) << std::endl;
+        os << "  分阶段周期=" << StrategyCosts::formatCycles(kernel.phasedCycles) << "（含重配置），节省" << std::fixed
+           << std::setprecision(1) << kernel.getSaving() * 100 << "%: ";
+        os.unsetf(std::ios::fixed);
+        if (kernel.isReconfigurationWorthwhile()) {
+            os << "建议在阶段之间重配置缓存" << std::endl;
+        } else {
+            os << "低于" << RECONFIGURE_MARGIN * 100 << "%，保持单一配置" << std::endl;
+        }
+        os << std::endl;
+    }
+}
@@ -0,0 +1,693 @@
+#include "ResultDiff.hpp"
+#include "FileUtils.hpp"
+#include "ParallelFor.hpp"
+#include "ResultSink.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+
+const char KEY_SEPARATOR = '\x1f';
+const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+// CSV文件切块的最小字节数
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+uint64_t hashKey(const std::string &key)
+{
+    // FNV-1a
+    uint64_t value = 14695981039346656037ULL;
+    for (unsigned char ch : key) {
+        value ^= ch;
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+// 待解析的结果文件，CSV记录列号，二进制记录字段偏移
+struct ResultFile
+{
+    std::string opName;
+    std::string content;
+    bool binary = false;
+    size_t bodyOffset = 0;
+    // CSV列号，-1表示不存在
+    int datasetColumn = -1;
+    int functionColumn = -1;
+    int variableColumn = -1;
+    int strategyColumn = -1;
+    int lineColumn = -1;
+    int setColumn = -1;
+    // 二进制记录布局
+    uint32_t recordSize = 0;
+    uint32_t datasetOffset = 0;
+    uint32_t datasetLength = 0;
+    uint32_t functionOffset = 0;
+    uint32_t functionLength = 0;
+    uint32_t variableOffset = 0;
+    uint32_t variableLength = 0;
+    uint32_t strategyOffset = 0;
+    uint32_t lineOffset = 0;
+    uint32_t setOffset = 0;
+    // 标志位字段，旧版本文件没有
+    bool hasFlags = false;
+    uint32_t flagsOffset = 0;
+};
+
+// 一个解析任务：文件内[begin, end)字节范围
+struct ParseTask
+{
+    size_t fileIndex = 0;
+    size_t begin = 0;
+    size_t end = 0;
+    std::vector<ResultDiff::ResultRow> rows;
+    size_t skippedRows = 0;
+    size_t truncatedRows = 0;
+};
+
+bool readFile(const std::string &path, std::string &content)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开文件: " << path << std::endl;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::streamoff length = file.tellg();
+    content.clear();
+    if (length > 0) {
+        content.resize(static_cast<size_t>(length));
+        file.seekg(0, std::ios::beg);
+        file.read(&content[0], length);
+    }
+    return true;
+}
+
+// 解析CSV标题行，确定各列位置
+bool parseCSVHeader(ResultFile &file)
+{
+    const std::string &content = file.content;
+    size_t begin = (content.compare(0, 3, "\xEF\xBB\xBF") == 0) ? 3 : 0;
+    size_t end = content.find('\n', begin);
+    file.bodyOffset = (end == std::string::npos) ? content.size() : end + 1;
+    if (end == std::string::npos) {
+        end = content.size();
+    }
+    if (end > begin && content[end - 1] == '\r') {
+        end--;
+    }
+
+    int column = 0;
+    while (begin <= end) {
+        size_t comma = content.find(',', begin);
+        size_t fieldEnd = (comma == std::string::npos || comma > end) ? end : comma;
+        std::string name = content.substr(begin, fieldEnd - begin);
+        if (name == "计算负载") {
+            file.datasetColumn = column;
+        } else if (name == "核函数名") {
+            file.functionColumn = column;
+        } else if (name == "变量名") {
+            file.variableColumn = column;
+        } else if (name == "访存策略名") {
+            file.strategyColumn = column;
+        } else if (name == "line") {
+            file.lineColumn = column;
+        } else if (name == "set") {
+            file.setColumn = column;
+        }
+        column++;
+        begin = fieldEnd + 1;
+    }
+    return file.functionColumn >= 0 && file.variableColumn >= 0 && file.strategyColumn >= 0 &&
+           file.lineColumn >= 0 && file.setColumn >= 0;
+}
+
+// 解析二进制结果文件头，按字段名定位所需字段
+bool parseBinaryHeader(ResultFile &file)
+{
+    const std::string &content = file.content;
+    BinaryResultHeader header;
+    if (content.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, content.data(), sizeof(header));
+    if (memcmp(header.magic, "MASAMTR", 8) != 0 || header.headerSize > content.size() || header.recordSize == 0 ||
+        sizeof(header) + static_cast<size_t>(header.fieldCount) * sizeof(BinaryFieldDescriptor) > header.headerSize) {
+        return false;
+    }
+
+    int found = 0;
+    for (uint32_t i = 0; i < header.fieldCount; i++) {
+        BinaryFieldDescriptor field;
+        memcpy(&field, content.data() + sizeof(header) + i * sizeof(field), sizeof(field));
+        std::string name(field.name, strnlen(field.name, sizeof(field.name)));
+        if (field.offset + field.count * (field.type == FIELD_CHAR ? 1u : 4u) > header.recordSize) {
+            return false;
+        }
+        if (field.type == FIELD_CHAR && name == "dataset") {
+            file.datasetOffset = field.offset;
+            file.datasetLength = field.count;
+        } else if (field.type == FIELD_CHAR && name == "function") {
+            file.functionOffset = field.offset;
+            file.functionLength = field.count;
+            found++;
+        } else if (field.type == FIELD_CHAR && name == "variable") {
+            file.variableOffset = field.offset;
+            file.variableLength = field.count;
+            found++;
+        } else if (field.type == FIELD_INT32 && name == "strategy") {
+            file.strategyOffset = field.offset;
+            found++;
+        } else if (field.type == FIELD_INT32 && name == "line") {
+            file.lineOffset = field.offset;
+            found++;
+        } else if (field.type == FIELD_INT32 && name == "set") {
+            file.setOffset = field.offset;
+            found++;
+        } else if (field.type == FIELD_UINT32 && name == "flags") {
+            file.flagsOffset = field.offset;
+            file.hasFlags = true;
+        }
+    }
+    file.recordSize = header.recordSize;
+    file.bodyOffset = header.headerSize;
+    return found == 5;
+}
+
+// 组装连接键：算子、数据集（去掉_DATASET后缀）、函数、变量
+void buildKey(std::string &key, const std::string &opName, const char *dataset, size_t datasetLength,
+              const char *function, size_t functionLength, const char *variable, size_t variableLength)
+{
+    static const char SUFFIX[] = "_DATASET";
+    const size_t suffixLength = sizeof(SUFFIX) - 1;
+    if (datasetLength > suffixLength && memcmp(dataset + datasetLength - suffixLength, SUFFIX, suffixLength) == 0) {
+        datasetLength -= suffixLength;
+    }
+    key.clear();
+    key.reserve(opName.size() + datasetLength + functionLength + variableLength + 3);
+    key += opName;
+    key += KEY_SEPARATOR;
+    key.append(dataset, datasetLength);
+    key += KEY_SEPARATOR;
+    key.append(function, functionLength);
+    key += KEY_SEPARATOR;
+    key.append(variable, variableLength);
+}
+
+// 计算哈希与SM占用，set/line超出合理范围（如C为0时的SINGLE）时SM占用记为0
+void finishRow(ResultDiff::ResultRow &row)
+{
+    row.hash = hashKey(row.key);
+    bool validShift = row.set >= 0 && row.line >= 0 && row.set + row.line <= 30;
+    row.smUsage = (row.accessStrategy == BULK || validShift) ? row.getConfig().getSMFootprint() : 0;
+}
+
+void parseCSVChunk(const ResultFile &file, ParseTask &task)
+{
+    const int MAX_COLUMNS = 64;
+    const char *fields[MAX_COLUMNS][2];
+    int lastColumn = std::max(std::max(std::max(file.datasetColumn, file.functionColumn), file.variableColumn),
+                              std::max(std::max(file.strategyColumn, file.lineColumn), file.setColumn));
+    if (lastColumn >= MAX_COLUMNS) {
+        return;
+    }
+
+    const char *cursor = file.content.data() + task.begin;
+    const char *chunkEnd = file.content.data() + task.end;
+    while (cursor < chunkEnd) {
+        const char *lineEnd = static_cast<const char *>(memchr(cursor, '\n', chunkEnd - cursor));
+        if (lineEnd == nullptr) {
+            lineEnd = chunkEnd;
+        }
+        const char *next = lineEnd + 1;
+        if (lineEnd > cursor && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+        if (lineEnd == cursor) {
+            cursor = next;
+            continue;
+        }
+
+        int column = 0;
+        const char *fieldBegin = cursor;
+        while (column <= lastColumn) {
+            const char *comma = static_cast<const char *>(memchr(fieldBegin, ',', lineEnd - fieldBegin));
+            const char *fieldEnd = (comma == nullptr) ? lineEnd : comma;
+            fields[column][0] = fieldBegin;
+            fields[column][1] = fieldEnd;
+            column++;
+            if (comma == nullptr) {
+                break;
+            }
+            fieldBegin = comma + 1;
+        }
+        cursor = next;
+
+        ResultDiff::ResultRow row;
+        if (column <= lastColumn ||
+            !ResultDiff::parseStrategyName(fields[file.strategyColumn][0], fields[file.strategyColumn][1],
+                                           row.accessStrategy)) {
+            task.skippedRows++;
+            continue;
+        }
+        row.line = static_cast<int>(strtol(fields[file.lineColumn][0], nullptr, 10));
+        row.set = static_cast<int>(strtol(fields[file.setColumn][0], nullptr, 10));
+        const char *dataset = (file.datasetColumn >= 0) ? fields[file.datasetColumn][0] : "";
+        size_t datasetLength = (file.datasetColumn >= 0) ? fields[file.datasetColumn][1] - dataset : 0;
+        buildKey(row.key, file.opName, dataset, datasetLength, fields[file.functionColumn][0],
+                 fields[file.functionColumn][1] - fields[file.functionColumn][0], fields[file.variableColumn][0],
+                 fields[file.variableColumn][1] - fields[file.variableColumn][0]);
+        finishRow(row);
+        task.rows.push_back(std::move(row));
+    }
+}
+
+void parseBinaryChunk(const ResultFile &file, ParseTask &task)
+{
+    task.rows.reserve((task.end - task.begin) / file.recordSize);
+    for (size_t offset = task.begin; offset + file.recordSize <= task.end; offset += file.recordSize) {
+        const char *record = file.content.data() + offset;
+        int32_t strategy, line, set;
+        memcpy(&strategy, record + file.strategyOffset, sizeof(strategy));
+        memcpy(&line, record + file.lineOffset, sizeof(line));
+        memcpy(&set, record + file.setOffset, sizeof(set));
+        if (strategy < BULK || strategy > UNSUITABLE) {
+            task.skippedRows++;
+            continue;
+        }
+        // 名称被截断的记录无法可靠地与另一侧匹配
+        uint32_t flags = 0;
+        if (file.hasFlags) {
+            memcpy(&flags, record + file.flagsOffset, sizeof(flags));
+        }
+        if ((flags & BinaryResultRecord::FLAG_NAME_TRUNCATED) != 0) {
+            task.truncatedRows++;
+            continue;
+        }
+        ResultDiff::ResultRow row;
+        row.accessStrategy = static_cast<AccessStrategy>(strategy);
+        row.line = line;
+        row.set = set;
+        const char *dataset = record + file.datasetOffset;
+        const char *function = record + file.functionOffset;
+        const char *variable = record + file.variableOffset;
+        buildKey(row.key, file.opName, dataset, strnlen(dataset, file.datasetLength), function,
+                 strnlen(function, file.functionLength), variable, strnlen(variable, file.variableLength));
+        finishRow(row);
+        task.rows.push_back(std::move(row));
+    }
+}
+
+/**
+ * 扁平哈希索引：开放寻址、线性探测，槽中只保存行号。
+ * 同一键出现多次时保留最后一行。
+ */
+class RowIndex
+{
+public:
+    void build(const std::vector<ResultDiff::ResultRow> &rows, std::vector<uint32_t> &unique, size_t &duplicates)
+    {
+        this->rows = &rows;
+        size_t capacity = 16;
+        while (capacity < rows.size() * 2) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, EMPTY_SLOT);
+        mask = capacity - 1;
+        duplicates = 0;
+        for (uint32_t i = 0; i < rows.size(); i++) {
+            size_t slot = rows[i].hash & mask;
+            while (slots[slot] != EMPTY_SLOT && !sameKey(rows[slots[slot]], rows[i])) {
+                slot = (slot + 1) & mask;
+            }
+            if (slots[slot] != EMPTY_SLOT) {
+                duplicates++;
+            }
+            slots[slot] = i;
+        }
+        unique.clear();
+        unique.reserve(rows.size() - duplicates);
+        for (uint32_t index : slots) {
+            if (index != EMPTY_SLOT) {
+                unique.push_back(index);
+            }
+        }
+        std::sort(unique.begin(), unique.end());
+    }
+
+    uint32_t find(const ResultDiff::ResultRow &row) const
+    {
+        size_t slot = row.hash & mask;
+        while (slots[slot] != EMPTY_SLOT) {
+            if (sameKey((*rows)[slots[slot]], row)) {
+                return slots[slot];
+            }
+            slot = (slot + 1) & mask;
+        }
+        return EMPTY_SLOT;
+    }
+
+private:
+    const std::vector<ResultDiff::ResultRow> *rows = nullptr;
+    std::vector<uint32_t> slots;
+    size_t mask = 0;
+
+    static bool sameKey(const ResultDiff::ResultRow &a, const ResultDiff::ResultRow &b)
+    {
+        return a.hash == b.hash && a.key == b.key;
+    }
+};
+
+// 变化类别，用于明细排序：策略变化、参数变化、删除、新增
+int changeCategory(const ResultDiff::RowChange &change)
+{
+    if (change.before == nullptr) {
+        return 3;
+    }
+    if (change.after == nullptr) {
+        return 2;
+    }
+    return (change.before->accessStrategy != change.after->accessStrategy) ? 0 : 1;
+}
+
+std::string describeRow(const ResultDiff::ResultRow &row)
+{
+    std::ostringstream oss;
+    oss << row.getConfig().getStrategyName() << "(set=" << row.set << ",line=" << row.line << ")";
+    return oss.str();
+}
+
+std::string shortStrategyName(int accessStrategy)
+{
+    return AccessStrategyConfig(static_cast<AccessStrategy>(accessStrategy)).getStrategyName().substr(6);
+}
+
+} // namespace
+
+void ResultDiff::DiffSummary::merge(const DiffSummary &other)
+{
+    matched += other.matched;
+    unchanged += other.unchanged;
+    strategyChanged += other.strategyChanged;
+    parameterChanged += other.parameterChanged;
+    added += other.added;
+    removed += other.removed;
+    smUsageA += other.smUsageA;
+    smUsageB += other.smUsageB;
+    for (int from = 0; from <= UNSUITABLE; from++) {
+        for (int to = 0; to <= UNSUITABLE; to++) {
+            transitions[from][to] += other.transitions[from][to];
+        }
+    }
+}
+
+unsigned int ResultDiff::getThreadCount() const
+{
+    return (jobs > 0) ? jobs : std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool ResultDiff::parseStrategyName(const char *begin, const char *end, AccessStrategy &accessStrategy)
+{
+    std::string name(begin, end);
+    for (int candidate = BULK; candidate <= UNSUITABLE; candidate++) {
+        if (name == AccessStrategyConfig(static_cast<AccessStrategy>(candidate)).getStrategyName()) {
+            accessStrategy = static_cast<AccessStrategy>(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ResultDiff::formatKey(const std::string &key)
+{
+    std::string formatted;
+    size_t begin = 0;
+    while (begin <= key.size()) {
+        size_t end = key.find(KEY_SEPARATOR, begin);
+        if (end == std::string::npos) {
+            end = key.size();
+        }
+        if (end > begin) {
+            if (!formatted.empty()) {
+                formatted += '/';
+            }
+            formatted.append(key, begin, end - begin);
+        }
+        begin = end + 1;
+    }
+    return formatted;
+}
+
+bool ResultDiff::load(const std::string &path, ResultSet &resultSet) const
+{
+    resultSet.path = path;
+    std::vector<std::string> paths;
+    bool isDirectory = FileUtils::isDirectory(path);
+    if (isDirectory) {
+        // 同一算子同时存在.bin与.csv时只读取.bin
+        std::vector<std::string> binFiles = FileUtils::getFilesWithExtension(path, ".bin");
+        std::vector<std::string> csvFiles = FileUtils::getCSVFiles(path);
+        std::sort(binFiles.begin(), binFiles.end());
+        std::sort(csvFiles.begin(), csvFiles.end());
+        for (const auto &csvFile : csvFiles) {
+            std::string stem = FileUtils::getFileNameWithoutExtension(csvFile);
+            if (!std::binary_search(binFiles.begin(), binFiles.end(), stem + ".bin")) {
+                paths.push_back(path + "/" + csvFile);
+            }
+        }
+        for (const auto &binFile : binFiles) {
+            paths.push_back(path + "/" + binFile);
+        }
+        std::sort(paths.begin(), paths.end());
+    } else if (FileUtils::fileExists(path)) {
+        paths.push_back(path);
+    } else {
+        std::cerr << "错误: 结果路径不存在 " << path << std::endl;
+        return false;
+    }
+
+    // 读入文件并解析头部
+    std::vector<ResultFile> files;
+    for (const auto &filePath : paths) {
+        ResultFile file;
+        if (!readFile(filePath, file.content)) {
+            continue;
+        }
+        file.opName = isDirectory ? FileUtils::getFileNameWithoutExtension(filePath) : "";
+        file.binary = filePath.size() > 4 && filePath.compare(filePath.size() - 4, 4, ".bin") == 0;
+        if (!(file.binary ? parseBinaryHeader(file) : parseCSVHeader(file))) {
+            std::cerr << "警告: 无法识别的结果文件格式，跳过 " << filePath << std::endl;
+            continue;
+        }
+        files.push_back(std::move(file));
+    }
+    resultSet.fileCount = files.size();
+    if (files.empty()) {
+        std::cerr << "错误: 未找到结果文件 " << path << std::endl;
+        return false;
+    }
+
+    // 按行（记录）边界切块
+    unsigned int threadCount = getThreadCount();
+    std::vector<ParseTask> tasks;
+    for (size_t i = 0; i < files.size(); i++) {
+        const ResultFile &file = files[i];
+        size_t bodySize = file.content.size() - file.bodyOffset;
+        size_t chunkSize = std::max<size_t>(MIN_CHUNK_BYTES, bodySize / (threadCount * 4) + 1);
+        if (file.binary) {
+            chunkSize = (chunkSize / file.recordSize + 1) * file.recordSize;
+        }
+        size_t begin = file.bodyOffset;
+        while (begin < file.content.size()) {
+            size_t end = std::min(file.content.size(), begin + chunkSize);
+            if (!file.binary && end < file.content.size()) {
+                size_t newline = file.content.find('\n', end);
+                end = (newline == std::string::npos) ? file.content.size() : newline + 1;
+            }
+            ParseTask task;
+            task.fileIndex = i;
+            task.begin = begin;
+            task.end = end;
+            tasks.push_back(std::move(task));
+            begin = end;
+        }
+    }
+
+    parallelFor(tasks.size(), threadCount, [&](size_t index) {
+        ParseTask &task = tasks[index];
+        const ResultFile &file = files[task.fileIndex];
+        if (file.binary) {
+            parseBinaryChunk(file, task);
+        } else {
+            parseCSVChunk(file, task);
+        }
+    });
+
+    size_t total = 0;
+    for (const auto &task : tasks) {
+        total += task.rows.size();
+    }
+    resultSet.rows.clear();
+    resultSet.rows.reserve(total);
+    resultSet.skippedRows = 0;
+    resultSet.truncatedRows = 0;
+    for (auto &task : tasks) {
+        std::move(task.rows.begin(), task.rows.end(), std::back_inserter(resultSet.rows));
+        resultSet.skippedRows += task.skippedRows;
+        resultSet.truncatedRows += task.truncatedRows;
+    }
+    if (resultSet.skippedRows > 0) {
+        std::cerr << "警告: " << path << " 中有 " << resultSet.skippedRows << " 行格式不正确，已跳过" << std::endl;
+    }
+    if (resultSet.truncatedRows > 0) {
+        std::cerr << "警告: " << path << " 中有 " << resultSet.truncatedRows << " 条记录的名称被截断，已跳过" << std::endl;
+    }
+    return true;
+}
+
+ResultDiff::DiffSummary ResultDiff::compare(const ResultSet &a, const ResultSet &b,
+                                            std::vector<RowChange> &changes) const
+{
+    DiffSummary summary;
+    summary.rowsA = a.rows.size();
+    summary.rowsB = b.rows.size();
+
+    RowIndex indexA, indexB;
+    std::vector<uint32_t> uniqueA, uniqueB;
+    indexA.build(a.rows, uniqueA, summary.duplicatesA);
+    indexB.build(b.rows, uniqueB, summary.duplicatesB);
+
+    // 以A侧为探测侧并行连接，每个线程块写入独立的统计与变化列表
+    unsigned int threadCount = getThreadCount();
+    size_t blockCount = std::max<size_t>(1, std::min<size_t>(threadCount * 4, uniqueA.size() / 4096 + 1));
+    size_t blockSize = (uniqueA.size() + blockCount - 1) / blockCount;
+    std::vector<DiffSummary> blockSummaries(blockCount);
+    std::vector<std::vector<RowChange>> blockChanges(blockCount);
+    std::vector<uint8_t> matchedB(b.rows.size(), 0);
+    parallelFor(blockCount, threadCount, [&](size_t block) {
+        DiffSummary &local = blockSummaries[block];
+        std::vector<RowChange> &localChanges = blockChanges[block];
+        size_t end = std::min(uniqueA.size(), (block + 1) * blockSize);
+        for (size_t i = block * blockSize; i < end; i++) {
+            const ResultRow &before = a.rows[uniqueA[i]];
+            local.smUsageA += before.smUsage;
+            uint32_t match = indexB.find(before);
+            RowChange change;
+            change.before = &before;
+            if (match == EMPTY_SLOT) {
+                local.removed++;
+                localChanges.push_back(change);
+                continue;
+            }
+            const ResultRow &after = b.rows[match];
+            matchedB[match] = 1;
+            local.matched++;
+            local.transitions[before.accessStrategy][after.accessStrategy]++;
+            change.after = &after;
+            if (before.accessStrategy != after.accessStrategy) {
+                local.strategyChanged++;
+                localChanges.push_back(change);
+            } else if (before.set != after.set || before.line != after.line) {
+                local.parameterChanged++;
+                localChanges.push_back(change);
+            } else {
+                local.unchanged++;
+            }
+        }
+    });
+
+    changes.clear();
+    for (size_t block = 0; block < blockCount; block++) {
+        summary.merge(blockSummaries[block]);
+        changes.insert(changes.end(), blockChanges[block].begin(), blockChanges[block].end());
+    }
+    for (uint32_t index : uniqueB) {
+        summary.smUsageB += b.rows[index].smUsage;
+        if (!matchedB[index]) {
+            summary.added++;
+            RowChange change;
+            change.after = &b.rows[index];
+            changes.push_back(change);
+        }
+    }
+    return summary;
+}
+
+void ResultDiff::printReport(const ResultSet &a, const ResultSet &b, const DiffSummary &summary,
+                             std::vector<RowChange> &changes) const
+{
+    std::cout << "A: " << a.path << " (" << summary.rowsA << " rows, " << a.fileCount << " files)" << std::endl;
+    std::cout << "B: " << b.path << " (" << summary.rowsB << " rows, " << b.fileCount << " files)" << std::endl;
+    if (summary.duplicatesA > 0 || summary.duplicatesB > 0) {
+        std::cout << "Duplicate rows (last one kept): A " << summary.duplicatesA << ", B " << summary.duplicatesB
+                  << std::endl;
+    }
+    if (a.truncatedRows > 0 || b.truncatedRows > 0) {
+        std::cout << "Skipped rows with truncated names: A " << a.truncatedRows << ", B " << b.truncatedRows
+                  << std::endl;
+    }
+    std::cout << "\nMatched: " << summary.matched << "  Unchanged: " << summary.unchanged
+              << "  Strategy changed: " << summary.strategyChanged
+              << "  Parameters changed: " << summary.parameterChanged << "  Removed: " << summary.removed
+              << "  Added: " << summary.added << std::endl;
+    std::cout << "SM usage: " << summary.smUsageA << " -> " << summary.smUsageB << " (" << std::showpos
+              << (summary.smUsageB - summary.smUsageA) << std::noshowpos << ")" << std::endl;
+
+    // 策略转移矩阵，行为A侧策略，列为B侧策略
+    std::cout << "\nStrategy transitions (rows: A, columns: B):" << std::endl;
+    std::cout << std::left << std::setw(12) << "" << std::right;
+    for (int to = 0; to <= UNSUITABLE; to++) {
+        std::cout << std::setw(12) << shortStrategyName(to);
+    }
+    std::cout << std::endl;
+    for (int from = 0; from <= UNSUITABLE; from++) {
+        std::cout << std::left << std::setw(12) << shortStrategyName(from) << std::right;
+        for (int to = 0; to <= UNSUITABLE; to++) {
+            std::cout << std::setw(12) << summary.transitions[from][to];
+        }
+        std::cout << std::endl;
+    }
+
+    if (changes.empty()) {
+        return;
+    }
+
+    // 明细按类别排序，同类别内SM占用变化大的在前
+    size_t shown = std::min(detailLimit, changes.size());
+    auto order = [](const RowChange &x, const RowChange &y) {
+        int categoryX = changeCategory(x);
+        int categoryY = changeCategory(y);
+        if (categoryX != categoryY) {
+            return categoryX < categoryY;
+        }
+        long long deltaX = std::llabs(x.getSMDelta());
+        long long deltaY = std::llabs(y.getSMDelta());
+        if (deltaX != deltaY) {
+            return deltaX > deltaY;
+        }
+        return (x.before ? x.before : x.after)->key < (y.before ? y.before : y.after)->key;
+    };
+    std::partial_sort(changes.begin(), changes.begin() + shown, changes.end(), order);
+
+    std::cout << "\nChanges (showing " << shown << " of " << changes.size() << "):" << std::endl;
+    for (size_t i = 0; i < shown; i++) {
+        const RowChange &change = changes[i];
+        const ResultRow &row = change.before ? *change.before : *change.after;
+        std::cout << "  " << formatKey(row.key) << ": ";
+        if (change.before == nullptr) {
+            std::cout << "added " << describeRow(*change.after);
+        } else if (change.after == nullptr) {
+            std::cout << "removed " << describeRow(*change.before);
+        } else {
+            std::cout << describeRow(*change.before) << " -> " << describeRow(*change.after);
+        }
+        std::cout << " SM " << std::showpos << change.getSMDelta() << std::noshowpos << std::endl;
+    }
+}
@@ -0,0 +1,427 @@
+#include "ResultSink.hpp"
+#include "CSVHandler.hpp"
+#include "FileUtils.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+
+// 追加JSON字符串字面量，转义引号、反斜杠与控制字符
+void appendJSONString(std::string &out, const std::string &value)
+{
+    out += '"';
+    for (char ch : value) {
+        switch (ch) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(ch));
+                out += escaped;
+            } else {
+                out += ch;
+            }
+        }
+    }
+    out += '"';
+}
+
+// 追加JSON数值，非有限值（不可行策略的代价）输出为null
+void appendJSONNumber(std::string &out, double value, const char *format = "%.10g")
+{
+    if (!std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), format, value);
+    out += buffer;
+}
+
+void appendJSONInteger(std::string &out, unsigned long long value)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%llu", value);
+    out += buffer;
+}
+
+void appendJSONInteger(std::string &out, long long value)
+{
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%lld", value);
+    out += buffer;
+}
+
+// 复制名称到定长字段，超长时截断并保证以'\0'结尾，返回是否截断
+bool copyName(char *dest, size_t length, const std::string &value)
+{
+    memset(dest, 0, length);
+    memcpy(dest, value.data(), std::min(value.size(), length - 1));
+    return value.size() >= length;
+}
+
+BinaryFieldDescriptor makeField(const char *name, BinaryFieldType type, size_t offset, size_t count)
+{
+    BinaryFieldDescriptor field;
+    memset(&field, 0, sizeof(field));
+    strncpy(field.name, name, sizeof(field.name) - 1);
+    field.type = type;
+    field.offset = static_cast<uint32_t>(offset);
+    field.count = static_cast<uint32_t>(count);
+    return field;
+}
+
+// 生成完整的文件头字节（含字段描述与对齐填充）
+std::string buildBinaryHeader()
+{
+    std::vector<BinaryFieldDescriptor> schema = BinaryResultSink::getSchema();
+    BinaryResultHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MASAMTR", 8);
+    header.version = BinaryResultSink::VERSION;
+    header.headerSize = BinaryResultSink::getHeaderSize();
+    header.recordSize = sizeof(BinaryResultRecord);
+    header.fieldCount = static_cast<uint32_t>(schema.size());
+
+    std::string bytes(header.headerSize, '\0');
+    memcpy(&bytes[0], &header, sizeof(header));
+    memcpy(&bytes[sizeof(header)], schema.data(), schema.size() * sizeof(BinaryFieldDescriptor));
+    return bytes;
+}
+
+} // namespace
+
+bool ResultSink::createSinks(const std::string &formats, ResultSinkList &sinks)
+{
+    std::stringstream ss(formats);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        if (name.empty()) {
+            continue;
+        }
+        bool duplicate = false;
+        for (const auto &sink : sinks) {
+            duplicate = duplicate || sink->getName() == name;
+        }
+        if (duplicate) {
+            continue;
+        }
+        std::unique_ptr<ResultSink> sink = create(name);
+        if (!sink) {
+            return false;
+        }
+        sinks.push_back(std::move(sink));
+    }
+    return !sinks.empty();
+}
+
+std::unique_ptr<ResultSink> ResultSink::create(const std::string &name)
+{
+    if (name == "csv") {
+        return std::unique_ptr<ResultSink>(new CSVResultSink());
+    }
+    if (name == "jsonl") {
+        return std::unique_ptr<ResultSink>(new JSONLResultSink());
+    }
+    if (name == "bin") {
+        return std::unique_ptr<ResultSink>(new BinaryResultSink());
+    }
+    if (name == "store") {
+        return std::unique_ptr<ResultSink>(new StoreResultSink());
+    }
+    if (name == "header") {
+        return std::unique_ptr<ResultSink>(new HeaderResultSink());
+    }
+    return std::unique_ptr<ResultSink>();
+}
+
+std::vector<std::string> ResultSink::getFormatNames() { return {"csv", "jsonl", "bin", "store", "header"}; }
+
+void CSVResultSink::write(const ResultContext &context, const AccessFeatureVector &featureVector)
+{
+    CSVHandler &csvHandler = CSVHandler::getInstance();
+    if (context.dataset.empty()) {
+        csvHandler.writeAccessStrategyGeneric(context.opName, context.funcName, featureVector);
+    } else {
+        csvHandler.writeAccessStrategy(context.opName, context.dataset, context.funcName, featureVector);
+    }
+}
+
+std::ofstream *ResultFileSet::find(const std::string &opName)
+{
+    auto it = files.find(opName);
+    return (it == files.end()) ? nullptr : it->second.get();
+}
+
+std::ofstream &ResultFileSet::open(const std::string &opName, std::ios::openmode mode)
+{
+    FileUtils::createDirectory("results");
+    std::unique_ptr<std::ofstream> &file = files[opName];
+    file.reset(new std::ofstream(getPath(opName), mode | std::ios::binary));
+    if (!file->is_open()) {
+        std::cerr << "无法打开文件: " << getPath(opName) << std::endl;
+    }
+    return *file;
+}
+
+void ResultFileSet::flush()
+{
+    for (auto &entry : files) {
+        entry.second->flush();
+    }
+}
+
+void JSONLResultSink::write(const ResultContext &context, const AccessFeatureVector &featureVector)
+{
+    std::ofstream *file = files.find(context.opName);
+    if (file == nullptr) {
+        file = &files.open(context.opName, std::ios::app);
+    }
+
+    const AccessStrategyConfig &config = featureVector.accessStrategyConfig;
+    const BufferingPlan &plan = featureVector.bufferingPlan;
+    line.clear();
+    line += '{';
+    if (!context.dataset.empty()) {
+        line += "\"dataset\":";
+        appendJSONString(line, context.dataset);
+        line += ',';
+    }
+    line += "\"function\":";
+    appendJSONString(line, context.funcName);
+    line += ",\"variable\":";
+    appendJSONString(line, featureVector.varName.str());
+    line += ",\"reserved_space\":";
+    appendJSONInteger(line, static_cast<long long>(featureVector.C));
+    line += ",\"size\":";
+    appendJSONInteger(line, featureVector.S);
+    line += ",\"access_count\":";
+    appendJSONInteger(line, featureVector.N);
+    line += ",\"patterns\":[";
+    for (size_t i = 0; i < featureVector.patterns.size(); i++) {
+        if (i > 0) {
+            line += ',';
+        }
+        line += '[';
+        appendJSONInteger(line, static_cast<long long>(featureVector.patterns[i].first));
+        line += ',';
+        appendJSONNumber(line, featureVector.patterns[i].second);
+        line += ']';
+    }
+    line += "],\"density\":";
+    appendJSONNumber(line, featureVector.D);
+    line += ",\"locality\":";
+    appendJSONNumber(line, featureVector.L);
+    line += ",\"strategy\":";
+    appendJSONString(line, config.getStrategyName());
+    line += ",\"line\":";
+    appendJSONInteger(line, static_cast<long long>(config.line));
+    line += ",\"set\":";
+    appendJSONInteger(line, static_cast<long long>(config.set));
+    line += ",\"memory\":";
+    appendJSONString(line, (featureVector.memory == MEMORY_AM) ? "AM" : "SM");
+    line += ",\"buffer_count\":";
+    appendJSONInteger(line, static_cast<long long>(plan.bufferCount));
+    line += ",\"buffer_size\":";
+    appendJSONInteger(line, static_cast<long long>(plan.bufferSize));
+    line += ",\"stall_reduction\":";
+    appendJSONNumber(line, plan.getStallReduction());
+    line += ",\"prefetch_distance\":";
+    appendJSONInteger(line, static_cast<long long>(featureVector.prefetchPlan.distance));
+    line += ",\"prefetch_chunk\":";
+    appendJSONInteger(line, static_cast<long long>(featureVector.prefetchPlan.chunkSize));
+    line += ",\"costs\":{\"BULK\":";
+    appendJSONNumber(line, featureVector.strategyCosts.cycles[BULK], "%.0f");
+    line += ",\"SINGLE\":";
+    appendJSONNumber(line, featureVector.strategyCosts.cycles[SINGLE], "%.0f");
+    line += ",\"DIRECT\":";
+    appendJSONNumber(line, featureVector.strategyCosts.cycles[DIRECT], "%.0f");
+    line += "}}\n";
+    file->write(line.data(), line.size());
+}
+
+std::vector<BinaryFieldDescriptor> BinaryResultSink::getSchema()
+{
+    typedef BinaryResultRecord R;
+    return {
+        makeField("dataset", FIELD_CHAR, offsetof(R, dataset), R::DATASET_LENGTH),
+        makeField("function", FIELD_CHAR, offsetof(R, function), R::NAME_LENGTH),
+        makeField("variable", FIELD_CHAR, offsetof(R, variable), R::NAME_LENGTH),
+        makeField("size", FIELD_UINT64, offsetof(R, size), 1),
+        makeField("access_count", FIELD_UINT64, offsetof(R, accessCount), 1),
+        makeField("density", FIELD_DOUBLE, offsetof(R, density), 1),
+        makeField("locality", FIELD_DOUBLE, offsetof(R, locality), 1),
+        makeField("reserved_space", FIELD_INT32, offsetof(R, reservedSpace), 1),
+        makeField("strategy", FIELD_INT32, offsetof(R, strategy), 1),
+        makeField("line", FIELD_INT32, offsetof(R, line), 1),
+        makeField("set", FIELD_INT32, offsetof(R, set), 1),
+        makeField("buffer_count", FIELD_INT32, offsetof(R, bufferCount), 1),
+        makeField("buffer_size", FIELD_INT32, offsetof(R, bufferSize), 1),
+        makeField("stall_reduction", FIELD_DOUBLE, offsetof(R, stallReduction), 1),
+        makeField("prefetch_distance", FIELD_INT32, offsetof(R, prefetchDistance), 1),
+        makeField("prefetch_chunk", FIELD_INT32, offsetof(R, prefetchChunk), 1),
+        makeField("costs", FIELD_DOUBLE, offsetof(R, costs), UNSUITABLE),
+        makeField("pattern_count", FIELD_UINT32, offsetof(R, patternCount), 1),
+        makeField("pattern_strides", FIELD_INT32, offsetof(R, patternStrides), R::MAX_PATTERNS),
+        makeField("flags", FIELD_UINT32, offsetof(R, flags), 1),
+        makeField("memory", FIELD_INT32, offsetof(R, memory), 1),
+        makeField("pattern_ratios", FIELD_DOUBLE, offsetof(R, patternRatios), R::MAX_PATTERNS),
+    };
+}
+
+uint32_t BinaryResultSink::getHeaderSize()
+{
+    size_t size = sizeof(BinaryResultHeader) + getSchema().size() * sizeof(BinaryFieldDescriptor);
+    return static_cast<uint32_t>((size + 7) / 8 * 8);
+}
+
+std::ofstream &BinaryResultSink::openFile(const std::string &opName)
+{
+    std::string header = buildBinaryHeader();
+    std::string path = files.getPath(opName);
+
+    // 已有文件的头部一致且长度为整数条记录时追加，否则重写
+    bool append = false;
+    std::ifstream existing(path, std::ios::binary);
+    if (existing.is_open()) {
+        std::string existingHeader(header.size(), '\0');
+        existing.read(&existingHeader[0], existingHeader.size());
+        bool headerMatches = existing.gcount() == static_cast<std::streamsize>(header.size()) && existingHeader == header;
+        existing.seekg(0, std::ios::end);
+        std::streamoff length = existing.tellg();
+        append = headerMatches && (length - static_cast<std::streamoff>(header.size())) % sizeof(BinaryResultRecord) == 0;
+        if (!append) {
+            std::cerr << "警告: " << path << " 的格式与当前版本不一致，已重写" << std::endl;
+        }
+    }
+    existing.close();
+
+    if (append) {
+        return files.open(opName, std::ios::app);
+    }
+    std::ofstream &file = files.open(opName, std::ios::trunc);
+    file.write(header.data(), header.size());
+    return file;
+}
+
+void BinaryResultSink::fillRecord(const ResultContext &context, const AccessFeatureVector &featureVector,
+                                  BinaryResultRecord &record)
+{
+    memset(&record, 0, sizeof(record));
+    bool truncated = copyName(record.dataset, sizeof(record.dataset), context.dataset);
+    truncated = copyName(record.function, sizeof(record.function), context.funcName) || truncated;
+    truncated = copyName(record.variable, sizeof(record.variable), featureVector.varName.str()) || truncated;
+    if (truncated) {
+        record.flags |= BinaryResultRecord::FLAG_NAME_TRUNCATED;
+    }
+    record.size = featureVector.S;
+    record.accessCount = featureVector.N;
+    record.density = featureVector.D;
+    record.locality = featureVector.L;
+    record.reservedSpace = featureVector.C;
+    record.strategy = featureVector.accessStrategyConfig.accessStrategy;
+    record.line = featureVector.accessStrategyConfig.line;
+    record.set = featureVector.accessStrategyConfig.set;
+    record.bufferCount = featureVector.bufferingPlan.bufferCount;
+    record.bufferSize = featureVector.bufferingPlan.bufferSize;
+    record.stallReduction = featureVector.bufferingPlan.getStallReduction();
+    record.prefetchDistance = featureVector.prefetchPlan.distance;
+    record.prefetchChunk = featureVector.prefetchPlan.chunkSize;
+    for (int i = 0; i < UNSUITABLE; i++) {
+        record.costs[i] = featureVector.strategyCosts.cycles[i];
+    }
+    record.memory = featureVector.memory;
+    record.patternCount = static_cast<uint32_t>(featureVector.patterns.size());
+    size_t stored = std::min<size_t>(featureVector.patterns.size(), BinaryResultRecord::MAX_PATTERNS);
+    for (size_t i = 0; i < stored; i++) {
+        record.patternStrides[i] = featureVector.patterns[i].first;
+        record.patternRatios[i] = featureVector.patterns[i].second;
+    }
+}
+
+void BinaryResultSink::write(const ResultContext &context, const AccessFeatureVector &featureVector)
+{
+    std::ofstream *file = files.find(context.opName);
+    if (file == nullptr) {
+        file = &openFile(context.opName);
+    }
+    BinaryResultRecord record;
+    fillRecord(context, featureVector, record);
+    // 截断后的名称可能与其他变量相同，比较结果时这些记录会被跳过
+    if ((record.flags & BinaryResultRecord::FLAG_NAME_TRUNCATED) != 0) {
+        std::cerr << "警告: " << context.opName << "/" << context.dataset << "/" << context.funcName << "/"
+                  << featureVector.varName << " 的名称超过二进制记录的字段长度，已截断" << std::endl;
+    }
+    file->write(reinterpret_cast<const char *>(&record), sizeof(record));
+}
+
+void StoreResultSink::write(const ResultContext &context, const AccessFeatureVector &featureVector)
+{
+    pending.push_back(std::make_pair(
+        ResultStore::makeKey(context.opName, context.dataset, context.funcName, featureVector.varName.str()),
+        ResultStore::makeRecord(featureVector)));
+}
+
+void StoreResultSink::flush()
+{
+    if (pending.empty()) {
+        return;
+    }
+    FileUtils::createDirectory("results");
+    if (!ResultStore::upsert(ResultStore::getDefaultPath(), pending)) {
+        std::cerr << "错误: " << pending.size() << "条结果未能写入结果库 " << ResultStore::getDefaultPath()
+                  << std::endl;
+    }
+    ResultStore::EntryList().swap(pending);
+}
+
+void HeaderResultSink::write(const ResultContext &context, const AccessFeatureVector &featureVector)
+{
+    if (context.opName != current.opName || context.dataset != current.dataset ||
+        context.funcName != current.funcName) {
+        flush();
+        current = context;
+    }
+    variables.push_back(CacheVariable(featureVector));
+}
+
+void HeaderResultSink::flush()
+{
+    if (variables.empty()) {
+        return;
+    }
+    std::string code, error;
+    std::string path = "results/codegen/" +
+                       CacheCodeGenerator::getFileName(current.opName, current.dataset, current.funcName);
+    if (generator.generate(current.opName, current.dataset, current.funcName, variables, code, error)) {
+        FileUtils::createDirectory("results");
+        FileUtils::createDirectory("results/codegen");
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << code;
+        if (!file) {
+            std::cerr << "无法写入文件: " << path << std::endl;
+        }
+    } else {
+        std::cerr << "警告: 跳过 " << path << ": " << error << std::endl;
+    }
+    variables.clear();
+}
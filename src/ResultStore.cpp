@@ -0,0 +1,392 @@
+#include "ResultStore.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+const char STORE_MAGIC[8] = {'M', 'A', 'S', 'A', 'M', 'T', 'I', '\0'};
+
+uint64_t hashKey(const char *key, size_t length)
+{
+    // FNV-1a
+    uint64_t value = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        value ^= static_cast<unsigned char>(key[i]);
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+uint64_t alignTo8(uint64_t offset) { return (offset + 7) / 8 * 8; }
+
+// 将模式按'/'拆成四部分，缺省的尾部部分为"*"
+std::vector<std::string> splitPattern(const std::string &pattern)
+{
+    std::vector<std::string> parts;
+    size_t begin = 0;
+    while (parts.size() < 4) {
+        size_t end = pattern.find('/', begin);
+        if (end == std::string::npos || parts.size() == 3) {
+            parts.push_back(pattern.substr(begin));
+            break;
+        }
+        parts.push_back(pattern.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    while (parts.size() < 4) {
+        parts.push_back("*");
+    }
+    return parts;
+}
+
+std::string &defaultStorePath()
+{
+    static std::string path = "results/results.idx";
+    return path;
+}
+
+} // namespace
+
+const char ResultStore::KEY_SEPARATOR;
+
+const std::string &ResultStore::getDefaultPath() { return defaultStorePath(); }
+void ResultStore::setDefaultPath(const std::string &path) { defaultStorePath() = path; }
+
+bool ResultStore::open(const std::string &path)
+{
+    close();
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    length = buffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void *mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    data = static_cast<const char *>(mapped);
+    length = static_cast<size_t>(info.st_size);
+#endif
+    if (!validate()) {
+        std::cerr << "警告: 结果库格式不正确: " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void ResultStore::close()
+{
+#ifndef _WIN32
+    if (data != nullptr) {
+        munmap(const_cast<char *>(data), length);
+    }
+#endif
+    buffer.clear();
+    data = nullptr;
+    length = 0;
+}
+
+bool ResultStore::validate() const
+{
+    if (length < sizeof(StoreHeader)) {
+        return false;
+    }
+    const StoreHeader &h = header();
+    if (memcmp(h.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 || h.version != VERSION ||
+        h.recordSize != sizeof(StoreRecord)) {
+        return false;
+    }
+    // 哈希槽数必须为2的幂；各量先限制在文件长度以内，下面的加法与乘法不会溢出
+    if (h.slotCount == 0 || (h.slotCount & (h.slotCount - 1)) != 0 || h.recordCount >= h.slotCount ||
+        h.slotCount > length / sizeof(uint32_t) || h.recordsOffset > length || h.slotsOffset > length ||
+        h.stringsOffset > length || h.stringsSize > length) {
+        return false;
+    }
+    // 各区按字段类型对齐且不越界
+    if (h.recordsOffset % alignof(StoreRecord) != 0 || h.slotsOffset % alignof(uint32_t) != 0 ||
+        h.recordsOffset + h.recordCount * sizeof(StoreRecord) > h.slotsOffset ||
+        h.slotsOffset + h.slotCount * sizeof(uint32_t) > h.stringsOffset ||
+        h.stringsOffset + h.stringsSize > length) {
+        return false;
+    }
+    // 每条记录的键都在字符串区内，非空哈希槽都指向已有记录
+    const StoreRecord *table = records();
+    for (uint64_t i = 0; i < h.recordCount; i++) {
+        if (static_cast<uint64_t>(table[i].keyOffset) + table[i].keyLength > h.stringsSize) {
+            return false;
+        }
+    }
+    const uint32_t *index = slots();
+    for (uint64_t slot = 0; slot < h.slotCount; slot++) {
+        if (index[slot] != EMPTY_SLOT && index[slot] >= h.recordCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const StoreRecord *ResultStore::find(const std::string &key) const
+{
+    if (!isOpen()) {
+        return nullptr;
+    }
+    uint64_t hash = hashKey(key.data(), key.size());
+    uint64_t mask = header().slotCount - 1;
+    const uint32_t *table = slots();
+    for (uint64_t slot = hash & mask; table[slot] != EMPTY_SLOT; slot = (slot + 1) & mask) {
+        const StoreRecord &record = records()[table[slot]];
+        if (record.hash == hash && record.keyLength == key.size() &&
+            memcmp(strings() + record.keyOffset, key.data(), key.size()) == 0) {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+size_t ResultStore::query(const std::string &pattern, const std::function<void(const StoreRecord &)> &visitor) const
+{
+    if (!isOpen()) {
+        return 0;
+    }
+    std::vector<std::string> parts = splitPattern(pattern);
+    size_t literalCount = 0;
+    while (literalCount < parts.size() && parts[literalCount] != "*") {
+        literalCount++;
+    }
+
+    // 四部分都给出时精确查找
+    if (literalCount == parts.size()) {
+        const StoreRecord *record = find(makeKey(parts[0], parts[1], parts[2], parts[3]));
+        if (record != nullptr) {
+            visitor(*record);
+        }
+        return (record != nullptr) ? 1 : 0;
+    }
+
+    // 前缀部分在排序表上二分定位，其余部分逐条过滤
+    std::string prefix;
+    for (size_t i = 0; i < literalCount; i++) {
+        prefix += parts[i];
+        prefix += KEY_SEPARATOR;
+    }
+    const StoreRecord *begin = records();
+    const StoreRecord *end = begin + size();
+    const char *pool = strings();
+    auto keyLess = [pool](const StoreRecord &record, const std::string &value) {
+        return value.compare(0, std::string::npos, pool + record.keyOffset, record.keyLength) > 0;
+    };
+    size_t matches = 0;
+    for (const StoreRecord *record = std::lower_bound(begin, end, prefix, keyLess); record != end; record++) {
+        std::string key = getKey(*record);
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        std::vector<std::string> keyParts;
+        size_t partBegin = 0;
+        for (int i = 0; i < 4; i++) {
+            size_t partEnd = (i == 3) ? key.size() : key.find(KEY_SEPARATOR, partBegin);
+            if (partEnd == std::string::npos) {
+                partEnd = key.size();
+            }
+            keyParts.push_back(key.substr(partBegin, partEnd - partBegin));
+            partBegin = partEnd + 1;
+        }
+        bool matched = true;
+        for (size_t i = literalCount; i < parts.size() && matched; i++) {
+            matched = parts[i] == "*" || parts[i] == keyParts[i];
+        }
+        if (matched) {
+            visitor(*record);
+            matches++;
+        }
+    }
+    return matches;
+}
+
+bool ResultStore::upsert(const std::string &path, EntryList &entries)
+{
+    // 新记录按键排序，同键只保留最后写入的一条
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const EntryList::value_type &a, const EntryList::value_type &b) { return a.first < b.first; });
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i + 1 < entries.size() && entries[i + 1].first == entries[i].first) {
+            continue;
+        }
+        if (uniqueCount != i) {
+            entries[uniqueCount] = std::move(entries[i]);
+        }
+        uniqueCount++;
+    }
+    entries.resize(uniqueCount);
+
+    // 与已有记录合并：两侧均按键有序，同键以新记录为准
+    EntryList merged;
+    {
+        ResultStore existing;
+        existing.open(path);
+        merged.reserve(existing.size() + entries.size());
+        auto next = entries.begin();
+        for (size_t i = 0; i < existing.size(); i++) {
+            const StoreRecord &record = existing.getRecord(i);
+            std::string key = existing.getKey(record);
+            while (next != entries.end() && next->first < key) {
+                merged.push_back(*next++);
+            }
+            if (next != entries.end() && next->first == key) {
+                merged.push_back(*next++);
+            } else {
+                merged.push_back(std::make_pair(key, record));
+            }
+        }
+        merged.insert(merged.end(), next, entries.end());
+    }
+
+    // 布局：文件头、记录区、哈希槽区、字符串区
+    StoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(StoreRecord);
+    header.recordCount = merged.size();
+    header.slotCount = 16;
+    while (header.slotCount < merged.size() * 2) {
+        header.slotCount *= 2;
+    }
+    header.recordsOffset = alignTo8(sizeof(header));
+    header.slotsOffset = alignTo8(header.recordsOffset + merged.size() * sizeof(StoreRecord));
+    header.stringsOffset = alignTo8(header.slotsOffset + header.slotCount * sizeof(uint32_t));
+
+    std::string strings;
+    std::vector<StoreRecord> records(merged.size());
+    std::vector<uint32_t> slots(header.slotCount, EMPTY_SLOT);
+    uint64_t mask = header.slotCount - 1;
+    for (size_t i = 0; i < merged.size(); i++) {
+        const std::string &key = merged[i].first;
+        StoreRecord &record = records[i];
+        record = merged[i].second;
+        record.keyOffset = static_cast<uint32_t>(strings.size());
+        record.keyLength = static_cast<uint32_t>(key.size());
+        record.hash = hashKey(key.data(), key.size());
+        strings += key;
+        uint64_t slot = record.hash & mask;
+        while (slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = static_cast<uint32_t>(i);
+    }
+    header.stringsSize = strings.size();
+
+    // 先写临时文件再替换，查询方不会读到写了一半的文件
+    std::string tempPath = path + ".tmp";
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "无法打开文件: " << tempPath << std::endl;
+        return false;
+    }
+    const char padding[8] = {0};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(padding, header.recordsOffset - sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(StoreRecord));
+    file.write(padding, header.slotsOffset - (header.recordsOffset + records.size() * sizeof(StoreRecord)));
+    file.write(reinterpret_cast<const char *>(slots.data()), slots.size() * sizeof(uint32_t));
+    file.write(padding, header.stringsOffset - (header.slotsOffset + slots.size() * sizeof(uint32_t)));
+    file.write(strings.data(), strings.size());
+    file.close();
+    if (!file || std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "错误: 无法写入结果库 " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string ResultStore::makeKey(const std::string &opName, const std::string &dataset, const std::string &funcName,
+                                 const std::string &varName)
+{
+    std::string key;
+    key.reserve(opName.size() + dataset.size() + funcName.size() + varName.size() + 3);
+    key += opName;
+    key += KEY_SEPARATOR;
+    key += dataset;
+    key += KEY_SEPARATOR;
+    key += funcName;
+    key += KEY_SEPARATOR;
+    key += varName;
+    return key;
+}
+
+StoreRecord ResultStore::makeRecord(const AccessFeatureVector &featureVector)
+{
+    StoreRecord record;
+    memset(&record, 0, sizeof(record));
+    record.strategy = featureVector.accessStrategyConfig.accessStrategy;
+    record.set = featureVector.accessStrategyConfig.set;
+    record.line = featureVector.accessStrategyConfig.line;
+    record.reservedSpace = featureVector.C;
+    record.size = featureVector.S;
+    record.accessCount = featureVector.N;
+    record.density = featureVector.D;
+    record.locality = featureVector.L;
+    record.bufferCount = featureVector.bufferingPlan.bufferCount;
+    record.bufferSize = featureVector.bufferingPlan.bufferSize;
+    record.stallReduction = featureVector.bufferingPlan.getStallReduction();
+    record.prefetchDistance = featureVector.prefetchPlan.distance;
+    record.prefetchChunk = featureVector.prefetchPlan.chunkSize;
+    record.memory = featureVector.memory;
+    for (int i = 0; i < UNSUITABLE; i++) {
+        record.costs[i] = featureVector.strategyCosts.cycles[i];
+    }
+    return record;
+}
+
+void ResultStore::printRecord(const StoreRecord &record) const
+{
+    std::string key = getKey(record);
+    std::replace(key.begin(), key.end(), KEY_SEPARATOR, '/');
+    AccessStrategy accessStrategy = (record.strategy >= BULK && record.strategy <= UNSUITABLE)
+                                        ? static_cast<AccessStrategy>(record.strategy)
+                                        : UNSUITABLE;
+    std::cout << key << ": " << AccessStrategyConfig(accessStrategy).getStrategyName() << " set=" << record.set
+              << " line=" << record.line << " C=" << record.reservedSpace << " S=" << record.size
+              << " N=" << record.accessCount << " Cost(B/S/D):" << StrategyCosts::formatCycles(record.costs[BULK])
+              << "/" << StrategyCosts::formatCycles(record.costs[SINGLE]) << "/"
+              << StrategyCosts::formatCycles(record.costs[DIRECT]);
+    if (record.memory == MEMORY_AM) {
+        std::cout << " Memory:AM";
+    }
+    if (record.bufferCount > 1) {
+        std::cout << " Buffer:" << record.bufferCount << "x" << record.bufferSize << "B";
+    }
+    if (record.prefetchDistance > 0) {
+        std::cout << " Prefetch:" << record.prefetchDistance << "x" << record.prefetchChunk << "B";
+    }
+    std::cout << std::endl;
+}
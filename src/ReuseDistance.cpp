@@ -0,0 +1,183 @@
+#include "ReuseDistance.hpp"
+#include "MasamtTrace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+
+// 树状数组的最小容量（时间戳个数）
+const uint64_t MIN_CAPACITY = 1 << 12;
+
+std::string formatBytes(double bytes)
+{
+    std::ostringstream os;
+    if (bytes >= 1024.0 * 1024.0) {
+        os << std::setprecision(3) << bytes / (1024.0 * 1024.0) << "M";
+    } else if (bytes >= 1024.0) {
+        os << std::setprecision(3) << bytes / 1024.0 << "K";
+    } else {
+        os << std::setprecision(3) << bytes;
+    }
+    return os.str();
+}
+
+} // namespace
+
+void ReuseHistogram::merge(const ReuseHistogram &other)
+{
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    coldAccesses += other.coldAccesses;
+    elementSize = other.elementSize;
+}
+
+uint64_t ReuseHistogram::getTotal() const
+{
+    uint64_t total = coldAccesses;
+    for (int i = 0; i < BUCKETS; i++) {
+        total += counts[i];
+    }
+    return total;
+}
+
+int ReuseHistogram::getBucket(uint64_t distance)
+{
+    int bucket = 0;
+    while (distance > 0 && bucket < BUCKETS - 1) {
+        distance >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+double ReuseHistogram::getBucketDistance(int bucket)
+{
+    return (bucket == 0) ? 0.0 : 1.5 * std::ldexp(1.0, bucket - 1);
+}
+
+double ReuseHistogram::getHitRatio(double bytes) const
+{
+    uint64_t total = getTotal();
+    if (total == 0) {
+        return 0.0;
+    }
+    // 距离小于缓存可容纳的地址数时命中
+    double capacity = bytes / elementSize;
+    double hits = 0.0;
+    for (int i = 0; i < BUCKETS; i++) {
+        double low = (i == 0) ? 0.0 : std::ldexp(1.0, i - 1);
+        double high = (i == 0) ? 1.0 : std::ldexp(1.0, i);
+        hits += counts[i] * std::max(0.0, std::min(1.0, (capacity - low) / (high - low)));
+    }
+    return hits / total;
+}
+
+double ReuseHistogram::getTemporalLocality(double referenceBytes) const
+{
+    uint64_t total = getTotal();
+    if (total == 0 || referenceBytes <= 0) {
+        return 0.0;
+    }
+    double locality = 0.0;
+    for (int i = 0; i < BUCKETS; i++) {
+        if (counts[i] > 0) {
+            locality += static_cast<double>(counts[i]) / total *
+                        std::exp(-getBucketDistance(i) * elementSize / referenceBytes);
+        }
+    }
+    return locality;
+}
+
+void ReuseHistogram::print(std::ostream &os) const
+{
+    uint64_t total = getTotal();
+    if (total == 0) {
+        return;
+    }
+    std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(1);
+    for (int i = 0; i < BUCKETS; i++) {
+        if (counts[i] > 0) {
+            os << " <" << formatBytes(((i == 0) ? 1.0 : std::ldexp(1.0, i)) * elementSize) << "B:"
+               << 100.0 * counts[i] / total << "%";
+        }
+    }
+    if (coldAccesses > 0) {
+        os << " 冷:" << 100.0 * coldAccesses / total << "%";
+    }
+    os.flags(flags);
+}
+
+void ReuseDistanceAnalyzer::update(uint64_t position, int delta)
+{
+    for (uint64_t i = position + 1; i <= tree.size(); i += i & (~i + 1)) {
+        tree[i - 1] += delta;
+    }
+}
+
+uint64_t ReuseDistanceAnalyzer::prefix(uint64_t position) const
+{
+    uint64_t sum = 0;
+    for (uint64_t i = position; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+void ReuseDistanceAnalyzer::compact()
+{
+    // 按最近访问时间重新编号为0..k-1，容量取2k，摊还后每次访问仍为O(log n)
+    std::vector<std::pair<uint64_t, uint64_t>> live;
+    live.reserve(lastAccess.size());
+    for (const auto &entry : lastAccess) {
+        live.push_back(std::make_pair(entry.second, entry.first));
+    }
+    std::sort(live.begin(), live.end());
+    for (size_t i = 0; i < live.size(); i++) {
+        lastAccess[live[i].second] = i;
+    }
+    tree.assign(std::max<uint64_t>(MIN_CAPACITY, 2 * live.size()), 0);
+    // 线性建树：前k个位置各记1
+    for (uint64_t i = 1; i <= tree.size(); i++) {
+        tree[i - 1] += (i <= live.size()) ? 1 : 0;
+        uint64_t parent = i + (i & (~i + 1));
+        if (parent <= tree.size()) {
+            tree[parent - 1] += tree[i - 1];
+        }
+    }
+    now = live.size();
+}
+
+void ReuseDistanceAnalyzer::access(uint64_t address)
+{
+    if (sampleRate > 1 && !MasamtTrace::SamplingConfig::hashSelected(address, sampleRate)) {
+        return;
+    }
+    // 连续访问同一地址：距离为0，最近访问顺序不变，无需更新树
+    if (hasPrevious && address == previousAddress) {
+        histogram.add(0, sampleRate);
+        return;
+    }
+    hasPrevious = true;
+    previousAddress = address;
+    if (now == tree.size()) {
+        compact();
+    }
+    auto it = lastAccess.find(address);
+    if (it == lastAccess.end()) {
+        histogram.coldAccesses += sampleRate;
+        lastAccess.emplace(address, now);
+    } else {
+        uint64_t last = it->second;
+        // 所有记号都在now之前，其个数即不同地址数
+        histogram.add((lastAccess.size() - prefix(last + 1)) * sampleRate, sampleRate);
+        update(last, -1);
+        it->second = now;
+    }
+    update(now, 1);
+    now++;
+}
@@ -0,0 +1,159 @@
+#include "SamplingUncertainty.hpp"
+#include "StrategyCostModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+
+const SampledEstimate *findEstimate(const TraceSampling &sampling, const std::string &kernel, const std::string &name)
+{
+    for (const auto &estimate : sampling.variables) {
+        if (estimate.kernel == kernel && estimate.name == name) {
+            return &estimate;
+        }
+    }
+    return nullptr;
+}
+
+// 步长占比取置信区间端点（direction为-1或1）时的访存模式，占比限制在[0, 1]
+AccessPatterns boundPatterns(const AccessPatterns &patterns, const SampledEstimate &estimate, int direction)
+{
+    AccessPatterns bounded = patterns;
+    for (size_t i = 0; i < bounded.size() && i < estimate.strides.size(); i++) {
+        double percent = bounded[i].second + direction * estimate.strides[i].error / 100.0;
+        bounded[i].second = std::max(0.0, std::min(1.0, percent));
+    }
+    return bounded;
+}
+
+double localityOf(const AccessPatterns &patterns)
+{
+    if (patterns.size() == 0) {
+        return AccessStrategyDeducter::strategy_determine_factor;
+    }
+    double locality = 0.0;
+    for (const auto &pattern : patterns) {
+        locality += pattern.second * std::exp(-pattern.first);
+    }
+    return locality;
+}
+
+AccessStrategy strategyOf(const FeatureVectorList &featureVectors, const InternedName &name)
+{
+    for (const auto &featureVector : featureVectors) {
+        if (featureVector.varName == name) {
+            return featureVector.accessStrategyConfig.accessStrategy;
+        }
+    }
+    return UNSUITABLE;
+}
+
+std::string formatCount(double value)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(0) << value;
+    return os.str();
+}
+
+} // namespace
+
+bool SamplingRisk::straddlesFactor() const
+{
+    double factor = DecisionThresholds::getInstance().strategyDetermineFactor;
+    return lowLocality <= factor && highLocality > factor;
+}
+
+std::vector<SamplingRisk> SamplingUncertainty::analyse(const OperatorInfo &op,
+                                                       const std::vector<FeatureVectorList> &results,
+                                                       const TraceSampling &sampling)
+{
+    std::vector<SamplingRisk> risks;
+    for (size_t f = 0; f < op.functions.size() && f < results.size(); f++) {
+        const FunctionInfo &func = op.functions[f];
+        for (size_t v = 0; v < func.variables.size(); v++) {
+            const VariableInfo &variable = func.variables[v];
+            const SampledEstimate *estimate = findEstimate(sampling, func.name.str(), variable.name.str());
+            if (estimate == nullptr) {
+                continue;
+            }
+            SamplingRisk risk;
+            risk.funcName = func.name.str();
+            risk.varName = variable.name.str();
+            risk.strategy = strategyOf(results[f], variable.name);
+            risk.locality = localityOf(variable.patterns);
+            risk.lowLocality = localityOf(boundPatterns(variable.patterns, *estimate, -1));
+            risk.highLocality = localityOf(boundPatterns(variable.patterns, *estimate, 1));
+
+            for (int accessDirection = -1; accessDirection <= 1; accessDirection += 2) {
+                for (int patternDirection = -1; patternDirection <= 1; patternDirection += 2) {
+                    ArenaCheckpoint checkpoint;
+                    FunctionInfo perturbed = func;
+                    VariableInfo &target = perturbed.variables[v];
+                    double access = estimate->accesses + accessDirection * estimate->accessesError;
+                    target.access = static_cast<unsigned long long>(std::max(0.0, access) + 0.5);
+                    target.patterns = boundPatterns(variable.patterns, *estimate, patternDirection);
+
+                    AccessStrategyDeducter deducter;
+                    deducter.deductAccessStrategy(perturbed);
+                    AccessStrategy strategy = strategyOf(deducter.accessFeatureVectors, variable.name);
+                    if (strategy != risk.strategy &&
+                        std::find(risk.alternatives.begin(), risk.alternatives.end(), strategy) == risk.alternatives.end()) {
+                        risk.alternatives.push_back(strategy);
+                    }
+                }
+            }
+            risks.push_back(risk);
+        }
+    }
+    return risks;
+}
+
+void SamplingUncertainty::printReport(const TraceSampling &sampling, const std::vector<SamplingRisk> &risks,
+                                      std::ostream &os)
+{
+    const MasamtTrace::SamplingConfig &config = sampling.config;
+    os << "[抽样估计] ";
+    if (config.mode == MasamtTrace::SAMPLE_BURST) {
+        os << "突发抽样 burst:" << config.burstLength << "/" << config.period;
+    } else {
+        os << "哈希抽样 hash:" << config.period;
+    }
+    os << "，每个样本代表" << std::fixed << std::setprecision(1) << config.getScale() << "次访问，误差为95%置信区间半宽"
+       << std::endl;
+
+    size_t flips = 0;
+    for (const auto &risk : risks) {
+        const SampledEstimate *estimate = findEstimate(sampling, risk.funcName, risk.varName);
+        os << "  " << risk.funcName << "/" << risk.varName << ": 样本" << estimate->samples << "(" << estimate->batches
+           << "批), N≈" << formatCount(estimate->accesses) << "±" << formatCount(estimate->accessesError);
+        if (estimate->footprint >= 0) {
+            os << ", 数据量≈" << formatCount(estimate->footprint) << "±" << formatCount(estimate->footprintError) << "B";
+        }
+        os << ", 模式:";
+        for (const auto &stride : estimate->strides) {
+            os << " 步长" << stride.stride << "(" << std::setprecision(1) << stride.percent << "%±" << stride.error
+               << "%)";
+        }
+        os << ", L=" << std::setprecision(4) << risk.locality << " [" << risk.lowLocality << ", " << risk.highLocality
+           << "], 策略=" << AccessStrategyConfig(risk.strategy).getStrategyName();
+        if (risk.mayFlip()) {
+            flips++;
+            os << " [可能变为";
+            for (size_t i = 0; i < risk.alternatives.size(); i++) {
+                os << (i == 0 ? "" : "/") << AccessStrategyConfig(risk.alternatives[i]).getStrategyName();
+            }
+            os << "]";
+        }
+        if (risk.straddlesFactor()) {
+            os << " [L的置信区间跨过策略决断常量" << DecisionThresholds::getInstance().strategyDetermineFactor << "]";
+        }
+        os << std::endl;
+    }
+    if (flips > 0) {
+        os << "  警告: " << flips << "个变量的策略在置信区间内可能改变，请增大抽样比例" << std::endl;
+    }
+    os << std::endl;
+}
@@ -0,0 +1,394 @@
+#include "ScalingModel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+
+std::string formatBytes(double bytes)
+{
+    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024.0 && unit < 4) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << bytes << units[unit];
+    return oss.str();
+}
+
+} // namespace
+
+double ScalingModel::PowerLaw::predict(double x) const { return coefficient * std::pow(x, exponent); }
+
+ScalingModel::PowerLaw ScalingModel::PowerLaw::fit(const std::vector<std::pair<double, double>> &samples)
+{
+    PowerLaw law;
+    std::vector<std::pair<double, double>> logSamples;
+    for (const auto &sample : samples) {
+        if (sample.first > 0 && sample.second > 0) {
+            logSamples.push_back(std::make_pair(std::log(sample.first), std::log(sample.second)));
+        }
+    }
+    law.points = static_cast<int>(logSamples.size());
+    if (logSamples.empty()) {
+        return law;
+    }
+    // 只有一个点或规模相同时无法估计指数，按线性缩放处理
+    double meanX = 0.0, meanY = 0.0;
+    for (const auto &sample : logSamples) {
+        meanX += sample.first;
+        meanY += sample.second;
+    }
+    meanX /= logSamples.size();
+    meanY /= logSamples.size();
+    double sxx = 0.0, sxy = 0.0, syy = 0.0;
+    for (const auto &sample : logSamples) {
+        sxx += (sample.first - meanX) * (sample.first - meanX);
+        sxy += (sample.first - meanX) * (sample.second - meanY);
+        syy += (sample.second - meanY) * (sample.second - meanY);
+    }
+    law.exponent = (sxx > 1e-12) ? sxy / sxx : 1.0;
+    law.coefficient = std::exp(meanY - law.exponent * meanX);
+    law.r2 = (sxx > 1e-12 && syy > 1e-12) ? (sxy * sxy) / (sxx * syy) : 1.0;
+    return law;
+}
+
+double ScalingModel::footprintOf(const OperatorInfo &op)
+{
+    double footprint = 0.0;
+    for (const auto &func : op.functions) {
+        for (const auto &var : func.variables) {
+            footprint += static_cast<double>(var.size);
+        }
+    }
+    return footprint;
+}
+
+bool ScalingModel::parseSize(const std::string &spec, double largestFootprint, double &footprint)
+{
+    try {
+        size_t pos = 0;
+        double value = std::stod(spec, &pos);
+        std::string suffix = spec.substr(pos);
+        if (suffix == "x" || suffix == "X") {
+            value *= largestFootprint;
+        } else if (suffix == "K" || suffix == "k") {
+            value *= 1024.0;
+        } else if (suffix == "M" || suffix == "m") {
+            value *= 1024.0 * 1024.0;
+        } else if (suffix == "G" || suffix == "g") {
+            value *= 1024.0 * 1024.0 * 1024.0;
+        } else if (!suffix.empty()) {
+            return false;
+        }
+        if (value <= 0) {
+            return false;
+        }
+        footprint = value;
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+std::vector<int> ScalingModel::matchPatterns(const AccessPatterns &patterns, const AccessPatterns &reference)
+{
+    std::vector<int> match(patterns.size(), -1);
+    std::vector<bool> used(reference.size(), false);
+    for (size_t i = 0; i < patterns.size(); i++) {
+        for (size_t slot = 0; slot < reference.size(); slot++) {
+            if (!used[slot] && reference[slot].first == patterns[i].first) {
+                match[i] = static_cast<int>(slot);
+                used[slot] = true;
+                break;
+            }
+        }
+    }
+    // 剩余步长按符号分组，组内按绝对值升序依次对应
+    for (int sign = -1; sign <= 1; sign += 2) {
+        std::vector<size_t> remaining, slots;
+        for (size_t i = 0; i < patterns.size(); i++) {
+            if (match[i] < 0 && (patterns[i].first < 0) == (sign < 0)) {
+                remaining.push_back(i);
+            }
+        }
+        for (size_t slot = 0; slot < reference.size(); slot++) {
+            if (!used[slot] && (reference[slot].first < 0) == (sign < 0)) {
+                slots.push_back(slot);
+            }
+        }
+        std::stable_sort(remaining.begin(), remaining.end(), [&patterns](size_t a, size_t b) {
+            return std::abs(patterns[a].first) < std::abs(patterns[b].first);
+        });
+        std::stable_sort(slots.begin(), slots.end(), [&reference](size_t a, size_t b) {
+            return std::abs(reference[a].first) < std::abs(reference[b].first);
+        });
+        for (size_t k = 0; k < std::min(remaining.size(), slots.size()); k++) {
+            match[remaining[k]] = static_cast<int>(slots[k]);
+        }
+    }
+    return match;
+}
+
+bool ScalingModel::load(const std::string &opName, const InputManifest &manifest)
+{
+    this->opName = opName;
+    datasets.clear();
+    for (const auto &entry : manifest.legacyFiles) {
+        if (entry.opName != opName) {
+            continue;
+        }
+        ProfiledDataset profiled;
+        profiled.dataset = entry.dataset;
+        profiled.op.getOperatorInfoFromCSV(opName, entry.path);
+        profiled.footprint = footprintOf(profiled.op);
+        if (profiled.footprint > 0) {
+            datasets.push_back(profiled);
+        }
+    }
+    std::sort(datasets.begin(), datasets.end(),
+              [](const ProfiledDataset &a, const ProfiledDataset &b) { return a.footprint < b.footprint; });
+    if (datasets.empty()) {
+        return false;
+    }
+    fit();
+    return true;
+}
+
+void ScalingModel::fit()
+{
+    variables.clear();
+    // 按 函数/变量 收集各数据集中的样本，保持最大数据集中的顺序
+    std::map<std::pair<std::string, std::string>, size_t> index;
+    std::vector<std::vector<std::pair<double, const VariableInfo *>>> samples;
+    for (auto dataset = datasets.rbegin(); dataset != datasets.rend(); ++dataset) {
+        for (const auto &func : dataset->op.functions) {
+            for (const auto &var : func.variables) {
+                auto key = std::make_pair(func.name.str(), var.name.str());
+                if (index.find(key) == index.end()) {
+                    index[key] = variables.size();
+                    VariableScaling scaling;
+                    scaling.funcName = key.first;
+                    scaling.varName = key.second;
+                    variables.push_back(scaling);
+                    samples.push_back(std::vector<std::pair<double, const VariableInfo *>>());
+                }
+                samples[index[key]].push_back(std::make_pair(dataset->footprint, &var));
+            }
+        }
+    }
+
+    for (size_t v = 0; v < variables.size(); v++) {
+        VariableScaling &scaling = variables[v];
+        // 样本按规模升序
+        std::vector<std::pair<double, const VariableInfo *>> &points = samples[v];
+        std::reverse(points.begin(), points.end());
+
+        std::vector<std::pair<double, double>> sizeSamples, accessSamples;
+        for (const auto &point : points) {
+            sizeSamples.push_back(std::make_pair(point.first, static_cast<double>(point.second->size)));
+            accessSamples.push_back(std::make_pair(point.first, static_cast<double>(point.second->access)));
+        }
+        scaling.sizeLaw = PowerLaw::fit(sizeSamples);
+        scaling.accessLaw = PowerLaw::fit(accessSamples);
+
+        // 各数据集的步长对应到最大数据集的步长，占比取最大数据集
+        const VariableInfo &largest = *points.back().second;
+        size_t slots = largest.patterns.size();
+        std::vector<std::vector<int>> matches;
+        for (const auto &point : points) {
+            matches.push_back(matchPatterns(point.second->patterns, largest.patterns));
+        }
+        for (size_t slot = 0; slot < slots; slot++) {
+            PatternScaling pattern;
+            pattern.stride = largest.patterns[slot].first;
+            pattern.percentage = largest.patterns[slot].second;
+            std::vector<std::pair<double, double>> strideSamples;
+            for (size_t i = 0; i < points.size(); i++) {
+                const AccessPatterns &patterns = points[i].second->patterns;
+                for (size_t j = 0; j < patterns.size(); j++) {
+                    if (matches[i][j] != static_cast<int>(slot)) {
+                        continue;
+                    }
+                    pattern.constantStride = pattern.constantStride && patterns[j].first == pattern.stride;
+                    strideSamples.push_back(
+                        std::make_pair(points[i].first, static_cast<double>(std::abs(patterns[j].first))));
+                }
+            }
+            if (!pattern.constantStride) {
+                pattern.strideLaw = PowerLaw::fit(strideSamples);
+            }
+            scaling.patterns.push_back(pattern);
+        }
+
+        // 相邻数据集间占比分布的总变差距离，没有对应步长的占比计入距离
+        double maxDistance = 0.0;
+        for (size_t i = 1; i < points.size(); i++) {
+            std::vector<double> prev(slots, 0.0), curr(slots, 0.0);
+            double distance = 0.0;
+            for (size_t j = 0; j < points[i - 1].second->patterns.size(); j++) {
+                double share = points[i - 1].second->patterns[j].second;
+                if (matches[i - 1][j] >= 0) {
+                    prev[matches[i - 1][j]] = share;
+                } else {
+                    distance += share;
+                }
+            }
+            for (size_t j = 0; j < points[i].second->patterns.size(); j++) {
+                double share = points[i].second->patterns[j].second;
+                if (matches[i][j] >= 0) {
+                    curr[matches[i][j]] = share;
+                } else {
+                    distance += share;
+                }
+            }
+            for (size_t slot = 0; slot < slots; slot++) {
+                distance += std::abs(prev[slot] - curr[slot]);
+            }
+            maxDistance = std::max(maxDistance, distance / 2.0);
+        }
+        scaling.strideMixStability = 1.0 - maxDistance;
+    }
+}
+
+OperatorInfo ScalingModel::predict(double footprint) const
+{
+    // 名称驻留到预测算子自己的表中，随算子释放，不进入进程内共享的表
+    std::shared_ptr<StringTable> names = std::make_shared<StringTable>();
+    std::map<std::string, std::vector<VariableInfo>> functionVariables;
+    std::vector<std::string> order;
+    for (const auto &scaling : variables) {
+        std::vector<std::pair<int, double>> patterns;
+        for (const auto &pattern : scaling.patterns) {
+            int stride = pattern.stride;
+            if (!pattern.constantStride && pattern.strideLaw.points > 0) {
+                int predicted = static_cast<int>(std::llround(pattern.strideLaw.predict(footprint)));
+                stride = (stride < 0) ? -predicted : predicted;
+            }
+            patterns.push_back(std::make_pair(stride, pattern.percentage));
+        }
+        unsigned long long size =
+            static_cast<unsigned long long>(std::max(1.0, std::round(scaling.sizeLaw.predict(footprint))));
+        unsigned long long access =
+            static_cast<unsigned long long>(std::max(0.0, std::round(scaling.accessLaw.predict(footprint))));
+        if (functionVariables.find(scaling.funcName) == functionVariables.end()) {
+            order.push_back(scaling.funcName);
+        }
+        InternedName varName(names.get(), names->intern(scaling.varName));
+        functionVariables[scaling.funcName].push_back(VariableInfo(varName, size, access, patterns));
+    }
+
+    std::vector<FunctionInfo> functions;
+    for (const auto &funcName : order) {
+        functions.push_back(FunctionInfo(InternedName(names.get(), names->intern(funcName)), functionVariables[funcName]));
+    }
+    OperatorInfo op(opName, functions);
+    op.names = names;
+    return op;
+}
+
+std::vector<AccessFeatureVector> ScalingModel::deduct(const OperatorInfo &op, std::vector<std::string> &funcNames)
+{
+    std::vector<AccessFeatureVector> results;
+    funcNames.clear();
+    for (const auto &func : op.functions) {
+        AccessStrategyDeducter deducter;
+        deducter.deductAccessStrategy(func);
+        for (const auto &featureVector : deducter.accessFeatureVectors) {
+            results.push_back(featureVector);
+            funcNames.push_back(func.name.str());
+        }
+    }
+    return results;
+}
+
+std::vector<ScalingModel::StrategyFlip> ScalingModel::findFlips(double minFootprint, double maxFootprint,
+                                                                int stepsPerDoubling) const
+{
+    std::vector<StrategyFlip> flips;
+    std::map<std::pair<std::string, std::string>, AccessStrategyConfig> previous;
+    double ratio = std::pow(2.0, 1.0 / stepsPerDoubling);
+    for (double footprint = minFootprint; footprint <= maxFootprint * (1 + 1e-9); footprint *= ratio) {
+        // 推断结果中的变量名引用预测算子的驻留表，算子须在使用结果期间存活
+        OperatorInfo op = predict(footprint);
+        std::vector<std::string> funcNames;
+        std::vector<AccessFeatureVector> results = deduct(op, funcNames);
+        for (size_t i = 0; i < results.size(); i++) {
+            auto key = std::make_pair(funcNames[i], results[i].varName.str());
+            const AccessStrategyConfig &config = results[i].accessStrategyConfig;
+            auto it = previous.find(key);
+            if (it != previous.end() && it->second.accessStrategy != config.accessStrategy) {
+                StrategyFlip flip;
+                flip.funcName = key.first;
+                flip.varName = key.second;
+                flip.from = it->second;
+                flip.to = config;
+                flip.footprint = footprint;
+                flips.push_back(flip);
+            }
+            previous[key] = config;
+        }
+    }
+    return flips;
+}
+
+void ScalingModel::printReport(const std::vector<double> &targets) const
+{
+    std::cout << "算子: " << opName << "，已采集数据集:";
+    for (const auto &dataset : datasets) {
+        std::cout << " " << dataset.dataset << "(" << formatBytes(dataset.footprint) << ")";
+    }
+    std::cout << std::endl;
+
+    std::cout << "\n[缩放规律] S = a·x^b, N = c·x^d (x为算子总数据量)" << std::endl;
+    for (const auto &scaling : variables) {
+        std::cout << "  " << scaling.funcName << "/" << scaling.varName << ": S∝x^" << std::fixed
+                  << std::setprecision(3) << scaling.sizeLaw.exponent << "(R²=" << scaling.sizeLaw.r2 << ")"
+                  << ", N∝x^" << scaling.accessLaw.exponent << "(R²=" << scaling.accessLaw.r2 << ")"
+                  << ", 步长稳定性=" << scaling.strideMixStability;
+        for (const auto &pattern : scaling.patterns) {
+            if (!pattern.constantStride) {
+                std::cout << ", 步长" << pattern.stride << "∝x^" << pattern.strideLaw.exponent;
+            }
+        }
+        if (scaling.sizeLaw.points < 2) {
+            std::cout << " [警告: 样本不足，按线性缩放]";
+        }
+        if (scaling.strideMixStability < STABILITY_WARNING) {
+            std::cout << " [警告: 步长组成随规模变化]";
+        }
+        std::cout << std::endl;
+    }
+
+    for (double target : targets) {
+        std::cout << "\n[预测] 规模 " << formatBytes(target) << std::endl;
+        OperatorInfo op = predict(target);
+        std::vector<std::string> funcNames;
+        std::vector<AccessFeatureVector> results = deduct(op, funcNames);
+        for (size_t i = 0; i < results.size(); i++) {
+            std::cout << "  " << funcNames[i] << "/";
+            results[i].printOneLine();
+            std::cout << std::endl;
+        }
+    }
+
+    // 未指定更大的目标规模时，扫描到最大已采集规模的16倍
+    double maxFootprint = datasets.back().footprint * 16;
+    for (double target : targets) {
+        maxFootprint = std::max(maxFootprint, target);
+    }
+    std::vector<StrategyFlip> flips = findFlips(datasets.front().footprint, maxFootprint);
+    std::cout << "\n[策略变化点] 扫描范围 " << formatBytes(datasets.front().footprint) << " ~ "
+              << formatBytes(maxFootprint) << std::endl;
+    if (flips.empty()) {
+        std::cout << "  无" << std::endl;
+    }
+    for (const auto &flip : flips) {
+        std::cout << "  " << flip.funcName << "/" << flip.varName << ": " << flip.from.getStrategyName() << " → "
+                  << flip.to.getStrategyName() << " 于约 " << formatBytes(flip.footprint) << std::endl;
+    }
+}
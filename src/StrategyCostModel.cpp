@@ -0,0 +1,204 @@
+#include "StrategyCostModel.hpp"
+#include "FileUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+// 按步长直方图估算的空间缺失率，未被步长覆盖的访问视为随机访问
+void estimateMissRates(const AccessFeatureVector &featureVector, int lineBytes, int elementSize,
+                       double &stridedMiss, double &randomShare)
+{
+    double covered = 0.0;
+    stridedMiss = 0.0;
+    for (const auto &pattern : featureVector.patterns) {
+        double strideBytes = std::abs(static_cast<double>(pattern.first)) * elementSize;
+        stridedMiss += pattern.second * std::min(1.0, strideBytes / lineBytes);
+        covered += pattern.second;
+    }
+    randomShare = std::max(0.0, 1.0 - covered);
+}
+
+// 缺失次数不少于首次填充所需的行数（强制缺失）
+double estimateMisses(double N, double S, double missRate, int lineBytes)
+{
+    double compulsory = std::min(N, std::ceil(S / lineBytes));
+    return std::max(N * missRate, compulsory);
+}
+
+std::unique_ptr<StrategyCostModel> &defaultModel()
+{
+    static std::unique_ptr<StrategyCostModel> model(new ThresholdStrategyModel());
+    return model;
+}
+
+} // namespace
+
+bool DecisionThresholds::loadFromFile(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "无法打开阈值文件: " << path << std::endl;
+        return false;
+    }
+
+    return FileUtils::parseKeyValueLines(file, path, [this](const std::string &key, const std::string &value) {
+        if (key == "strategy_determine_factor") {
+            strategyDetermineFactor = std::stod(value);
+        } else if (key == "random_access_locality") {
+            randomAccessLocality = std::stod(value);
+        } else {
+            return false;
+        }
+        return true;
+    });
+}
+
+bool DecisionThresholds::saveToFile(const std::string &path, const std::string &header) const
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "无法写入阈值文件: " << path << std::endl;
+        return false;
+    }
+    file << header << std::setprecision(6) << "strategy_determine_factor = " << strategyDetermineFactor << "\n"
+         << "random_access_locality = " << randomAccessLocality << "\n";
+    return static_cast<bool>(file);
+}
+
+void StrategyCostModel::estimateCosts(AccessFeatureVector &featureVector, const HardwareProfile &profile)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    double N = static_cast<double>(featureVector.N);
+    double S = static_cast<double>(featureVector.S);
+    StrategyCosts &costs = featureVector.strategyCosts;
+
+    // BULK
+    if (featureVector.C > 0 && static_cast<unsigned long long>(featureVector.C) >= featureVector.S) {
+        costs.cycles[BULK] = profile.dmaCycles(S) + N * profile.smLatency;
+    } else {
+        costs.cycles[BULK] = infinity;
+    }
+
+    if (featureVector.C <= 0) {
+        costs.cycles[SINGLE] = infinity;
+        costs.cycles[DIRECT] = infinity;
+        return;
+    }
+
+    // SINGLE：line = floor(log2(C))
+    int singleLine = static_cast<int>(std::floor(std::log2(featureVector.C)));
+    int singleBytes = AccessStrategyConfig::calculateLineSpace(singleLine);
+    double singleMisses = estimateLineFills(featureVector, SINGLE, profile);
+    costs.cycles[SINGLE] = N * profile.smLatency + singleMisses * profile.dmaCycles(singleBytes);
+
+    // DIRECT：参数与determineParameters一致
+    int set, line;
+    AccessStrategyDeducter::calculateDirectParameters(featureVector, set, line);
+    int directBytes = AccessStrategyConfig::calculateLineSpace(line);
+    double directMisses = estimateLineFills(featureVector, DIRECT, profile);
+    costs.cycles[DIRECT] = 2 * N * profile.smLatency + directMisses * profile.dmaCycles(directBytes);
+}
+
+double StrategyCostModel::estimateLineFills(const AccessFeatureVector &featureVector, AccessStrategy strategy,
+                                            const HardwareProfile &profile)
+{
+    double N = static_cast<double>(featureVector.N);
+    double S = static_cast<double>(featureVector.S);
+    double stridedMiss, randomShare;
+    if (strategy == BULK) {
+        return (featureVector.N > 0) ? 1.0 : 0.0;
+    }
+    if (featureVector.C <= 0 || (strategy != SINGLE && strategy != DIRECT)) {
+        return std::numeric_limits<double>::infinity();
+    }
+    if (strategy == SINGLE) {
+        int singleBytes =
+            AccessStrategyConfig::calculateLineSpace(static_cast<int>(std::floor(std::log2(featureVector.C))));
+        estimateMissRates(featureVector, singleBytes, profile.elementSize, stridedMiss, randomShare);
+        return estimateMisses(N, S, stridedMiss + randomShare, singleBytes);
+    }
+    int set, line;
+    AccessStrategyDeducter::calculateDirectParameters(featureVector, set, line);
+    int directBytes = AccessStrategyConfig::calculateLineSpace(line);
+    double capacity = static_cast<double>(1 << set) * directBytes;
+    estimateMissRates(featureVector, directBytes, profile.elementSize, stridedMiss, randomShare);
+    // 有重用距离直方图时，随机部分的命中率取同容量LRU缓存的命中率，否则按容量比例估计
+    double randomHit = (featureVector.reuse != nullptr) ? featureVector.reuse->getHitRatio(capacity)
+                                                        : std::min(1.0, capacity / S);
+    double randomMiss = randomShare * (1.0 - randomHit);
+    return estimateMisses(N, S, stridedMiss + randomMiss, directBytes);
+}
+
+double StrategyCostModel::getSelectedCycles(const AccessFeatureVector &featureVector, const HardwareProfile &profile)
+{
+    double cycles = featureVector.strategyCosts.get(featureVector.accessStrategyConfig.accessStrategy);
+    return std::isinf(cycles) ? featureVector.N * profile.ddrLatency : cycles;
+}
+
+std::unique_ptr<StrategyCostModel> StrategyCostModel::create(const std::string &name)
+{
+    if (name == "threshold") {
+        return std::unique_ptr<StrategyCostModel>(new ThresholdStrategyModel());
+    }
+    if (name == "cycle") {
+        return std::unique_ptr<StrategyCostModel>(new CycleCostStrategyModel());
+    }
+    return std::unique_ptr<StrategyCostModel>();
+}
+
+const StrategyCostModel &StrategyCostModel::getDefault() { return *defaultModel(); }
+
+bool StrategyCostModel::selectDefault(const std::string &name)
+{
+    std::unique_ptr<StrategyCostModel> model = create(name);
+    if (!model) {
+        return false;
+    }
+    defaultModel() = std::move(model);
+    return true;
+}
+
+std::vector<std::string> StrategyCostModel::getModelNames() { return {"threshold", "cycle"}; }
+
+AccessStrategy ThresholdStrategyModel::selectStrategy(const AccessFeatureVector &featureVector) const
+{
+    // 如果划分后的SM空间大小大于访存空间大小，则使用BULK策略
+    if (static_cast<unsigned long long>(featureVector.C) >= featureVector.S) {
+        return AccessStrategy::BULK;
+    }
+    // 局部性取空间与时间局部性之和（与F一致），重用频繁的小工作集即使步长分散也可由缓存行满足
+    double locality = featureVector.L + featureVector.T;
+    // 如果无步长或局部性小于策略决断常量，则使用DIRECT策略
+    if (featureVector.patterns.empty() || locality <= thresholds.strategyDetermineFactor) {
+        return AccessStrategy::DIRECT;
+    }
+    // 如果只有一个步长且步长为0，且局部性小于随机访问阈值，说明这个变量的访问实际上是随机的，用DIRECT策略
+    if (featureVector.patterns.size() == 1 && featureVector.patterns[0].first == 0 &&
+        locality < thresholds.randomAccessLocality) {
+        return AccessStrategy::DIRECT;
+    }
+    return AccessStrategy::SINGLE;
+}
+
+AccessStrategy CycleCostStrategyModel::selectStrategy(const AccessFeatureVector &featureVector) const
+{
+    AccessStrategy best = AccessStrategy::DIRECT;
+    const AccessStrategy candidates[] = {BULK, SINGLE, DIRECT};
+    for (AccessStrategy candidate : candidates) {
+        if (featureVector.strategyCosts.cycles[candidate] < featureVector.strategyCosts.cycles[best]) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+AccessStrategy AmStrategyModel::selectStrategy(const AccessFeatureVector &featureVector) const
+{
+    unsigned long long region = AccessStrategyConfig::alignSize(featureVector.S, vectorWidth);
+    return (static_cast<unsigned long long>(featureVector.C) >= region) ? AccessStrategy::BULK : AccessStrategy::SINGLE;
+}
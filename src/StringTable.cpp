@@ -0,0 +1,52 @@
+#include "StringTable.hpp"
+
+const uint32_t StringTable::EMPTY_SLOT;
+
+uint64_t StringTable::hash(const std::string &str)
+{
+    // FNV-1a
+    uint64_t value = 14695981039346656037ull;
+    for (unsigned char c : str) {
+        value ^= c;
+        value *= 1099511628211ull;
+    }
+    return value;
+}
+
+void StringTable::rehash(size_t slotCount)
+{
+    slots.assign(slotCount, EMPTY_SLOT);
+    for (uint32_t id = 0; id < strings.size(); id++) {
+        size_t slot = hash(strings[id]) & (slotCount - 1);
+        while (slots[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        slots[slot] = id;
+    }
+}
+
+uint32_t StringTable::intern(const std::string &str)
+{
+    // 装载因子不超过1/2
+    if ((strings.size() + 1) * 2 > slots.size()) {
+        rehash(slots.empty() ? 16 : slots.size() * 2);
+    }
+    size_t mask = slots.size() - 1;
+    size_t slot = hash(str) & mask;
+    while (slots[slot] != EMPTY_SLOT) {
+        if (strings[slots[slot]] == str) {
+            return slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(str);
+    slots[slot] = id;
+    return id;
+}
+
+const std::string &InternedName::emptyName()
+{
+    static const std::string empty;
+    return empty;
+}
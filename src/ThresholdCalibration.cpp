@@ -0,0 +1,317 @@
+#include "ThresholdCalibration.hpp"
+#include "FileUtils.hpp"
+#include "ParallelFor.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace
+{
+
+const char KEY_SEPARATOR = '\x1f';
+
+std::string makeKey(const std::string &opName, const std::string &dataset, const std::string &funcName,
+                    const std::string &varName)
+{
+    return opName + KEY_SEPARATOR + dataset + KEY_SEPARATOR + funcName + KEY_SEPARATOR + varName;
+}
+
+std::vector<std::string> splitLine(const std::string &line)
+{
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+// 策略名可带或不带CACHE_前缀
+bool parseStrategy(const std::string &name, AccessStrategy &strategy)
+{
+    for (int s = BULK; s <= UNSUITABLE; s++) {
+        std::string full = AccessStrategyConfig(static_cast<AccessStrategy>(s)).getStrategyName();
+        if (name == full || name == full.substr(6)) {
+            strategy = static_cast<AccessStrategy>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string stripDatasetSuffix(const std::string &dataset)
+{
+    static const std::string SUFFIX = "_DATASET";
+    if (dataset.size() > SUFFIX.size() && dataset.compare(dataset.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) == 0) {
+        return dataset.substr(0, dataset.size() - SUFFIX.size());
+    }
+    return dataset;
+}
+
+double percent(size_t part, size_t total) { return (total == 0) ? 0.0 : 100.0 * part / total; }
+
+} // namespace
+
+AccessStrategy StrategyMeasurement::getFastest() const
+{
+    AccessStrategy fastest = UNSUITABLE;
+    for (int s = BULK; s <= UNSUITABLE; s++) {
+        if (cycles[s] < cycles[fastest]) {
+            fastest = static_cast<AccessStrategy>(s);
+        }
+    }
+    return fastest;
+}
+
+size_t CalibrationResult::getAgreeBefore() const
+{
+    size_t total = 0;
+    for (size_t count : agreeBefore) {
+        total += count;
+    }
+    return total;
+}
+
+size_t CalibrationResult::getAgreeAfter() const
+{
+    size_t total = 0;
+    for (size_t count : agreeAfter) {
+        total += count;
+    }
+    return total;
+}
+
+bool ThresholdCalibrator::loadFile(const std::string &path, std::vector<StrategyMeasurement> &measurements)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "无法打开实测文件: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(file, line);
+    if (line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        line.erase(0, 3);
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    std::vector<std::string> header = splitLine(line);
+    int datasetColumn = -1, functionColumn = -1, variableColumn = -1, strategyColumn = -1, cyclesColumn = -1;
+    for (size_t i = 0; i < header.size(); i++) {
+        int column = static_cast<int>(i);
+        if (header[i] == "计算负载") {
+            datasetColumn = column;
+        } else if (header[i] == "核函数名") {
+            functionColumn = column;
+        } else if (header[i] == "变量名") {
+            variableColumn = column;
+        } else if (header[i] == "访存策略名") {
+            strategyColumn = column;
+        } else if (header[i] == "实测周期") {
+            cyclesColumn = column;
+        }
+    }
+    if (functionColumn < 0 || variableColumn < 0 || strategyColumn < 0 || cyclesColumn < 0) {
+        std::cerr << "错误: 实测文件 " << path << " 缺少 核函数名/变量名/访存策略名/实测周期 列" << std::endl;
+        return false;
+    }
+    int lastColumn = std::max(std::max(datasetColumn, functionColumn),
+                              std::max(std::max(variableColumn, strategyColumn), cyclesColumn));
+
+    // 同一变量的各行合并为一条记录
+    std::string opName = FileUtils::getFileNameWithoutExtension(path);
+    std::map<std::string, size_t> index;
+    int lineNo = 1;
+    while (std::getline(file, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<std::string> fields = splitLine(line);
+        AccessStrategy strategy;
+        double cycles = 0.0;
+        bool valid = static_cast<int>(fields.size()) > lastColumn && parseStrategy(fields[strategyColumn], strategy);
+        if (valid) {
+            char *end = nullptr;
+            cycles = std::strtod(fields[cyclesColumn].c_str(), &end);
+            valid = end != fields[cyclesColumn].c_str() && *end == '\0' && cycles >= 0;
+        }
+        if (!valid) {
+            std::cerr << "警告: " << path << ":" << lineNo << " 格式错误，跳过该行" << std::endl;
+            continue;
+        }
+        std::string dataset = (datasetColumn >= 0) ? stripDatasetSuffix(fields[datasetColumn]) : "";
+        std::string key = makeKey(opName, dataset, fields[functionColumn], fields[variableColumn]);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            it = index.insert(std::make_pair(key, measurements.size())).first;
+            StrategyMeasurement measurement;
+            measurement.opName = opName;
+            measurement.dataset = dataset;
+            measurement.funcName = fields[functionColumn];
+            measurement.varName = fields[variableColumn];
+            measurements.push_back(measurement);
+        }
+        double &slot = measurements[it->second].cycles[strategy];
+        slot = std::min(slot, cycles);
+    }
+    return true;
+}
+
+bool ThresholdCalibrator::loadMeasurements(const std::string &path, std::vector<StrategyMeasurement> &measurements)
+{
+    measurements.clear();
+    if (!FileUtils::isDirectory(path)) {
+        return loadFile(path, measurements);
+    }
+    std::vector<std::string> files = FileUtils::getCSVFiles(path);
+    std::sort(files.begin(), files.end());
+    for (const auto &name : files) {
+        if (!loadFile(path + "/" + name, measurements)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ThresholdCalibrator::countAgreement(const std::vector<Target> &targets, const DecisionThresholds &thresholds,
+                                         size_t (&agree)[UNSUITABLE + 1])
+{
+    std::fill(agree, agree + UNSUITABLE + 1, 0);
+    ThresholdStrategyModel model(thresholds);
+    for (const auto &target : targets) {
+        // 每个函数的推断使用本线程的内存池，推断结束后整体回收
+        ArenaScope arenaScope(MonotonicArena::threadArena(), true);
+        AccessStrategyDeducter deducter;
+        deducter.costModel = &model;
+        deducter.deductAccessStrategy(*target.func);
+        for (const auto &variable : target.fastest) {
+            for (const auto &featureVector : deducter.accessFeatureVectors) {
+                if (featureVector.varName.str() == variable.first) {
+                    if (featureVector.accessStrategyConfig.accessStrategy == variable.second) {
+                        agree[variable.second]++;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+CalibrationResult ThresholdCalibrator::calibrate(const std::vector<CalibrationInput> &inputs,
+                                                 const std::vector<StrategyMeasurement> &measurements,
+                                                 const DecisionThresholds &current) const
+{
+    CalibrationResult result;
+    result.before = current;
+    result.after = current;
+    result.measured = measurements.size();
+
+    std::map<std::string, AccessStrategy> fastest;
+    for (const auto &measurement : measurements) {
+        fastest[makeKey(measurement.opName, measurement.dataset, measurement.funcName, measurement.varName)] =
+            measurement.getFastest();
+    }
+    std::vector<Target> targets;
+    for (const auto &input : inputs) {
+        for (const auto &func : input.op.functions) {
+            Target target;
+            target.func = &func;
+            for (const auto &variable : func.variables) {
+                auto it = fastest.find(makeKey(input.opName, input.dataset, func.name.str(), variable.name.str()));
+                if (it != fastest.end()) {
+                    target.fastest.push_back(std::make_pair(variable.name.str(), it->second));
+                    result.fastestCount[it->second]++;
+                }
+            }
+            if (!target.fastest.empty()) {
+                result.matched += target.fastest.size();
+                targets.push_back(target);
+            }
+        }
+    }
+
+    // 网格点按步数生成，最后一个候选为当前阈值
+    std::vector<DecisionThresholds> grid;
+    int factorSteps = static_cast<int>(std::floor((FACTOR_MAX - FACTOR_MIN) / FACTOR_STEP + 1e-9));
+    int localitySteps =
+        static_cast<int>(std::floor((RANDOM_LOCALITY_MAX - RANDOM_LOCALITY_MIN) / RANDOM_LOCALITY_STEP + 1e-9));
+    for (int f = 0; f <= factorSteps; f++) {
+        for (int r = 0; r <= localitySteps; r++) {
+            DecisionThresholds thresholds;
+            thresholds.strategyDetermineFactor = FACTOR_MIN + f * FACTOR_STEP;
+            thresholds.randomAccessLocality = RANDOM_LOCALITY_MIN + r * RANDOM_LOCALITY_STEP;
+            grid.push_back(thresholds);
+        }
+    }
+    grid.push_back(current);
+    result.gridPoints = grid.size();
+
+    std::vector<std::array<size_t, UNSUITABLE + 1>> agreement(grid.size());
+    parallelFor(grid.size(), jobs, [&](size_t point) {
+        size_t agree[UNSUITABLE + 1];
+        countAgreement(targets, grid[point], agree);
+        std::copy(agree, agree + UNSUITABLE + 1, agreement[point].begin());
+    });
+
+    // 一致数最多者中取与当前阈值（按各自网格范围归一化）距离最小的
+    auto total = [&](size_t point) {
+        size_t sum = 0;
+        for (size_t count : agreement[point]) {
+            sum += count;
+        }
+        return sum;
+    };
+    auto distance = [&](size_t point) {
+        return std::fabs(grid[point].strategyDetermineFactor - current.strategyDetermineFactor) /
+                   (FACTOR_MAX - FACTOR_MIN) +
+               std::fabs(grid[point].randomAccessLocality - current.randomAccessLocality) /
+                   (RANDOM_LOCALITY_MAX - RANDOM_LOCALITY_MIN);
+    };
+    size_t currentPoint = grid.size() - 1;
+    size_t best = currentPoint;
+    for (size_t point = 0; point < grid.size(); point++) {
+        if (total(point) > total(best) || (total(point) == total(best) && distance(point) < distance(best))) {
+            best = point;
+        }
+    }
+    result.after = grid[best];
+    std::copy(agreement[currentPoint].begin(), agreement[currentPoint].end(), result.agreeBefore);
+    std::copy(agreement[best].begin(), agreement[best].end(), result.agreeAfter);
+    return result;
+}
+
+void ThresholdCalibrator::printReport(const CalibrationResult &result, std::ostream &os)
+{
+    std::ios::fmtflags flags = os.flags();
+    os << "[阈值校准] 实测变量" << result.measured << "个，在输入中找到" << result.matched << "个，评估"
+       << result.gridPoints << "组阈值" << std::endl;
+    os << "  strategy_determine_factor: " << result.before.strategyDetermineFactor << " → "
+       << result.after.strategyDetermineFactor << std::endl;
+    os << "  random_access_locality: " << result.before.randomAccessLocality << " → "
+       << result.after.randomAccessLocality << std::endl;
+    os << std::fixed << std::setprecision(1);
+    os << "  与实测最快策略一致: " << result.getAgreeBefore() << "/" << result.matched << " ("
+       << percent(result.getAgreeBefore(), result.matched) << "%) → " << result.getAgreeAfter() << "/"
+       << result.matched << " (" << percent(result.getAgreeAfter(), result.matched) << "%)" << std::endl;
+    for (int s = BULK; s <= UNSUITABLE; s++) {
+        if (result.fastestCount[s] == 0) {
+            continue;
+        }
+        os << "    实测最快为" << AccessStrategyConfig(static_cast<AccessStrategy>(s)).getStrategyName() << ": "
+           << result.fastestCount[s] << "个，一致 " << result.agreeBefore[s] << " → " << result.agreeAfter[s]
+           << std::endl;
+    }
+    os.flags(flags);
+}
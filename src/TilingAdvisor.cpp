@@ -0,0 +1,245 @@
+#include "TilingAdvisor.hpp"
+#include "StrategyCostModel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace
+{
+
+std::atomic<bool> &enabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// 不超过extent的2的幂及extent的约数，升序
+std::vector<uint64_t> candidateExtents(uint64_t extent)
+{
+    std::vector<uint64_t> values;
+    for (uint64_t value = 1; value <= extent; value <<= 1) {
+        values.push_back(value);
+    }
+    for (uint64_t divisor = 1; divisor * divisor <= extent; divisor++) {
+        if (extent % divisor == 0) {
+            values.push_back(divisor);
+            values.push_back(extent / divisor);
+        }
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+std::string formatShape(const ArrayShape &shape)
+{
+    return (shape.rows > 1) ? std::to_string(shape.rows) + "x" + std::to_string(shape.cols) : std::to_string(shape.cols);
+}
+
+} // namespace
+
+bool TilingPlan::hasTiles() const
+{
+    for (const auto &choice : choices) {
+        if (choice.tiled) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TilingAdvisor::isEnabled() { return enabledStorage().load(); }
+
+void TilingAdvisor::setEnabled(bool enabled) { enabledStorage().store(enabled); }
+
+ArrayShape TilingAdvisor::inferShape(const AccessFeatureVector &featureVector, int elementSize)
+{
+    ArrayShape shape;
+    uint64_t elements = (featureVector.S + elementSize - 1) / elementSize;
+    shape.cols = elements;
+    std::vector<std::pair<int, double>> patterns(featureVector.patterns.begin(), featureVector.patterns.end());
+    std::stable_sort(patterns.begin(), patterns.end(),
+                     [](const std::pair<int, double> &a, const std::pair<int, double> &b) { return a.second > b.second; });
+    for (const auto &pattern : patterns) {
+        uint64_t stride = static_cast<uint64_t>(std::abs(static_cast<long long>(pattern.first)));
+        if (stride <= 1 || stride >= elements) {
+            continue;
+        }
+        for (uint64_t cols : {stride, stride + 1}) {
+            if (elements % cols == 0) {
+                shape.rows = elements / cols;
+                shape.cols = cols;
+                return shape;
+            }
+        }
+    }
+    return shape;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> TilingAdvisor::candidateTiles(const ArrayShape &shape)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> tiles;
+    std::vector<uint64_t> rowValues = candidateExtents(shape.rows);
+    std::vector<uint64_t> colValues = candidateExtents(shape.cols);
+    for (uint64_t rows : rowValues) {
+        for (uint64_t cols : colValues) {
+            if (rows != shape.rows || cols != shape.cols) {
+                tiles.push_back(std::make_pair(rows, cols));
+            }
+        }
+    }
+    return tiles;
+}
+
+TileChoice TilingAdvisor::evaluateTile(const AccessFeatureVector &featureVector, const ArrayShape &shape,
+                                       uint64_t tileRows, uint64_t tileCols, const HardwareProfile &profile)
+{
+    TileChoice choice;
+    choice.shape = shape;
+    choice.tiled = true;
+    choice.tileRows = tileRows;
+    choice.tileCols = tileCols;
+    double tileBytes = static_cast<double>(tileRows) * tileCols * profile.elementSize;
+    choice.tileBytes = static_cast<int>(std::min<double>(tileBytes, std::numeric_limits<int>::max()));
+    choice.tiles = ((shape.rows + tileRows - 1) / tileRows) * ((shape.cols + tileCols - 1) / tileCols);
+
+    double S = static_cast<double>(featureVector.S);
+    double N = static_cast<double>(featureVector.N);
+    choice.dmaVolume = S;
+    if (featureVector.reuse != nullptr) {
+        // 重用距离超过分块大小的访问需要重新载入其所在的数据
+        double reloadBytes = N * (1.0 - featureVector.reuse->getHitRatio(tileBytes)) * profile.elementSize;
+        choice.dmaVolume = std::max(S, reloadBytes);
+    }
+    choice.passes = choice.dmaVolume / S;
+    // 整行分块是一段连续内存，否则每行一次传输
+    uint64_t transfersPerTile = (tileCols == shape.cols) ? 1 : tileRows;
+    choice.transfers = static_cast<uint64_t>(std::ceil(choice.tiles * transfersPerTile * choice.passes));
+    choice.cycles = choice.transfers * profile.dmaLatency + choice.dmaVolume / profile.dmaBandwidth +
+                    N * profile.smLatency;
+    return choice;
+}
+
+TilingPlan TilingAdvisor::advise(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                                 int C_total, const HardwareProfile &profile)
+{
+    TilingPlan plan;
+    plan.funcName = funcName;
+    plan.budget = C_total;
+    std::vector<const AccessFeatureVector *> candidates;
+    for (const auto &featureVector : accessFeatureVectors) {
+        AccessStrategy strategy = featureVector.accessStrategyConfig.accessStrategy;
+        if (strategy == BULK) {
+            plan.budget -= featureVector.accessStrategyConfig.getSMFootprint();
+        } else if (strategy == SINGLE || strategy == DIRECT) {
+            candidates.push_back(&featureVector);
+        }
+    }
+    plan.budget = std::max(0, plan.budget);
+
+    // 每个候选变量的可选方案：第0个为保持原策略，其余为比原策略更快的分块
+    int unit = std::max(1, profile.smAlignment);
+    size_t capacity = static_cast<size_t>(plan.budget / unit);
+    std::vector<std::vector<TileChoice>> options(candidates.size());
+    std::vector<std::vector<size_t>> weights(candidates.size());
+    for (size_t v = 0; v < candidates.size(); v++) {
+        const AccessFeatureVector &featureVector = *candidates[v];
+        TileChoice keep;
+        keep.name = featureVector.varName.str();
+        keep.strategy = featureVector.accessStrategyConfig.accessStrategy;
+        keep.originalCycles = StrategyCostModel::getSelectedCycles(featureVector, profile);
+        keep.cycles = keep.originalCycles;
+        keep.shape = inferShape(featureVector, profile.elementSize);
+        keep.tileBytes = featureVector.accessStrategyConfig.getSMFootprint();
+        options[v].push_back(keep);
+        for (const auto &tile : candidateTiles(keep.shape)) {
+            if (static_cast<double>(tile.first) * tile.second * profile.elementSize > plan.budget) {
+                continue;
+            }
+            TileChoice choice = evaluateTile(featureVector, keep.shape, tile.first, tile.second, profile);
+            if (choice.cycles < keep.originalCycles) {
+                choice.name = keep.name;
+                choice.strategy = keep.strategy;
+                choice.originalCycles = keep.originalCycles;
+                options[v].push_back(choice);
+            }
+        }
+        for (const auto &choice : options[v]) {
+            weights[v].push_back(static_cast<size_t>((choice.tileBytes + unit - 1) / unit));
+        }
+    }
+
+    // 分组背包：best[u]为已处理变量占用不超过u个单位时的最小周期，selected记录每个变量的方案
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> best(capacity + 1, 0.0);
+    std::vector<std::vector<size_t>> selected(candidates.size(), std::vector<size_t>(capacity + 1, 0));
+    bool feasible = true;
+    for (size_t v = 0; v < candidates.size() && feasible; v++) {
+        std::vector<double> next(capacity + 1, infinity);
+        for (size_t u = 0; u <= capacity; u++) {
+            for (size_t o = 0; o < options[v].size(); o++) {
+                if (weights[v][o] <= u && best[u - weights[v][o]] + options[v][o].cycles < next[u]) {
+                    next[u] = best[u - weights[v][o]] + options[v][o].cycles;
+                    selected[v][u] = o;
+                }
+            }
+        }
+        best = std::move(next);
+        feasible = !std::isinf(best[capacity]);
+    }
+
+    std::vector<size_t> chosen(candidates.size(), 0);
+    if (feasible) {
+        size_t u = capacity;
+        for (size_t v = candidates.size(); v-- > 0;) {
+            chosen[v] = selected[v][u];
+            u -= weights[v][chosen[v]];
+        }
+    }
+    for (size_t v = 0; v < candidates.size(); v++) {
+        const TileChoice &choice = options[v][chosen[v]];
+        plan.choices.push_back(choice);
+        plan.used += choice.tileBytes;
+        plan.originalCycles += choice.originalCycles;
+        plan.tiledCycles += choice.cycles;
+    }
+    return plan;
+}
+
+void TilingAdvisor::printReport(const std::vector<TilingPlan> &plans, std::ostream &os)
+{
+    std::ios::fmtflags flags = os.flags();
+    for (const auto &plan : plans) {
+        if (plan.choices.empty()) {
+            continue;
+        }
+        os << "[分块建议] " << plan.funcName << ": 可用SM=" << plan.budget << "B（扣除BULK变量），方案占用=" << plan.used
+           << "B" << std::endl;
+        for (const auto &choice : plan.choices) {
+            os << "  " << choice.name << "(" << formatShape(choice.shape) << ", "
+               << AccessStrategyConfig(choice.strategy).getStrategyName() << "): ";
+            if (choice.tiled) {
+                os << "分块BULK " << ((choice.shape.rows > 1) ? std::to_string(choice.tileRows) + "x" : "")
+                   << choice.tileCols << ", 每块" << choice.tileBytes << "B, " << choice.tiles << "块, DMA"
+                   << choice.transfers << "次, 传输量" << std::fixed << std::setprecision(0) << choice.dmaVolume << "B("
+                   << std::setprecision(2) << choice.passes << "遍), ";
+                os.flags(flags);
+            } else {
+                os << "保持原策略, ";
+            }
+            os << "周期 " << StrategyCosts::formatCycles(choice.originalCycles) << " → "
+               << StrategyCosts::formatCycles(choice.cycles) << std::endl;
+        }
+        if (plan.hasTiles()) {
+            os << "  估算周期 " << StrategyCosts::formatCycles(plan.originalCycles) << " → "
+               << StrategyCosts::formatCycles(plan.tiledCycles) << ", 节省" << std::fixed << std::setprecision(1)
+               << (1.0 - plan.tiledCycles / plan.originalCycles) * 100 << "%" << std::endl;
+            os.flags(flags);
+        } else {
+            os << "  没有能降低估算周期的分块" << std::endl;
+        }
+        os << std::endl;
+    }
+}
@@ -0,0 +1,350 @@
+#include "TraceReader.hpp"
+#include "ChunkedTrace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+
+namespace
+{
+
+// 95%置信区间的正态分位数
+const double CONFIDENCE_Z = 1.96;
+
+// 抽样跟踪中单个(线程, 变量)的样本序列与当前批次的步长计数
+class SampleStream
+{
+public:
+    MasamtTrace::SampledSequence sequence;
+    std::unordered_map<int64_t, uint64_t> batch;
+    uint64_t batchStrides = 0;
+};
+
+void finishBatch(SampleStream &stream, TraceVariable &variable)
+{
+    if (stream.batchStrides == 0) {
+        return;
+    }
+    variable.batches++;
+    for (const auto &entry : stream.batch) {
+        double fraction = static_cast<double>(entry.second) / stream.batchStrides;
+        std::pair<double, double> &sums = variable.batchFractions[entry.first];
+        sums.first += fraction;
+        sums.second += fraction * fraction;
+    }
+    stream.batch.clear();
+    stream.batchStrides = 0;
+}
+
+std::atomic<unsigned int> &decodeJobsStorage()
+{
+    static std::atomic<unsigned int> jobs(0);
+    return jobs;
+}
+
+std::atomic<uint64_t> &reuseSampleRateStorage()
+{
+    static std::atomic<uint64_t> rate(TraceReader::REUSE_SAMPLE_AUTO);
+    return rate;
+}
+
+} // namespace
+
+unsigned int TraceReader::getDecodeJobs() { return decodeJobsStorage().load(); }
+
+void TraceReader::setDecodeJobs(unsigned int jobs) { decodeJobsStorage().store(jobs); }
+
+uint64_t TraceReader::getReuseSampleRate() { return reuseSampleRateStorage().load(); }
+
+void TraceReader::setReuseSampleRate(uint64_t rate) { reuseSampleRateStorage().store(rate); }
+
+uint64_t TraceReader::resolveReuseSampleRate(uint64_t rate, uint64_t accesses)
+{
+    if (rate != REUSE_SAMPLE_AUTO) {
+        return rate;
+    }
+    return (accesses + REUSE_EXACT_ACCESSES - 1) / REUSE_EXACT_ACCESSES + (accesses == 0 ? 1 : 0);
+}
+
+bool TraceReader::isTracePath(const std::string &path)
+{
+    return MasamtTrace::isTracePath(path) || ChunkedTrace::isChunkedTracePath(path);
+}
+
+bool TraceReader::readRawTrace(const std::string &content, std::vector<TraceVariable> &variables,
+                               MasamtTrace::SamplingConfig &sampling, const BlockVisitor &visitor)
+{
+    using namespace MasamtTrace;
+    variables.clear();
+    sampling = SamplingConfig();
+    TraceFileHeader header;
+    if (content.size() < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, content.data(), sizeof(header));
+    if (memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != TRACE_VERSION) {
+        return false;
+    }
+
+    bool hasBlocks = false;
+    size_t pos = sizeof(header);
+    while (pos < content.size()) {
+        uint32_t tag;
+        if (content.size() - pos < sizeof(tag)) {
+            return false;
+        }
+        memcpy(&tag, content.data() + pos, sizeof(tag));
+        if (tag == TRACE_SAMPLING) {
+            TraceSamplingRecord record;
+            // 抽样方式必须在所有地址块之前
+            if (content.size() - pos < sizeof(record) || hasBlocks) {
+                return false;
+            }
+            memcpy(&record, content.data() + pos, sizeof(record));
+            if (!SamplingConfig::fromRecord(record, sampling)) {
+                return false;
+            }
+            pos += sizeof(record);
+        } else if (tag == TRACE_VARIABLE) {
+            TraceVariableRecord record;
+            if (content.size() - pos < sizeof(record)) {
+                return false;
+            }
+            memcpy(&record, content.data() + pos, sizeof(record));
+            pos += sizeof(record);
+            if (content.size() - pos < static_cast<size_t>(record.kernelLength) + record.nameLength) {
+                return false;
+            }
+            if (record.id >= variables.size()) {
+                variables.resize(record.id + 1);
+            }
+            TraceVariable &variable = variables[record.id];
+            variable.kernel.assign(content.data() + pos, record.kernelLength);
+            variable.name.assign(content.data() + pos + record.kernelLength, record.nameLength);
+            variable.size = record.size;
+            variable.elementSize = std::max(1u, record.elementSize);
+            pos += record.kernelLength + record.nameLength;
+        } else if (tag == TRACE_BLOCK) {
+            TraceBlockRecord record;
+            if (content.size() - pos < sizeof(record)) {
+                return false;
+            }
+            memcpy(&record, content.data() + pos, sizeof(record));
+            pos += sizeof(record);
+            if ((content.size() - pos) / sizeof(uint64_t) < record.count) {
+                return false;
+            }
+            // 变量定义总在其第一个地址块之前
+            if (record.variable >= variables.size() || variables[record.variable].name.empty()) {
+                return false;
+            }
+            hasBlocks = true;
+            visitor(record, content.data() + pos);
+            pos += record.count * sizeof(uint64_t);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TraceReader::scanRawTrace(const std::string &content, std::vector<TraceVariable> &variables,
+                               MasamtTrace::SamplingConfig &sampling, uint64_t reuseSampleRate)
+{
+    using namespace MasamtTrace;
+    // 步长按各线程对各变量的访问序列计算，键为(线程, 变量)
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> lastAddress;
+    std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<ReuseDistanceAnalyzer>> reuseStreams;
+    std::map<std::pair<uint32_t, uint32_t>, SampleStream> sampleStreams;
+    bool valid = readRawTrace(content, variables, sampling, [&](const TraceBlockRecord &record, const char *addresses) {
+        TraceVariable &variable = variables[record.variable];
+        uint64_t elementSize = variable.elementSize;
+        if (sampling.isSampled()) {
+            auto inserted = sampleStreams.insert(std::make_pair(std::make_pair(record.thread, record.variable), SampleStream()));
+            SampleStream &stream = inserted.first->second;
+            variable.streams += inserted.second ? 1 : 0;
+            for (uint32_t i = 0; i < record.count; i++) {
+                uint64_t address;
+                memcpy(&address, addresses + i * sizeof(uint64_t), sizeof(address));
+                bool hasStride, newBatch;
+                int64_t stride;
+                if (!stream.sequence.next(sampling, address, elementSize, hasStride, stride, newBatch)) {
+                    continue;
+                }
+                if (newBatch) {
+                    finishBatch(stream, variable);
+                }
+                if (hasStride) {
+                    variable.strides.add(stride);
+                    stream.batch[stride]++;
+                    stream.batchStrides++;
+                }
+                if (sampling.mode == SAMPLE_HASH) {
+                    variable.addressCounts[address]++;
+                }
+                variable.accesses++;
+            }
+            return;
+        }
+        if (reuseSampleRate > 0) {
+            std::unique_ptr<ReuseDistanceAnalyzer> &analyzer = reuseStreams[std::make_pair(record.thread, record.variable)];
+            if (!analyzer) {
+                analyzer.reset(new ReuseDistanceAnalyzer(reuseSampleRate));
+            }
+            for (uint32_t i = 0; i < record.count; i++) {
+                uint64_t address;
+                memcpy(&address, addresses + i * sizeof(uint64_t), sizeof(address));
+                analyzer->access(address);
+            }
+        }
+        uint64_t &last = lastAddress[std::make_pair(record.thread, record.variable)];
+        for (uint32_t i = 0; i < record.count; i++) {
+            uint64_t address;
+            memcpy(&address, addresses + i * sizeof(uint64_t), sizeof(address));
+            if (last != 0) {
+                uint64_t distance = (address > last) ? address - last : last - address;
+                variable.strides.add(static_cast<int64_t>(distance / elementSize));
+            }
+            last = address;
+        }
+        variable.accesses += record.count;
+    });
+    if (!valid) {
+        return false;
+    }
+    for (auto &stream : sampleStreams) {
+        finishBatch(stream.second, variables[stream.first.second]);
+    }
+    for (const auto &stream : reuseStreams) {
+        TraceVariable &variable = variables[stream.first.second];
+        variable.reuse.merge(stream.second->getHistogram());
+        variable.reuse.elementSize = variable.elementSize;
+    }
+    return true;
+}
+
+void TraceReader::estimate(std::vector<TraceVariable> &variables, TraceSampling &sampling)
+{
+    using namespace MasamtTrace;
+    const SamplingConfig &config = sampling.config;
+    double scale = config.getScale();
+    sampling.variables.clear();
+    for (auto &variable : variables) {
+        if (variable.name.empty()) {
+            continue;
+        }
+        SampledEstimate estimate;
+        estimate.kernel = variable.kernel;
+        estimate.name = variable.name;
+        estimate.samples = variable.accesses;
+        estimate.batches = variable.batches;
+        estimate.accesses = variable.accesses * scale;
+        if (config.mode == SAMPLE_BURST) {
+            // 突发抽样是系统抽样，误差只来自每个序列最后一个不完整的周期
+            estimate.accessesError = static_cast<double>(variable.streams) * (config.period - config.burstLength);
+        } else {
+            // 哈希抽样以地址为单位，按地址抽样概率1/R估计总量及其方差
+            double sumSquares = 0.0;
+            for (const auto &entry : variable.addressCounts) {
+                sumSquares += static_cast<double>(entry.second) * entry.second;
+            }
+            double varianceFactor = scale * (scale - 1.0);
+            estimate.accessesError = CONFIDENCE_Z * std::sqrt(varianceFactor * sumSquares);
+            double distinct = static_cast<double>(variable.addressCounts.size());
+            estimate.footprint = std::min<double>(distinct * scale * variable.elementSize, variable.size);
+            estimate.footprintError = CONFIDENCE_Z * std::sqrt(varianceFactor * distinct) * variable.elementSize;
+        }
+
+        // 批次均值法：各批内的步长占比视为独立观测，样本较少时置信区间较宽
+        double batches = static_cast<double>(variable.batches);
+        for (const auto &stride : variable.strides.top(MAX_STRIDES)) {
+            StrideEstimate strideEstimate;
+            strideEstimate.stride = stride.first;
+            strideEstimate.percent = stride.second;
+            strideEstimate.error = 100.0;
+            auto sums = variable.batchFractions.find(stride.first);
+            if (batches >= 2 && sums != variable.batchFractions.end()) {
+                double mean = sums->second.first / batches;
+                double variance = std::max(0.0, sums->second.second / batches - mean * mean) * batches / (batches - 1);
+                strideEstimate.error = 100.0 * CONFIDENCE_Z * std::sqrt(variance / batches);
+            }
+            estimate.strides.push_back(strideEstimate);
+        }
+        sampling.variables.push_back(estimate);
+        variable.accesses = static_cast<uint64_t>(estimate.accesses + 0.5);
+    }
+}
+
+void TraceReader::buildOperatorInfo(const std::string &opName, const std::vector<TraceVariable> &variables,
+                                    OperatorInfo &op)
+{
+    op.name = opName;
+    op.names = std::make_shared<StringTable>();
+    StringTable &table = *op.names;
+
+    // 与CSV输入一致：函数按名称排序，函数内变量保持原有顺序
+    std::vector<std::string> kernels;
+    for (const auto &variable : variables) {
+        if (!variable.name.empty()) {
+            kernels.push_back(variable.kernel);
+        }
+    }
+    std::sort(kernels.begin(), kernels.end());
+    kernels.erase(std::unique(kernels.begin(), kernels.end()), kernels.end());
+
+    FunctionList functions;
+    functions.reserve(kernels.size());
+    for (const auto &kernel : kernels) {
+        functions.push_back(FunctionInfo());
+        FunctionInfo &func = functions.back();
+        func.name = InternedName(&table, table.intern(kernel));
+        for (const auto &variable : variables) {
+            if (variable.name.empty() || variable.kernel != kernel) {
+                continue;
+            }
+            AccessPatterns patterns;
+            for (const auto &stride : variable.strides.top(MAX_STRIDES)) {
+                patterns.push_back({static_cast<int>(stride.first), stride.second / 100.0});
+            }
+            InternedName varName(&table, table.intern(variable.name));
+            func.variables.push_back(VariableInfo(varName, variable.size, variable.accesses, patterns));
+            if (variable.reuse.getTotal() > 0) {
+                func.variables.back().reuse = std::make_shared<ReuseHistogram>(variable.reuse);
+            }
+        }
+    }
+    op.functions = std::move(functions);
+}
+
+bool TraceReader::parse(const std::string &opName, const std::string &content, OperatorInfo &op)
+{
+    TraceSampling sampling;
+    return parse(opName, content, op, sampling);
+}
+
+bool TraceReader::parse(const std::string &opName, const std::string &content, OperatorInfo &op,
+                        TraceSampling &sampling)
+{
+    std::vector<TraceVariable> variables;
+    sampling = TraceSampling();
+    // 抽样跟踪的样本不是完整的访问序列，不计算重用距离
+    bool chunked = ChunkedTrace::isChunkedTrace(content);
+    uint64_t addresses = chunked ? ChunkedTrace::getAddressCount(content) : content.size() / sizeof(uint64_t);
+    uint64_t reuseSampleRate = resolveReuseSampleRate(getReuseSampleRate(), addresses);
+    bool valid = chunked
+                     ? ChunkedTrace::decode(content, getDecodeJobs(), variables, reuseSampleRate)
+                     : scanRawTrace(content, variables, sampling.config, reuseSampleRate);
+    if (!valid) {
+        std::cerr << "警告: 跟踪文件格式不正确: " << opName << std::endl;
+        op.name = opName;
+        return false;
+    }
+    if (sampling.isSampled()) {
+        estimate(variables, sampling);
+    }
+    buildOperatorInfo(opName, variables, op);
+    return true;
+}
@@ -0,0 +1,297 @@
+#include "VariableGrouping.hpp"
+#include "StrategyCostModel.hpp"
+#include "TraceReader.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <map>
+
+namespace
+{
+
+std::atomic<bool> &enabledStorage()
+{
+    static std::atomic<bool> enabled(false);
+    return enabled;
+}
+
+// 扫描中单个内核的状态
+class KernelScan
+{
+public:
+    CoAccessProfile *profile = nullptr;
+    uint64_t total = 0;
+    uint64_t windowAccesses = 1;
+    uint64_t position = 0;
+};
+
+int alignUp(int bytes, int alignment) { return (bytes + alignment - 1) / alignment * alignment; }
+
+} // namespace
+
+int CoAccessProfile::find(const std::string &name) const
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    return (it == names.end()) ? -1 : static_cast<int>(it - names.begin());
+}
+
+bool VariableGrouper::isEnabled() { return enabledStorage().load(); }
+
+void VariableGrouper::setEnabled(bool enabled) { enabledStorage().store(enabled); }
+
+bool VariableGrouper::collect(const std::string &content, std::vector<CoAccessProfile> &profiles)
+{
+    profiles.clear();
+    std::vector<TraceVariable> variables;
+    MasamtTrace::SamplingConfig sampling;
+
+    // 第一遍统计各变量的访问次数，用于确定窗口长度
+    std::vector<uint64_t> counts;
+    bool valid = TraceReader::readRawTrace(content, variables, sampling,
+                                           [&](const MasamtTrace::TraceBlockRecord &record, const char *) {
+                                               if (record.variable >= counts.size()) {
+                                                   counts.resize(record.variable + 1, 0);
+                                               }
+                                               counts[record.variable] += record.count;
+                                           });
+    if (!valid) {
+        return false;
+    }
+    counts.resize(variables.size(), 0);
+
+    std::map<std::string, CoAccessProfile> byKernel;
+    std::map<std::string, KernelScan> scans;
+    std::vector<KernelScan *> kernelOf(variables.size(), nullptr);
+    std::vector<size_t> slotOf(variables.size(), 0);
+    for (size_t id = 0; id < variables.size(); id++) {
+        if (variables[id].name.empty()) {
+            continue;
+        }
+        CoAccessProfile &profile = byKernel[variables[id].kernel];
+        KernelScan &scan = scans[variables[id].kernel];
+        profile.kernel = variables[id].kernel;
+        scan.profile = &profile;
+        scan.total += counts[id];
+        kernelOf[id] = &scan;
+        slotOf[id] = profile.names.size();
+        profile.names.push_back(variables[id].name);
+    }
+    for (auto &entry : scans) {
+        KernelScan &scan = entry.second;
+        scan.windowAccesses = std::max<uint64_t>(1, (scan.total + CO_ACCESS_WINDOWS - 1) / CO_ACCESS_WINDOWS);
+        scan.profile->windows.assign(scan.profile->names.size(), std::vector<uint64_t>(CO_ACCESS_WINDOWS, 0));
+    }
+
+    // 第二遍按地址块在内核访问序列中的位置累计各窗口的访问次数
+    TraceReader::readRawTrace(content, variables, sampling,
+                              [&](const MasamtTrace::TraceBlockRecord &record, const char *) {
+                                  if (record.variable >= kernelOf.size() || kernelOf[record.variable] == nullptr) {
+                                      return;
+                                  }
+                                  KernelScan &scan = *kernelOf[record.variable];
+                                  size_t window = static_cast<size_t>(
+                                      std::min<uint64_t>(scan.position / scan.windowAccesses, CO_ACCESS_WINDOWS - 1));
+                                  scan.profile->windows[slotOf[record.variable]][window] += record.count;
+                                  scan.position += record.count;
+                              });
+    for (auto &entry : byKernel) {
+        profiles.push_back(std::move(entry.second));
+    }
+    return true;
+}
+
+double VariableGrouper::signatureDistance(const AccessFeatureVector &a, const AccessFeatureVector &b)
+{
+    double distance = 0.0;
+    double coveredA = 0.0, coveredB = 0.0;
+    for (const auto &pattern : a.patterns) {
+        double other = 0.0;
+        for (const auto &candidate : b.patterns) {
+            if (candidate.first == pattern.first) {
+                other = candidate.second;
+            }
+        }
+        distance += std::fabs(pattern.second - other);
+        coveredA += pattern.second;
+    }
+    for (const auto &pattern : b.patterns) {
+        bool shared = false;
+        for (const auto &candidate : a.patterns) {
+            shared = shared || candidate.first == pattern.first;
+        }
+        if (!shared) {
+            distance += pattern.second;
+        }
+        coveredB += pattern.second;
+    }
+    // 未被步长覆盖的（随机）部分
+    return distance + std::fabs(std::max(0.0, 1.0 - coveredA) - std::max(0.0, 1.0 - coveredB));
+}
+
+double VariableGrouper::coAccessSimilarity(const CoAccessProfile &profile, int a, int b)
+{
+    const std::vector<uint64_t> &first = profile.windows[a];
+    const std::vector<uint64_t> &second = profile.windows[b];
+    double totalA = 0.0, totalB = 0.0;
+    for (size_t w = 0; w < first.size(); w++) {
+        totalA += first[w];
+        totalB += second[w];
+    }
+    if (totalA <= 0 || totalB <= 0) {
+        return 0.0;
+    }
+    double overlap = 0.0;
+    for (size_t w = 0; w < first.size(); w++) {
+        overlap += std::min(first[w] / totalA, second[w] / totalB);
+    }
+    return overlap;
+}
+
+bool VariableGrouper::evaluateGroup(const FeatureVectorList &accessFeatureVectors, const std::vector<size_t> &members,
+                                    const HardwareProfile &profile, VariableGroup &group)
+{
+    const AccessFeatureVector &first = accessFeatureVectors[members[0]];
+    group.strategy = first.accessStrategyConfig.accessStrategy;
+    int count = static_cast<int>(members.size());
+    for (size_t m : members) {
+        const AccessFeatureVector &featureVector = accessFeatureVectors[m];
+        int footprint = std::max(0, featureVector.accessStrategyConfig.getSMFootprint());
+        group.members.push_back(featureVector.varName.str());
+        group.budget += featureVector.C;
+        group.footprintBefore += alignUp(footprint, profile.smAlignment);
+        group.wastedBefore += std::max(0, featureVector.C - footprint);
+        group.transfersBefore += StrategyCostModel::estimateLineFills(featureVector, group.strategy, profile);
+        group.cyclesBefore += featureVector.strategyCosts.get(group.strategy);
+    }
+
+    // 每个成员按平分后的C确定子行，成员同步访问，填充次数取组内最多者
+    AccessFeatureVector shared(first);
+    shared.C = group.budget / count;
+    if (group.strategy == SINGLE) {
+        group.set = 0;
+        group.line = (shared.C > 0) ? static_cast<int>(std::floor(std::log2(shared.C))) : 0;
+    } else {
+        AccessStrategyDeducter::calculateDirectParameters(shared, group.set, group.line);
+    }
+    if (group.line < 4) {
+        return false;
+    }
+    int lineBytes = AccessStrategyConfig::calculateLineSpace(group.line);
+    group.regionBytes = count * (1 << group.set) * lineBytes;
+    group.wastedAfter = std::max(0, group.budget - group.regionBytes);
+
+    double accessCycles = 0.0;
+    for (size_t m : members) {
+        AccessFeatureVector member(accessFeatureVectors[m]);
+        member.C = shared.C;
+        group.transfersAfter =
+            std::max(group.transfersAfter, StrategyCostModel::estimateLineFills(member, group.strategy, profile));
+        accessCycles += member.N * profile.smLatency * ((group.strategy == DIRECT) ? 2 : 1);
+    }
+    group.cyclesAfter = accessCycles + group.transfersAfter * profile.dmaCycles(static_cast<double>(count) * lineBytes);
+    return !std::isinf(group.cyclesBefore) && !std::isinf(group.cyclesAfter);
+}
+
+GroupingPlan VariableGrouper::group(const std::string &funcName, const FeatureVectorList &accessFeatureVectors,
+                                    const CoAccessProfile *coAccess, const HardwareProfile &profile)
+{
+    GroupingPlan plan;
+    plan.funcName = funcName;
+    std::vector<bool> assigned(accessFeatureVectors.size(), false);
+    std::vector<int> traceIndex(accessFeatureVectors.size(), -1);
+    for (size_t v = 0; v < accessFeatureVectors.size(); v++) {
+        AccessStrategy strategy = accessFeatureVectors[v].accessStrategyConfig.accessStrategy;
+        assigned[v] = (strategy != SINGLE && strategy != DIRECT) || accessFeatureVectors[v].memory != MEMORY_SM;
+        if (coAccess != nullptr) {
+            traceIndex[v] = coAccess->find(accessFeatureVectors[v].varName.str());
+        }
+    }
+
+    for (size_t v = 0; v < accessFeatureVectors.size(); v++) {
+        if (assigned[v]) {
+            continue;
+        }
+        // 贪心聚类：与组内每个成员都满足条件的变量加入
+        std::vector<size_t> members = {v};
+        double coAccessMin = 1.0;
+        bool traced = false;
+        for (size_t u = v + 1; u < accessFeatureVectors.size(); u++) {
+            if (assigned[u]) {
+                continue;
+            }
+            bool compatible = true;
+            bool pairTraced = false;
+            double similarity = 1.0;
+            for (size_t m : members) {
+                const AccessFeatureVector &a = accessFeatureVectors[m];
+                const AccessFeatureVector &b = accessFeatureVectors[u];
+                double ratio = static_cast<double>(std::max(a.N, b.N)) / std::max<unsigned long long>(1, std::min(a.N, b.N));
+                compatible = compatible && a.accessStrategyConfig.accessStrategy == b.accessStrategyConfig.accessStrategy &&
+                             ratio <= LOCKSTEP_RATIO && signatureDistance(a, b) <= SIGNATURE_DISTANCE;
+                if (compatible && traceIndex[m] >= 0 && traceIndex[u] >= 0) {
+                    similarity = std::min(similarity, coAccessSimilarity(*coAccess, traceIndex[m], traceIndex[u]));
+                    compatible = similarity >= CO_ACCESS_SIMILARITY;
+                    pairTraced = true;
+                }
+            }
+            if (compatible) {
+                members.push_back(u);
+                coAccessMin = std::min(coAccessMin, similarity);
+                traced = traced || pairTraced;
+            }
+        }
+        if (members.size() < 2) {
+            continue;
+        }
+        VariableGroup group;
+        if (!evaluateGroup(accessFeatureVectors, members, profile, group)) {
+            continue;
+        }
+        bool better = group.transfersAfter < group.transfersBefore || group.wastedAfter < group.wastedBefore;
+        if (group.cyclesAfter > group.cyclesBefore || !better) {
+            continue;
+        }
+        group.coAccess = traced ? coAccessMin : -1.0;
+        for (size_t m : members) {
+            assigned[m] = true;
+        }
+        plan.groups.push_back(group);
+    }
+    return plan;
+}
+
+void VariableGrouper::printReport(const std::vector<GroupingPlan> &plans, std::ostream &os)
+{
+    std::ios::fmtflags flags = os.flags();
+    for (const auto &plan : plans) {
+        if (plan.groups.empty()) {
+            continue;
+        }
+        os << "[变量分组] " << plan.funcName << std::endl;
+        for (size_t g = 0; g < plan.groups.size(); g++) {
+            const VariableGroup &group = plan.groups[g];
+            os << "  组" << g + 1 << ":";
+            for (const auto &member : group.members) {
+                os << " " << member;
+            }
+            os << ", " << AccessStrategyConfig(group.strategy).getStrategyName();
+            if (group.strategy == DIRECT) {
+                os << "(set=" << group.set << ")";
+            }
+            os << ", 合并行=" << group.members.size() << "×" << AccessStrategyConfig::calculateLineSpace(group.line)
+               << "B(子行line=" << group.line << "), 共享区域" << group.regionBytes << "B/C=" << group.budget << "B";
+            if (group.coAccess >= 0) {
+                os << ", 同步访问度" << std::fixed << std::setprecision(2) << group.coAccess;
+                os.flags(flags);
+            }
+            os << std::endl;
+            os << "    SM占用 " << group.footprintBefore << "B → " << group.regionBytes << "B, 碎片 " << group.wastedBefore
+               << "B → " << group.wastedAfter << "B, DMA描述符 " << StrategyCosts::formatCycles(group.transfersBefore)
+               << " → " << StrategyCosts::formatCycles(group.transfersAfter) << ", 周期 "
+               << StrategyCosts::formatCycles(group.cyclesBefore) << " → "
+               << StrategyCosts::formatCycles(group.cyclesAfter) << std::endl;
+        }
+        os << std::endl;
+    }
+}
@@ -1,6 +1,16 @@
 #include "OperatorInfo.hpp"
+#include "AnalysisPipeline.hpp"
 #include "CSVHandler.hpp"
+#include "ChunkedTrace.hpp"
 #include "FileUtils.hpp"
+#include "InputDiscovery.hpp"
+#include "ParameterSweep.hpp"
+#include "ResultDiff.hpp"
+#include "ResultStore.hpp"
+#include "ResultSink.hpp"
+#include "ScalingModel.hpp"
+#include "StrategyCostModel.hpp"
+#include "ThresholdCalibration.hpp"
 #include <iostream>
 #include <cmath>
 #include <fstream>
@@ -17,6 +27,32 @@ struct CLIOptions {
     std::string opFilter = "";    // Filter by operator name
     std::string datasetFilter = ""; // Filter by dataset name
     std::string csvPath = "";     // Process a specific CSV file
+    std::string profilePath = ""; // Hardware profile to load at startup
+    std::string modelName = "";   // Strategy selection model
+    bool sweep = false;           // Run a parameter sweep instead of a single analysis
+    std::string sweepCRange = "16K:60K";        // C_total sweep range
+    std::string sweepFactorRange = "0.06:0.22:0.04"; // strategy_determine_factor sweep range
+    std::string calibratePath = "";   // Measured per-strategy timings to calibrate the decision thresholds against
+    std::string thresholdsPath = "";  // Decision thresholds file loaded at startup and written by calibration
+    unsigned int jobs = 0;        // Worker threads (0 = hardware concurrency)
+    bool scale = false;           // Fit dataset-size scaling laws per operator
+    std::string extrapolateSizes = ""; // Comma-separated problem sizes to predict
+    std::string formats = "csv"; // Result file formats written with -c
+    std::vector<std::string> queries;   // Result store lookups (op/dataset/function/variable)
+    std::string storePath = "";   // Indexed result store location
+    std::vector<std::string> diffPaths; // Two result files/directories to compare
+    size_t queueDepth = 4;        // Bounded queue depth between pipeline stages
+    bool pipelineStats = false;   // Print per-stage queue occupancy after the run
+    std::string codegenTemplate = ""; // Template for generated cache configuration headers
+    std::vector<std::string> convertPaths; // Raw trace to convert and the chunked trace to write
+    std::string traceBenchPath = "";  // Chunked trace whose decode throughput is measured
+    uint64_t reuseSample = TraceReader::REUSE_SAMPLE_AUTO; // Reuse-distance address sampling: 0 off, 1 exact, R approximate
+    bool phases = false;          // Detect access phases in raw traces
+    bool tiling = false;          // Recommend tile sizes that make SINGLE/DIRECT variables BULK
+    bool placement = false;       // Report SM layout and conflict-avoiding skews for DIRECT variables
+    bool hierarchy = false;       // Plan DDR/GSM/SM placement per variable
+    bool am = false;              // Cache unit-stride vector variables in AM, solved jointly with SM
+    bool grouping = false;        // Group lockstep variables into shared interleaved cache regions
 };
 
 // Print help message
@@ -29,7 +65,33 @@ void printHelp(const char* programName) {
               << "  -n, --no-header            Don't show headers in output\n"
               << "  -o, --operator=NAME        Process only the specified operator\n"
               << "  -d, --dataset=NAME         Process only the specified dataset\n"
-              << "  -f, --file=PATH            Process a specific CSV file\n"
+              << "  -f, --file=PATH            Process a specific CSV file (or a masamt-trace .mtrace/.mtc trace)\n"
+              << "      --convert-trace IN OUT  Convert a raw .mtrace trace into a compressed, chunked .mtc trace\n"
+              << "      --trace-bench=PATH     Measure .mtc decode throughput with 1 up to -j threads\n"
+              << "      --reuse-sample=R       Reuse distances of traces: 1 exact, R>1 samples 1/R of the addresses, 0 off (default: auto)\n"
+              << "      --phases               Split raw .mtrace kernels into phases and report whether reconfiguring pays off\n"
+              << "      --tiling               Recommend tile shapes that let SINGLE/DIRECT arrays be bulk-loaded\n"
+              << "      --placement            Report the SM layout and row skews that cut DIRECT conflict misses\n"
+              << "      --hierarchy            Plan whether each variable stays in DDR or is staged in GSM before SM\n"
+              << "      --am                   Cache unit-stride vector variables in AM and report SM/AM space usage\n"
+              << "      --grouping             Group variables accessed in lockstep into shared interleaved cache regions\n"
+              << "  -p, --profile=PATH         Load hardware parameters (DMA/SM latency, bandwidth) from file\n"
+              << "  -m, --model=NAME           Strategy selection model: threshold (default) or cycle\n"
+              << "  -s, --sweep                Sweep C_total and strategy factor, report Pareto front\n"
+              << "      --sweep-c=MIN:MAX      C_total range in power-of-two steps (default: 16K:60K)\n"
+              << "      --sweep-factor=MIN:MAX:STEP  strategy_determine_factor range (default: 0.06:0.22:0.04)\n"
+              << "      --calibrate=PATH       Fit decision thresholds to measured timings (CSV file or directory) and save them\n"
+              << "      --thresholds=PATH      Decision thresholds file (default: .masamt/thresholds, loaded if present)\n"
+              << "  -j, --jobs=N               Worker threads (default: hardware concurrency)\n"
+              << "      --queue-depth=N        Files buffered between pipeline stages (default: 4)\n"
+              << "      --pipeline-stats       Print per-stage queue occupancy to stderr after the run\n"
+              << "      --scale                Fit size scaling laws across data/<op>/ datasets and find strategy flips\n"
+              << "      --extrapolate=SIZES    Problem sizes to predict, e.g. 64M,4x (bytes or multiple of largest dataset)\n"
+              << "      --diff A B             Compare two result files or directories (CSV or .bin) and report changes\n"
+              << "      --format=LIST          Result file formats under results/: csv,jsonl,bin,store,header (default: csv, implies -c)\n"
+              << "      --codegen-template=PATH  Template for the 'header' format (results/codegen/<op>_<dataset>_<function>.h)\n"
+              << "  -q, --query=PATTERN        Look up op/dataset/function/variable in the result store ('*' wildcard, '-' reads stdin)\n"
+              << "      --store=PATH           Indexed result store written by --format=store (default: results/results.idx)\n"
               << std::endl;
 }
 
@@ -45,13 +107,39 @@ CLIOptions parseArgs(int argc, char* argv[]) {
         {"operator",  required_argument, 0, 'o'},
         {"dataset",   required_argument, 0, 'd'},
         {"file",      required_argument, 0, 'f'},
+        {"profile",   required_argument, 0, 'p'},
+        {"model",     required_argument, 0, 'm'},
+        {"sweep",     no_argument,       0, 's'},
+        {"sweep-c",   required_argument, 0, 'C'},
+        {"sweep-factor", required_argument, 0, 'F'},
+        {"calibrate", required_argument, 0, 'W'},
+        {"thresholds", required_argument, 0, 'Y'},
+        {"jobs",      required_argument, 0, 'j'},
+        {"scale",     no_argument,       0, 'S'},
+        {"extrapolate", required_argument, 0, 'X'},
+        {"format",    required_argument, 0, 'T'},
+        {"diff",      required_argument, 0, 'D'},
+        {"query",     required_argument, 0, 'q'},
+        {"store",     required_argument, 0, 'I'},
+        {"queue-depth", required_argument, 0, 'Q'},
+        {"pipeline-stats", no_argument,  0, 'P'},
+        {"codegen-template", required_argument, 0, 'G'},
+        {"convert-trace", required_argument, 0, 'V'},
+        {"trace-bench", required_argument, 0, 'B'},
+        {"reuse-sample", required_argument, 0, 'R'},
+        {"phases",    no_argument,       0, 'H'},
+        {"tiling",    no_argument,       0, 'K'},
+        {"placement", no_argument,       0, 'L'},
+        {"hierarchy", no_argument,       0, 'M'},
+        {"am",        no_argument,       0, 'A'},
+        {"grouping",  no_argument,       0, 'E'},
         {0,           0,                 0,  0 }
     };
 
     int option_index = 0;
     int c;
     
-    while ((c = getopt_long(argc, argv, "hc1no:d:f:", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "hc1no:d:f:p:m:sj:q:", long_options, &option_index)) != -1) {
         switch (c) {
             case 'h':
                 printHelp(argv[0]);
@@ -75,6 +163,86 @@ CLIOptions parseArgs(int argc, char* argv[]) {
             case 'f':
                 options.csvPath = optarg;
                 break;
+            case 'p':
+                options.profilePath = optarg;
+                break;
+            case 'm':
+                options.modelName = optarg;
+                break;
+            case 's':
+                options.sweep = true;
+                break;
+            case 'C':
+                options.sweepCRange = optarg;
+                break;
+            case 'F':
+                options.sweepFactorRange = optarg;
+                break;
+            case 'W':
+                options.calibratePath = optarg;
+                break;
+            case 'Y':
+                options.thresholdsPath = optarg;
+                break;
+            case 'S':
+                options.scale = true;
+                break;
+            case 'X':
+                options.extrapolateSizes = optarg;
+                break;
+            case 'T':
+                options.formats = optarg;
+                options.toCSV = true;
+                break;
+            case 'q':
+                options.queries.push_back(optarg);
+                break;
+            case 'I':
+                options.storePath = optarg;
+                break;
+            case 'Q':
+                options.queueDepth = static_cast<size_t>(std::max(1, atoi(optarg)));
+                break;
+            case 'P':
+                options.pipelineStats = true;
+                break;
+            case 'G':
+                options.codegenTemplate = optarg;
+                break;
+            case 'D':
+                options.diffPaths.push_back(optarg);
+                break;
+            case 'V':
+                options.convertPaths.push_back(optarg);
+                break;
+            case 'B':
+                options.traceBenchPath = optarg;
+                break;
+            case 'H':
+                options.phases = true;
+                break;
+            case 'K':
+                options.tiling = true;
+                break;
+            case 'L':
+                options.placement = true;
+                break;
+            case 'M':
+                options.hierarchy = true;
+                break;
+            case 'A':
+                options.am = true;
+                break;
+            case 'E':
+                options.grouping = true;
+                break;
+            case 'R':
+                options.reuseSample = (std::string(optarg) == "auto") ? TraceReader::REUSE_SAMPLE_AUTO
+                                                                     : static_cast<uint64_t>(std::max(0LL, atoll(optarg)));
+                break;
+            case 'j':
+                options.jobs = static_cast<unsigned int>(std::max(0, atoi(optarg)));
+                break;
             case '?':
                 printHelp(argv[0]);
                 exit(1);
@@ -82,6 +250,23 @@ CLIOptions parseArgs(int argc, char* argv[]) {
         }
     }
     
+    // --diff takes the second result set as a positional argument
+    if (!options.diffPaths.empty() && optind < argc) {
+        options.diffPaths.push_back(argv[optind]);
+    }
+    if (!options.diffPaths.empty() && options.diffPaths.size() != 2) {
+        std::cerr << "Error: --diff requires two result paths" << std::endl;
+        exit(1);
+    }
+    // --convert-trace likewise takes the output path as a positional argument
+    if (!options.convertPaths.empty() && optind < argc) {
+        options.convertPaths.push_back(argv[optind]);
+    }
+    if (!options.convertPaths.empty() && options.convertPaths.size() != 2) {
+        std::cerr << "Error: --convert-trace requires an input and an output path" << std::endl;
+        exit(1);
+    }
+    
     return options;
 }
 
@@ -95,79 +280,111 @@ void printFeatureVectorOneLine(const AccessFeatureVector& featureVector) {
     
     if (featureVector.accessStrategyConfig.accessStrategy != UNSUITABLE) {
         std::cout << " (set=" << featureVector.accessStrategyConfig.set 
-                  << ",line=" << featureVector.accessStrategyConfig.line << ")";
+                  << ",line=" << featureVector.accessStrategyConfig.line << ")"
+                  << " Cost(B/S/D):" << StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[BULK]) << "/"
+                  << StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[SINGLE]) << "/"
+                  << StrategyCosts::formatCycles(featureVector.strategyCosts.cycles[DIRECT]);
+    }
+    if (featureVector.memory == MEMORY_AM) {
+        std::cout << " Memory:AM";
+    }
+    if (featureVector.bufferingPlan.bufferCount > 1) {
+        std::cout << " Buffer:" << featureVector.bufferingPlan.bufferCount << "x"
+                  << featureVector.bufferingPlan.bufferSize << "B StallReduction:" << std::fixed
+                  << std::setprecision(1) << featureVector.bufferingPlan.getStallReduction() * 100 << "%";
+    }
+    if (featureVector.prefetchPlan.isEnabled()) {
+        std::cout << " Prefetch:" << featureVector.prefetchPlan.distance << "x"
+                  << featureVector.prefetchPlan.chunkSize << "B StallReduction:" << std::fixed
+                  << std::setprecision(1) << featureVector.prefetchPlan.getStallReduction() * 100 << "%";
     }
     std::cout << std::endl;
 }
 
-// Process a single CSV file
-void processCSVFile(const std::string& csvPath, const CLIOptions& options) {
-    CSVHandler& csvHandler = CSVHandler::getInstance();
+// Resolve operator/dataset from a CSV path; returns false if the file is excluded by filters
+bool resolveInputFile(const std::string& csvPath, const CLIOptions& options, AnalysisInput& input) {
+    input.path = csvPath;
     
     // Extract filename from path
     std::string filename = csvPath.substr(csvPath.find_last_of("/\\") + 1);
     
     // Check if it's legacy format
     std::string extractedDataset, extractedOpName;
-    bool isLegacy = FileUtils::isLegacyCSVFormat(filename, extractedDataset, extractedOpName);
-    
-    std::string opName;
-    std::string dataset;
+    input.isLegacy = FileUtils::isLegacyCSVFormat(filename, extractedDataset, extractedOpName);
     
-    if (isLegacy) {
+    if (input.isLegacy) {
         // Legacy format: use extracted information
-        opName = extractedOpName;
-        dataset = extractedDataset;
+        input.opName = extractedOpName;
+        input.dataset = extractedDataset;
         
         // Check filters
-        if (!options.opFilter.empty() && options.opFilter != opName) return;
-        if (!options.datasetFilter.empty() && options.datasetFilter != dataset) return;
-        
-        if (!options.oneLineOutput && !options.toCSV) {
-            std::cout << "Processing legacy format file: " << filename << std::endl;
-            std::cout << "Extracted operator: " << opName << ", dataset: " << dataset << std::endl;
-        }
+        if (!options.opFilter.empty() && options.opFilter != input.opName) return false;
+        if (!options.datasetFilter.empty() && options.datasetFilter != input.dataset) return false;
     } else {
         // Generic format: use filename as operator name
-        opName = FileUtils::getFileNameWithoutExtension(csvPath);
-        dataset = "UNKNOWN";
+        input.opName = FileUtils::getFileNameWithoutExtension(csvPath);
+        input.dataset = "UNKNOWN";
         
         // Check filters (only operator filter applies for generic format)
-        if (!options.opFilter.empty() && options.opFilter != opName) return;
-        
-        if (!options.oneLineOutput && !options.toCSV) {
+        if (!options.opFilter.empty() && options.opFilter != input.opName) return false;
+    }
+    return true;
+}
+
+// Input files in processing order, with the banner printed before each file's results (empty for none)
+struct AnalysisBatch {
+    std::vector<AnalysisInput> inputs;
+    std::vector<std::string> banners;
+    
+    void add(const std::string& csvPath, const CLIOptions& options, const std::string& banner = "") {
+        AnalysisInput input;
+        if (!resolveInputFile(csvPath, options, input)) return;
+        inputs.push_back(input);
+        banners.push_back(banner);
+    }
+};
+
+// Print or store the results of one analysed file (called by the pipeline's ordered writer)
+void writeAnalysisJob(const AnalysisJob& job, const std::string& banner, const CLIOptions& options,
+                      ResultSinkList& sinks) {
+    const AnalysisInput& input = job.input;
+    const std::string filename = input.path.substr(input.path.find_last_of("/\\") + 1);
+    const std::string& opName = input.opName;
+    const std::string& dataset = input.dataset;
+    bool isLegacy = input.isLegacy;
+    
+    if (!options.oneLineOutput && !options.toCSV) {
+        if (!banner.empty()) {
+            std::cout << banner << std::endl;
+        }
+        if (isLegacy) {
+            std::cout << "Processing legacy format file: " << filename << std::endl;
+            std::cout << "Extracted operator: " << opName << ", dataset: " << dataset << std::endl;
+        } else {
             std::cout << "Processing generic format file: " << filename << std::endl;
             std::cout << "Using operator name: " << opName << std::endl;
         }
     }
     
     // Skip if CSV file doesn't exist
-    if (!csvHandler.isFileExists(csvPath)) {
-        std::cerr << "Warning: CSV file does not exist: " << csvPath << std::endl;
+    if (!job.exists) {
+        std::cerr << "Warning: CSV file does not exist: " << input.path << std::endl;
         return;
     }
     
-    // Read operator information
-    OperatorInfo op;
-    csvHandler.readOperatorInfo(opName, csvPath, op);
-    
-    // Process each function for strategy inference
-    for (const auto& func : op.functions) {
+    for (size_t i = 0; i < job.op.functions.size(); i++) {
+        const FunctionInfo& func = job.op.functions[i];
+        const FeatureVectorList& featureVectors = job.results[i];
         if (!options.oneLineOutput && !options.toCSV) {
             std::cout << "Processing function: " << func.name << std::endl;
         }
         
-        // Perform strategy inference
-        AccessStrategyDeducter deducter;
-        deducter.deductAccessStrategy(func);
-        
         if (options.toCSV) {
-            // Write results to CSV file
-            for (const auto& featureVector : deducter.accessFeatureVectors) {
-                if (isLegacy) {
-                    csvHandler.writeAccessStrategy(opName, dataset, func.name, featureVector);
-                } else {
-                    csvHandler.writeAccessStrategyGeneric(opName, func.name, featureVector);
+            // Write results to every selected result file
+            ResultContext context(opName, isLegacy ? dataset : "", func.name.str());
+            for (const auto& featureVector : featureVectors) {
+                for (auto& sink : sinks) {
+                    sink->write(context, featureVector);
                 }
             }
         } else {
@@ -180,7 +397,7 @@ void processCSVFile(const std::string& csvPath, const CLIOptions& options) {
                     std::cout << opName << " " << func.name << ": \n";
                 }
                 
-                for (const auto& featureVector : deducter.accessFeatureVectors) {
+                for (const auto& featureVector : featureVectors) {
                     printFeatureVectorOneLine(featureVector);
                 }
             } else {
@@ -189,84 +406,403 @@ void processCSVFile(const std::string& csvPath, const CLIOptions& options) {
                     std::cout << "Function: " << func.name << std::endl;
                 }
                 
-                for (const auto& featureVector : deducter.accessFeatureVectors) {
+                for (const auto& featureVector : featureVectors) {
                     featureVector.printInfo();
                 }
                 
+                // Per-memory space usage when SM and AM are solved jointly
+                if (AccessStrategyDeducter::isAmEnabled()) {
+                    const HardwareProfile& profile = HardwareProfile::getInstance();
+                    std::cout << "  Space usage: SM " << AccessStrategyDeducter::getSpaceUsage(featureVectors, MEMORY_SM)
+                              << "/" << profile.smSize << "B, AM "
+                              << AccessStrategyDeducter::getSpaceUsage(featureVectors, MEMORY_AM) << "/"
+                              << profile.amSize << "B" << std::endl;
+                }
+                
+                // Reuse-distance histograms of traced variables
+                for (const auto& featureVector : featureVectors) {
+                    if (featureVector.reuse == nullptr) continue;
+                    std::cout << "  " << featureVector.varName << " reuse distance:";
+                    featureVector.reuse->print(std::cout);
+                    std::cout << std::endl;
+                }
+                
                 std::cout << std::endl;
             }
         }
     }
+    
+    // Sampled traces: estimates with confidence intervals and strategies that could flip
+    if (job.sampling.isSampled()) {
+        SamplingUncertainty::printReport(job.sampling, job.samplingRisks, std::cout);
+    }
+    
+    // Phase detection: per-phase strategies against the single configuration
+    if (!job.phases.empty()) {
+        PhaseDetector::printReport(job.phases, std::cout);
+    }
+    
+    // Tile shapes that turn SINGLE/DIRECT variables into bulk-loaded tiles
+    TilingAdvisor::printReport(job.tilingPlans, std::cout);
+
+    // SM layout and address skews of DIRECT-mapped variables
+    DirectPlacement::printReport(job.placements, std::cout);
+
+    // Two-level DDR/GSM/SM placement
+    HierarchyPlanner::printReport(job.hierarchyPlans, std::cout);
+
+    // Lockstep variables sharing one interleaved cache region
+    VariableGrouper::printReport(job.groupingPlans, std::cout);
+}
+
+// Analyse a batch through the read -> parse -> deduce -> write pipeline; results keep the input order
+void processBatch(const AnalysisBatch& batch, const CLIOptions& options, ResultSinkList& sinks) {
+    AnalysisPipeline pipeline;
+    pipeline.jobs = options.jobs;
+    pipeline.queueDepth = options.queueDepth;
+    pipeline.run(batch.inputs, [&](const AnalysisJob& job) {
+        writeAnalysisJob(job, batch.banners[job.sequence], options, sinks);
+    });
+    if (options.pipelineStats) {
+        pipeline.printStats(std::cerr);
+    }
 }
 
-// Process legacy format (original logic)
-void processLegacyFormat(const CLIOptions& options) {
-    // CSVHandler& csvHandler = CSVHandler::getInstance();
+// Legacy dataset files from the manifest that pass the operator/dataset filters
+std::vector<InputManifest::Entry> collectLegacyFiles(const InputManifest& manifest, const CLIOptions& options) {
+    std::vector<InputManifest::Entry> files;
+    for (const auto& entry : manifest.legacyFiles) {
+        if (!options.opFilter.empty() && options.opFilter != entry.opName) continue;
+        if (options.datasetFilter.empty()) {
+            // Without a dataset filter only the standard dataset sizes are processed
+            if (InputDiscovery::getDatasetRank(entry.dataset) >= InputDiscovery::getStandardDatasets().size()) continue;
+        } else if (options.datasetFilter != entry.dataset) {
+            continue;
+        }
+        files.push_back(entry);
+    }
+    if (files.empty() && (!options.opFilter.empty() || !options.datasetFilter.empty())) {
+        std::cerr << "Warning: no legacy CSV files under data/ match the operator/dataset filter" << std::endl;
+    }
+    return files;
+}
+
+// Queue legacy format files (original logic)
+void addLegacyFormat(const InputManifest& manifest, const CLIOptions& options, AnalysisBatch& batch) {
+    std::string currentOp;
+    for (const auto& entry : collectLegacyFiles(manifest, options)) {
+        std::string banner;
+        if (entry.opName != currentOp) {
+            banner = "\nProcessing computation load: " + entry.opName;
+        }
+        currentOp = entry.opName;
+        batch.add(entry.path, options, banner);
+    }
+}
+
+// Collect every input CSV in processing order (same selection as the default batch mode)
+std::vector<std::string> collectInputPaths(const InputManifest& manifest, const CLIOptions& options) {
+    std::vector<std::string> paths;
+    if (!options.csvPath.empty()) {
+        paths.push_back(options.csvPath);
+        return paths;
+    }
+    for (const auto& entry : collectLegacyFiles(manifest, options)) {
+        paths.push_back(entry.path);
+    }
+    if (options.opFilter.empty() && options.datasetFilter.empty()) {
+        for (const auto& entry : manifest.genericFiles) {
+            paths.push_back(entry.path);
+        }
+    }
+    return paths;
+}
+
+// Parse every selected input once and evaluate the parameter grid in parallel
+int runSweep(const InputManifest& manifest, const CLIOptions& options) {
+    ParameterSweep sweep;
+    sweep.jobs = options.jobs;
+    if (!sweep.parseCTotalRange(options.sweepCRange)) {
+        std::cerr << "Error: invalid C_total range: " << options.sweepCRange << std::endl;
+        return 1;
+    }
+    if (!sweep.parseFactorRange(options.sweepFactorRange)) {
+        std::cerr << "Error: invalid strategy factor range: " << options.sweepFactorRange << std::endl;
+        return 1;
+    }
     
-    // Dataset sizes
-    std::vector<std::string> datasets = {"MINI", "SMALL", "STANDARD", "LARGE", "EXTRALARGE"};
-    if (!options.datasetFilter.empty()) {
-        datasets.clear();
-        datasets.push_back(options.datasetFilter);
+    std::vector<ParameterSweep::SweepInput> inputs;
+    for (const auto& path : collectInputPaths(manifest, options)) {
+        AnalysisInput input;
+        if (!resolveInputFile(path, options, input) || !FileUtils::fileExists(path)) continue;
+        ParameterSweep::SweepInput sweepInput;
+        sweepInput.label = input.isLegacy ? input.dataset + "/" + input.opName : input.opName;
+        CSVHandler::getInstance().readOperatorInfo(input.opName, path, sweepInput.op);
+        inputs.push_back(sweepInput);
+    }
+    if (inputs.empty()) {
+        std::cerr << "Error: no input CSV files found for sweep" << std::endl;
+        return 1;
     }
     
-    // Process all computation loads in data directory
-    std::vector<std::string> operators = FileUtils::getSubdirectories("data");
+    std::vector<ParameterSweep::SweepResult> results = sweep.run(inputs);
+    ParameterSweep::printReport(inputs, results);
+    return 0;
+}
+
+// Fit the threshold model to measured per-strategy timings and save the thresholds for later runs
+int runCalibration(const InputManifest& manifest, const CLIOptions& options, const std::string& thresholdsPath) {
+    std::vector<StrategyMeasurement> measurements;
+    if (!ThresholdCalibrator::loadMeasurements(options.calibratePath, measurements)) {
+        return 1;
+    }
+    if (measurements.empty()) {
+        std::cerr << "Error: no measurements found in " << options.calibratePath << std::endl;
+        return 1;
+    }
+    
+    std::vector<CalibrationInput> inputs;
+    for (const auto& path : collectInputPaths(manifest, options)) {
+        AnalysisInput input;
+        if (!resolveInputFile(path, options, input) || !FileUtils::fileExists(path)) continue;
+        CalibrationInput calibrationInput;
+        calibrationInput.opName = input.opName;
+        calibrationInput.dataset = input.isLegacy ? input.dataset : "";
+        CSVHandler::getInstance().readOperatorInfo(input.opName, path, calibrationInput.op);
+        inputs.push_back(calibrationInput);
+    }
+    
+    ThresholdCalibrator calibrator;
+    calibrator.jobs = options.jobs;
+    CalibrationResult result = calibrator.calibrate(inputs, measurements, DecisionThresholds::getInstance());
+    ThresholdCalibrator::printReport(result, std::cout);
+    if (result.matched == 0) {
+        std::cerr << "Error: no measured variable matches the input files" << std::endl;
+        return 1;
+    }
+    
+    if (thresholdsPath == ThresholdCalibrator::getDefaultPath()) {
+        FileUtils::createDirectory(".masamt");
+    }
+    std::ostringstream header;
+    header << "# Decision thresholds calibrated by masamt --calibrate=" << options.calibratePath << "\n"
+           << "# Agreement with the fastest measured strategy: " << result.getAgreeBefore() << "/" << result.matched
+           << " -> " << result.getAgreeAfter() << "/" << result.matched << "\n";
+    if (!result.after.saveToFile(thresholdsPath, header.str())) {
+        return 1;
+    }
+    std::cout << "Thresholds written to " << thresholdsPath << std::endl;
+    return 0;
+}
+
+// Fit per-variable scaling laws for each operator under data/ and predict strategies at other sizes
+int runScaling(const InputManifest& manifest, const CLIOptions& options) {
+    std::vector<std::string> operators;
     if (!options.opFilter.empty()) {
-        operators.clear();
         operators.push_back(options.opFilter);
+    } else {
+        operators = manifest.getOperators();
     }
     
+    int loaded = 0;
     for (const auto& opName : operators) {
-        if (!options.oneLineOutput && !options.toCSV) {
-            std::cout << "\nProcessing computation load: " << opName << std::endl;
+        ScalingModel model;
+        if (!model.load(opName, manifest)) {
+            std::cerr << "Warning: no legacy datasets found for operator: " << opName << std::endl;
+            continue;
         }
-        
-        // Process each dataset size
-        for (const auto& dataset : datasets) {
-            std::string csvPath = "data/" + opName + "/" + dataset + "_DATASET_" + opName + ".csv";
-            processCSVFile(csvPath, options);
+        std::vector<double> targets;
+        std::stringstream ss(options.extrapolateSizes);
+        std::string spec;
+        while (std::getline(ss, spec, ',')) {
+            double footprint;
+            if (spec.empty()) continue;
+            if (!ScalingModel::parseSize(spec, model.datasets.back().footprint, footprint)) {
+                std::cerr << "Error: invalid problem size: " << spec << std::endl;
+                return 1;
+            }
+            targets.push_back(footprint);
+        }
+        model.printReport(targets);
+        std::cout << std::endl;
+        loaded++;
+    }
+    return (loaded > 0) ? 0 : 1;
+}
+
+// Join two result sets on (operator, dataset, function, variable) and report what changed
+int runDiff(const CLIOptions& options) {
+    ResultDiff diff;
+    diff.jobs = options.jobs;
+    ResultDiff::ResultSet a, b;
+    if (!diff.load(options.diffPaths[0], a) || !diff.load(options.diffPaths[1], b)) {
+        return 1;
+    }
+    std::vector<ResultDiff::RowChange> changes;
+    ResultDiff::DiffSummary summary = diff.compare(a, b, changes);
+    diff.printReport(a, b, summary, changes);
+    return 0;
+}
+
+// Convert a raw trace into the chunked delta/varint format
+int runConvertTrace(const CLIOptions& options) {
+    ChunkedTrace::ConvertStats stats;
+    if (!ChunkedTrace::convert(options.convertPaths[0], options.convertPaths[1], stats)) {
+        std::cerr << "Error: cannot convert trace " << options.convertPaths[0] << " to " << options.convertPaths[1] << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << stats.addresses << " addresses into " << stats.chunks << " chunks: "
+              << std::fixed << std::setprecision(2) << stats.rawBytes / 1e6 << " MB -> " << stats.compressedBytes / 1e6
+              << " MB (" << std::setprecision(1) << static_cast<double>(stats.rawBytes) / std::max<uint64_t>(1, stats.compressedBytes)
+              << "x)" << std::endl;
+    return 0;
+}
+
+// Answer result store lookups; "-" reads one pattern per line from stdin
+int runQuery(const CLIOptions& options) {
+    ResultStore store;
+    if (!store.open(ResultStore::getDefaultPath())) {
+        std::cerr << "Error: cannot open result store: " << ResultStore::getDefaultPath()
+                  << " (write it with --format=csv,store)" << std::endl;
+        return 1;
+    }
+    
+    bool allFound = true;
+    auto answer = [&](const std::string& pattern) {
+        size_t matches = store.query(pattern, [&store](const StoreRecord& record) { store.printRecord(record); });
+        if (matches == 0) {
+            std::cerr << "No results for: " << pattern << std::endl;
+            allFound = false;
+        }
+    };
+    for (const auto& query : options.queries) {
+        if (query != "-") {
+            answer(query);
+            continue;
+        }
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) answer(line);
         }
     }
+    return allFound ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
     // Parse command line arguments
     CLIOptions options = parseArgs(argc, argv);
 
+    // Load hardware profile before any deduction
+    if (!options.profilePath.empty() && !HardwareProfile::getInstance().loadFromFile(options.profilePath)) {
+        std::cerr << "Error: failed to load hardware profile: " << options.profilePath << std::endl;
+        return 1;
+    }
+
+    // Load decision thresholds (written by --calibrate); the default file is optional
+    std::string thresholdsPath = options.thresholdsPath.empty() ? ThresholdCalibrator::getDefaultPath() : options.thresholdsPath;
+    bool explicitThresholds = !options.thresholdsPath.empty() && options.calibratePath.empty();
+    if (explicitThresholds || FileUtils::fileExists(thresholdsPath)) {
+        if (!DecisionThresholds::getInstance().loadFromFile(thresholdsPath)) {
+            std::cerr << "Error: failed to load decision thresholds: " << thresholdsPath << std::endl;
+            return 1;
+        }
+        if (options.thresholdsPath.empty()) {
+            std::cerr << "Using calibrated decision thresholds from " << thresholdsPath << std::endl;
+        }
+    }
+
+    // Select strategy model
+    if (!options.modelName.empty() && !StrategyCostModel::selectDefault(options.modelName)) {
+        std::cerr << "Error: unknown strategy model: " << options.modelName << std::endl;
+        return 1;
+    }
+
     // Get CSV handler instance
     CSVHandler& csvHandler = CSVHandler::getInstance();
     
     // Set options for CSV handler
     csvHandler.setOutputUTF8BOM(true);
     
+    if (!options.storePath.empty()) {
+        ResultStore::setDefaultPath(options.storePath);
+    }
+    if (!options.queries.empty()) {
+        return runQuery(options);
+    }
+    if (!options.diffPaths.empty()) {
+        return runDiff(options);
+    }
+    if (!options.convertPaths.empty()) {
+        return runConvertTrace(options);
+    }
+    if (!options.traceBenchPath.empty()) {
+        return ChunkedTrace::runBenchmark(options.traceBenchPath, options.jobs, std::cout);
+    }
+    TraceReader::setDecodeJobs(options.jobs);
+    TraceReader::setReuseSampleRate(options.reuseSample);
+    PhaseDetector::setEnabled(options.phases);
+    TilingAdvisor::setEnabled(options.tiling);
+    DirectPlacement::setEnabled(options.placement);
+    HierarchyPlanner::setEnabled(options.hierarchy);
+    AccessStrategyDeducter::setAmEnabled(options.am);
+    VariableGrouper::setEnabled(options.grouping);
+    // Discover input files once; the manifest is cached until a scanned directory changes
+    InputManifest manifest;
+    if (options.csvPath.empty()) {
+        InputDiscovery discovery;
+        discovery.jobs = options.jobs;
+        manifest = discovery.discover();
+    }
+    
+    if (options.sweep) {
+        return runSweep(manifest, options);
+    }
+    if (!options.calibratePath.empty()) {
+        return runCalibration(manifest, options, thresholdsPath);
+    }
+    if (options.scale) {
+        return runScaling(manifest, options);
+    }
+    
+    // Load the cache configuration template before any header is generated
+    if (!options.codegenTemplate.empty() && !CacheCodeGenerator::loadDefaultTemplate(options.codegenTemplate)) {
+        return 1;
+    }
+    
+    // Create result writers
+    ResultSinkList sinks;
+    if (options.toCSV && !ResultSink::createSinks(options.formats, sinks)) {
+        std::cerr << "Error: invalid result format list: " << options.formats << std::endl;
+        return 1;
+    }
+    
+    AnalysisBatch batch;
     if (!options.csvPath.empty()) {
         // Process specific CSV file
-        processCSVFile(options.csvPath, options);
+        batch.add(options.csvPath, options);
     } else if (!options.opFilter.empty() || !options.datasetFilter.empty()) {
         // Use legacy format processing when filters are specified
-        processLegacyFormat(options);
+        addLegacyFormat(manifest, options, batch);
     } else {
         // Auto-detect and process all CSV files
         
-        // First, try legacy format in data directory
-        if (FileUtils::fileExists("data")) {
-            processLegacyFormat(options);
-        }
+        // First, legacy format files in data directory
+        addLegacyFormat(manifest, options, batch);
         
-        // Then, process any CSV files in current directory (generic format)
-        std::vector<std::string> csvFiles = FileUtils::getCSVFiles(".");
-        for (const auto& csvFile : csvFiles) {
-            // Skip if it matches legacy format pattern (already processed)
-            std::string extractedDataset, extractedOpName;
-            if (!FileUtils::isLegacyCSVFormat(csvFile, extractedDataset, extractedOpName)) {
-                processCSVFile(csvFile, options);
-            }
+        // Then, generic format CSV files in current directory
+        for (const auto& entry : manifest.genericFiles) {
+            batch.add(entry.path, options);
         }
     }
+    processBatch(batch, options, sinks);
+    
+    for (auto& sink : sinks) {
+        sink->flush();
+    }
     
     if (options.toCSV) {
-        std::cout << "\nAll CSV files processed, results saved to CSV files in the results directory." << std::endl;
+        std::cout << "\nAll CSV files processed, results saved to " << options.formats << " files in the results directory." << std::endl;
     }
     
     return 0;